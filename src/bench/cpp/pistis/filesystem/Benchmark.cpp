@@ -0,0 +1,303 @@
+#include "Benchmark.hpp"
+
+#include <pistis/filesystem/File.hpp>
+#include <pistis/exceptions/IOError.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <random>
+#include <sstream>
+#include <vector>
+
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+using namespace pistis::exceptions;
+using namespace pistis::filesystem;
+using namespace pistis::filesystem::benchmark;
+
+namespace {
+  static const uint64_t TEXT_FILE_SIZE = 16 * 1024 * 1024;
+  static const uint64_t MAX_ITERATIONS = 1000000000;
+
+  // Number of calls to operator new, from all threads.  Counted by the
+  // replacements for the global operator new at the end of this file.
+  std::atomic<uint64_t> allocations(0);
+
+  void* allocate(size_t n) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    void* p = ::malloc(n ? n : 1);
+    if (!p) {
+      throw std::bad_alloc();
+    }
+    return p;
+  }
+
+  void* allocateAligned(size_t n, std::align_val_t alignment) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    void* p = nullptr;
+    if (::posix_memalign(&p, std::max(sizeof(void*), (size_t)alignment),
+			 n ? n : 1)) {
+      throw std::bad_alloc();
+    }
+    return p;
+  }
+
+  struct RegisteredBenchmark {
+    std::string name;
+    BenchmarkFunction function;
+  };
+
+  std::vector<RegisteredBenchmark>& registry() {
+    static std::vector<RegisteredBenchmark> benchmarks;
+    return benchmarks;
+  }
+
+  std::string stripLastComponent(const std::string& path) {
+    auto i = path.rfind('/');
+    if (i == std::string::npos) {
+      return path;
+    }
+    return path.substr(0, i ? i : 1);
+  }
+
+  std::string getExecutableDir() {
+    char result[4096];
+    ssize_t n = readlink("/proc/self/exe", result, sizeof(result));
+    if (n < 0) {
+      throw IOError::fromSystemError(
+	  "Cannot determine executable directory (#ERR#)", PISTIS_EX_HERE
+      );
+    }
+    return stripLastComponent(std::string(result, n));
+  }
+
+  std::string computeScratchDir() {
+    const char* scratchDirEnvVar =
+	getenv("PISTIS_FILESYSTEM_BENCH_SCRATCH_DIR");
+    std::string dir =
+	scratchDirEnvVar ? std::string(scratchDirEnvVar)
+			 : stripLastComponent(getExecutableDir()) + "/tmp";
+    if ((mkdir(dir.c_str(), 0777) < 0) && (errno != EEXIST)) {
+      throw IOError::fromSystemError("Cannot create " + dir + " (#ERR#)",
+				     PISTIS_EX_HERE);
+    }
+    return dir;
+  }
+
+  std::string createTextFile() {
+    const std::string fileName = getScratchFile("bench_text.txt");
+    std::mt19937 random(42);
+    std::uniform_int_distribution<int> shortLength(20, 120);
+    std::uniform_int_distribution<int> longLength(1024, 4096);
+    std::uniform_int_distribution<int> longLine(0, 99);
+    std::uniform_int_distribution<int> letter('a', 'z');
+    std::string text;
+
+    text.reserve(TEXT_FILE_SIZE + 4096);
+    while (text.size() < TEXT_FILE_SIZE) {
+      int n = longLine(random) ? shortLength(random) : longLength(random);
+      for (int i = 0; i < n; ++i) {
+	text.push_back((i % 8) == 7 ? ' ' : (char)letter(random));
+      }
+      text.push_back('\n');
+    }
+
+    File file = File::open(fileName, FileAccessMode::WRITE_ONLY,
+			   FileOpenOptions::TRUNCATE);
+    const char* p = text.data();
+    size_t n = text.size();
+    while (n) {
+      size_t nWritten = file.write(p, n);
+      p += nWritten;
+      n -= nWritten;
+    }
+    return fileName;
+  }
+
+  struct Options {
+    std::string filter;
+    double minTime;
+    bool listOnly;
+
+    Options(): filter(), minTime(0.5), listOnly(false) { }
+  };
+
+  bool parseOptions(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; ++i) {
+      std::string arg(argv[i]);
+      if (arg.compare(0, 9, "--filter=") == 0) {
+	options.filter = arg.substr(9);
+      } else if (arg.compare(0, 11, "--min-time=") == 0) {
+	options.minTime = atof(arg.substr(11).c_str());
+      } else if (arg == "--list") {
+	options.listOnly = true;
+      } else {
+	std::cerr << "Usage: " << argv[0]
+		  << " [--filter=SUBSTRING] [--min-time=SECONDS] [--list]"
+		  << std::endl;
+	return false;
+      }
+    }
+    return true;
+  }
+
+  double runOnce(const RegisteredBenchmark& b, State& state,
+		 uint64_t& nAllocations) {
+    const uint64_t allocationsBefore =
+	allocations.load(std::memory_order_relaxed);
+    auto start = std::chrono::steady_clock::now();
+    b.function(state);
+    auto end = std::chrono::steady_clock::now();
+    nAllocations = allocations.load(std::memory_order_relaxed) -
+		   allocationsBefore;
+    return std::chrono::duration<double>(end - start).count();
+  }
+
+  std::string formatRate(double rate, const char* unit) {
+    static const char* PREFIXES[] = { "", "k", "M", "G", "T" };
+    int p = 0;
+    while ((rate >= 1000.0) && (p < 4)) {
+      rate /= 1000.0;
+      ++p;
+    }
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(2) << rate << " "
+	<< PREFIXES[p] << unit;
+    return out.str();
+  }
+
+  void run(const RegisteredBenchmark& b, const Options& options) {
+    uint64_t iterations = 1;
+
+    while (true) {
+      State state(iterations);
+      uint64_t nAllocations = 0;
+      double elapsed = runOnce(b, state, nAllocations);
+
+      if ((elapsed >= options.minTime) || (iterations >= MAX_ITERATIONS)) {
+	std::cout << std::left << std::setw(44) << b.name << std::right
+		  << std::setw(12) << iterations << std::setw(14)
+		  << std::fixed << std::setprecision(1)
+		  << (elapsed * 1e9 / iterations) << " ns" << std::setw(14)
+		  << std::setprecision(2)
+		  << ((double)nAllocations / iterations);
+	if (state.bytesProcessed()) {
+	  std::cout << std::setw(16)
+		    << formatRate(state.bytesProcessed() / elapsed, "B/s");
+	}
+	if (state.itemsProcessed()) {
+	  std::cout << std::setw(16)
+		    << formatRate(state.itemsProcessed() / elapsed,
+				  "items/s");
+	}
+	std::cout << std::endl;
+	return;
+      }
+
+      // Predict how many iterations will reach the minimum time, but
+      // don't grow by more than 10x when the last run was very short.
+      double multiplier = (options.minTime * 1.4) / std::max(elapsed, 1e-9);
+      if ((elapsed / options.minTime) <= 0.1) {
+	multiplier = std::min(multiplier, 10.0);
+      }
+      iterations = std::min(
+	  std::max((uint64_t)(iterations * multiplier), iterations + 1),
+	  MAX_ITERATIONS
+      );
+    }
+  }
+}
+
+int pistis::filesystem::benchmark::registerBenchmark(const std::string& name,
+						     BenchmarkFunction f) {
+  registry().push_back(RegisteredBenchmark{ name, f });
+  return (int)registry().size();
+}
+
+std::string pistis::filesystem::benchmark::getScratchDir() {
+  static const std::string SCRATCH_DIR = computeScratchDir();
+  return SCRATCH_DIR;
+}
+
+std::string pistis::filesystem::benchmark::getScratchFile(
+    const std::string& filename
+) {
+  return (!filename.empty() && (filename[0] == '/'))
+      ? filename : getScratchDir() + "/" + filename;
+}
+
+const std::string& pistis::filesystem::benchmark::getTextFile() {
+  static const std::string TEXT_FILE = createTextFile();
+  return TEXT_FILE;
+}
+
+int main(int argc, char** argv) {
+  Options options;
+  if (!parseOptions(argc, argv, options)) {
+    return 1;
+  }
+
+#ifndef __OPTIMIZE__
+  std::cout << "WARNING: Benchmarks were compiled without optimization.  "
+	    << "Rebuild with CONFIGURATION=RELEASE." << std::endl;
+#endif
+
+  try {
+    if (!options.listOnly) {
+      // Create the shared input file now so the first benchmark to use
+      // it doesn't pay for writing it
+      getTextFile();
+    }
+    std::cout << std::left << std::setw(44) << "Benchmark" << std::right
+	      << std::setw(12) << "Iterations" << std::setw(17) << "Time/iter"
+	      << std::setw(14) << "Allocs/iter" << std::setw(16)
+	      << "Throughput" << std::endl;
+    for (const RegisteredBenchmark& b : registry()) {
+      if (b.name.find(options.filter) == std::string::npos) {
+	continue;
+      } else if (options.listOnly) {
+	std::cout << b.name << std::endl;
+      } else {
+	run(b, options);
+      }
+    }
+  } catch (const std::exception& e) {
+    std::cerr << "Benchmark failed: " << e.what() << std::endl;
+    return 1;
+  }
+  return 0;
+}
+
+// Replace the global operator new so the harness can report allocations
+// per iteration.  operator new[] and the nothrow forms call these.
+void* operator new(size_t n) {
+  return allocate(n);
+}
+
+void* operator new(size_t n, std::align_val_t alignment) {
+  return allocateAligned(n, alignment);
+}
+
+void operator delete(void* p) noexcept {
+  ::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+  ::free(p);
+}
+
+void operator delete(void* p, std::align_val_t) noexcept {
+  ::free(p);
+}
+
+void operator delete(void* p, size_t, std::align_val_t) noexcept {
+  ::free(p);
+}
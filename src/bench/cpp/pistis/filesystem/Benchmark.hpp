@@ -0,0 +1,102 @@
+#ifndef __PISTIS__FILESYSTEM__BENCHMARK_HPP__
+#define __PISTIS__FILESYSTEM__BENCHMARK_HPP__
+
+/** @file Benchmark.hpp
+ *
+ *  A small, self-contained microbenchmark harness.  Benchmarks register
+ *  themselves with registerBenchmark() and are run by the "benchmarks"
+ *  executable, which repeats each one until it has run for at least
+ *  --min-time seconds and reports the time per iteration, the number of
+ *  calls to operator new per iteration and the throughput.
+ */
+
+#include <functional>
+#include <string>
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace pistis {
+  namespace filesystem {
+    namespace benchmark {
+
+      /** @brief Passed to a benchmark function to tell it how many
+       *         iterations to run and to collect its throughput.
+       */
+      class State {
+      public:
+	State(uint64_t iterations):
+	    iterations_(iterations), bytesProcessed_(0), itemsProcessed_(0) {
+	}
+
+	/** @brief Number of iterations the benchmark should run */
+	uint64_t iterations() const { return iterations_; }
+
+	uint64_t bytesProcessed() const { return bytesProcessed_; }
+	uint64_t itemsProcessed() const { return itemsProcessed_; }
+
+	/** @brief Record the total number of bytes processed by all
+	 *         iterations
+	 */
+	void setBytesProcessed(uint64_t n) { bytesProcessed_ = n; }
+
+	/** @brief Record the total number of items processed by all
+	 *         iterations
+	 */
+	void setItemsProcessed(uint64_t n) { itemsProcessed_ = n; }
+
+      private:
+	uint64_t iterations_;
+	uint64_t bytesProcessed_;
+	uint64_t itemsProcessed_;
+      };
+
+      typedef std::function<void (State&)> BenchmarkFunction;
+
+      /** @brief Add a benchmark to the set run by the benchmarks executable
+       *
+       *  Benchmarks run in the order they were registered.  Returns a
+       *  dummy value so registration can initialize a static variable.
+       */
+      int registerBenchmark(const std::string& name, BenchmarkFunction f);
+
+      /** @brief Keep the compiler from optimizing away the computation
+       *         of a value.
+       */
+      template <typename T>
+      inline void doNotOptimize(const T& value) {
+	asm volatile("" : : "g"(&value) : "memory");
+      }
+
+      /** @brief Returns a directory where benchmarks can write files.
+       *
+       *  Equal to PISTIS_FILESYSTEM_BENCH_SCRATCH_DIR if that environment
+       *  variable is set.  Otherwise, the scratch directory is
+       *  "${BENCH_EXECUTABLE_DIR}/../tmp."
+       */
+      std::string getScratchDir();
+
+      /** @brief Expand the given filename to a path in the scratch
+       *         directory.
+       */
+      std::string getScratchFile(const std::string& filename);
+
+      /** @brief Path to a text file of about 16 MB with lines of varying
+       *         length, created in the scratch directory on first use.
+       *
+       *  Most lines are 20 to 120 bytes long, and about one in a hundred
+       *  is between 1 and 4 KB.  The content is the same on every run.
+       */
+      const std::string& getTextFile();
+    }
+  }
+}
+
+/** @brief Define and register a benchmark function named NAME */
+#define PISTIS_BENCHMARK(NAME)						\
+  static void NAME(::pistis::filesystem::benchmark::State& state);	\
+  static const int NAME##_registered_ =					\
+      ::pistis::filesystem::benchmark::registerBenchmark(#NAME, NAME);	\
+  static void NAME(::pistis::filesystem::benchmark::State& state)
+
+#endif
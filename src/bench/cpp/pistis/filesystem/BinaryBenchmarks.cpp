@@ -0,0 +1,71 @@
+/** @file BinaryBenchmarks.cpp
+ *
+ *  Benchmarks for decoding a file of 32-bit little-endian fields with
+ *  File::readU32LE(), with a File::read() call per field as the baseline.
+ */
+
+#include "Benchmark.hpp"
+
+#include <pistis/filesystem/BinaryWriter.hpp>
+
+#include <string>
+
+using namespace pistis::filesystem;
+using namespace pistis::filesystem::benchmark;
+
+namespace {
+  static const size_t BINARY_FILE_SIZE = 16 * 1024 * 1024;
+  static const size_t NUM_FIELDS = BINARY_FILE_SIZE / 4;
+
+  std::string createBinaryFile() {
+    const std::string fileName = getScratchFile("bench_fields.dat");
+    File file = File::open(fileName, FileAccessMode::WRITE_ONLY,
+			   FileOpenOptions::TRUNCATE);
+    BinaryWriter writer(file);
+    for (size_t i = 0; i < NUM_FIELDS; ++i) {
+      writer.writeU32LE((uint32_t)(i * 2654435761u));
+    }
+    writer.flush();
+    return fileName;
+  }
+
+  const std::string& getBinaryFile() {
+    static const std::string BINARY_FILE = createBinaryFile();
+    return BINARY_FILE;
+  }
+
+  File openBinaryFile() {
+    return File::open(getBinaryFile(), FileCreationMode::OPEN_ONLY,
+		      FileAccessMode::READ_ONLY, FileOpenOptions::NONE,
+		      FilePermissions::ALL_RW, 64 * 1024);
+  }
+}
+
+PISTIS_BENCHMARK(Baseline_File_read_per_field) {
+  uint64_t total = 0;
+  getBinaryFile();
+  for (uint64_t i = 0; i < state.iterations(); ++i) {
+    File file = openBinaryFile();
+    uint8_t bytes[4];
+    while (file.read(bytes, sizeof(bytes)) == sizeof(bytes)) {
+      total += byteorder::loadLE<uint32_t>(bytes);
+    }
+  }
+  doNotOptimize(total);
+  state.setBytesProcessed(BINARY_FILE_SIZE * state.iterations());
+  state.setItemsProcessed(NUM_FIELDS * state.iterations());
+}
+
+PISTIS_BENCHMARK(File_readU32LE) {
+  uint64_t total = 0;
+  getBinaryFile();
+  for (uint64_t i = 0; i < state.iterations(); ++i) {
+    File file = openBinaryFile();
+    while (file.ensureBuffered(4)) {
+      total += file.readU32LE();
+    }
+  }
+  doNotOptimize(total);
+  state.setBytesProcessed(BINARY_FILE_SIZE * state.iterations());
+  state.setItemsProcessed(NUM_FIELDS * state.iterations());
+}
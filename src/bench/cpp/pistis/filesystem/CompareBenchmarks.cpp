@@ -0,0 +1,77 @@
+/** @file CompareBenchmarks.cpp
+ *
+ *  Benchmarks for comparing two identical files with
+ *  path::sameContent(), with a loop that reads 4 KB from each File and
+ *  compares them a byte at a time as the baseline.
+ */
+
+#include "Benchmark.hpp"
+
+#include <pistis/filesystem/File.hpp>
+#include <pistis/filesystem/Path.hpp>
+
+#include <algorithm>
+#include <string>
+
+using namespace pistis::filesystem;
+using namespace pistis::filesystem::benchmark;
+
+namespace {
+  static const size_t COMPARED_FILE_SIZE = 32 * 1024 * 1024;
+
+  std::string createComparedFile(const std::string& name) {
+    const std::string fileName = getScratchFile(name);
+    File file = File::open(fileName, FileAccessMode::WRITE_ONLY,
+			   FileOpenOptions::TRUNCATE);
+    std::string block(64 * 1024, ' ');
+    for (size_t i = 0; i < block.size(); ++i) {
+      block[i] = (char)('a' + (i * 7) % 26);
+    }
+    for (size_t n = 0; n < COMPARED_FILE_SIZE; n += block.size()) {
+      file.write(block.data(), block.size());
+    }
+    return fileName;
+  }
+
+  const std::string& getFirstFile() {
+    static const std::string FIRST_FILE =
+	createComparedFile("bench_compare_1.dat");
+    return FIRST_FILE;
+  }
+
+  const std::string& getSecondFile() {
+    static const std::string SECOND_FILE =
+	createComparedFile("bench_compare_2.dat");
+    return SECOND_FILE;
+  }
+}
+
+PISTIS_BENCHMARK(Baseline_File_read_and_compare_bytes) {
+  bool same = true;
+  getFirstFile();
+  getSecondFile();
+  for (uint64_t i = 0; i < state.iterations(); ++i) {
+    File first = File::open(getFirstFile(), FileAccessMode::READ_ONLY);
+    File second = File::open(getSecondFile(), FileAccessMode::READ_ONLY);
+    char a[4096];
+    char b[4096];
+    size_t n;
+    while ((n = first.read(a, sizeof(a))) > 0) {
+      second.read(b, n);
+      same = same && std::equal(a, a + n, b);
+    }
+  }
+  doNotOptimize(same);
+  state.setBytesProcessed(2 * COMPARED_FILE_SIZE * state.iterations());
+}
+
+PISTIS_BENCHMARK(Path_sameContent) {
+  bool same = true;
+  getFirstFile();
+  getSecondFile();
+  for (uint64_t i = 0; i < state.iterations(); ++i) {
+    same = same && path::sameContent(getFirstFile(), getSecondFile());
+  }
+  doNotOptimize(same);
+  state.setBytesProcessed(2 * COMPARED_FILE_SIZE * state.iterations());
+}
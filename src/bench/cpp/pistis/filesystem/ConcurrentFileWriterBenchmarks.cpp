@@ -0,0 +1,69 @@
+/** @file ConcurrentFileWriterBenchmarks.cpp
+ *
+ *  Benchmarks for logging from many threads with ConcurrentFileWriter,
+ *  with a mutex around File::write() as the baseline.
+ */
+
+#include "Benchmark.hpp"
+
+#include <pistis/filesystem/ConcurrentFileWriter.hpp>
+
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace pistis::filesystem;
+using namespace pistis::filesystem::benchmark;
+
+namespace {
+  static const int NUM_THREADS = 16;
+  static const int RECORDS_PER_THREAD = 10000;
+  static const std::string RECORD(std::string(99, 'r') + "\n");
+
+  template <typename Write>
+  void writeFromThreads(State& state, Write write) {
+    for (uint64_t i = 0; i < state.iterations(); ++i) {
+      std::vector<std::thread> threads;
+      for (int t = 0; t < NUM_THREADS; ++t) {
+	threads.emplace_back([&write]() {
+	  for (int j = 0; j < RECORDS_PER_THREAD; ++j) {
+	    write(RECORD);
+	  }
+	});
+      }
+      for (std::thread& thread : threads) {
+	thread.join();
+      }
+    }
+    const uint64_t n = state.iterations() * NUM_THREADS * RECORDS_PER_THREAD;
+    state.setBytesProcessed(n * RECORD.size());
+    state.setItemsProcessed(n);
+  }
+}
+
+PISTIS_BENCHMARK(Baseline_mutex_File_write_16_threads) {
+  const std::string fileName = getScratchFile("bench_log.txt");
+  File file = File::open(fileName, FileAccessMode::WRITE_ONLY,
+			 FileOpenOptions::TRUNCATE);
+  std::mutex mutex;
+
+  writeFromThreads(state, [&file, &mutex](const std::string& record) {
+    std::lock_guard<std::mutex> lock(mutex);
+    file.write(record.data(), record.size());
+  });
+  file.close();
+  File::unlink(fileName);
+}
+
+PISTIS_BENCHMARK(ConcurrentFileWriter_write_16_threads) {
+  const std::string fileName = getScratchFile("bench_log.txt");
+  ConcurrentFileWriter writer(File::open(fileName, FileAccessMode::WRITE_ONLY,
+					 FileOpenOptions::TRUNCATE));
+
+  writeFromThreads(state, [&writer](const std::string& record) {
+    writer.write(record);
+  });
+  writer.close();
+  File::unlink(fileName);
+}
@@ -0,0 +1,117 @@
+/** @file DelimitedBenchmarks.cpp
+ *
+ *  Benchmarks for splitting a TSV file into fields with File::eachRow(),
+ *  with readLine() followed by std::string::find() as the baseline.
+ */
+
+#include "Benchmark.hpp"
+
+#include <pistis/filesystem/File.hpp>
+
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace pistis::filesystem;
+using namespace pistis::filesystem::benchmark;
+
+namespace {
+  static const size_t TSV_FILE_SIZE = 16 * 1024 * 1024;
+  static const size_t NUM_COLUMNS = 8;
+
+  std::string createTsvFile() {
+    const std::string fileName = getScratchFile("bench_table.tsv");
+    std::mt19937 random(42);
+    std::uniform_int_distribution<int> fieldLength(1, 16);
+    std::uniform_int_distribution<int> letter('a', 'z');
+    std::string text;
+
+    text.reserve(TSV_FILE_SIZE + 4096);
+    while (text.size() < TSV_FILE_SIZE) {
+      for (size_t i = 0; i < NUM_COLUMNS; ++i) {
+	const int n = fieldLength(random);
+	for (int j = 0; j < n; ++j) {
+	  text.push_back((char)letter(random));
+	}
+	text.push_back((i + 1 < NUM_COLUMNS) ? '\t' : '\n');
+      }
+    }
+
+    File file = File::open(fileName, FileAccessMode::WRITE_ONLY,
+			   FileOpenOptions::TRUNCATE);
+    const char* p = text.data();
+    size_t n = text.size();
+    while (n) {
+      size_t nWritten = file.write(p, n);
+      p += nWritten;
+      n -= nWritten;
+    }
+    return fileName;
+  }
+
+  const std::string& getTsvFile() {
+    static const std::string TSV_FILE = createTsvFile();
+    return TSV_FILE;
+  }
+
+  File openTsvFile() {
+    return File::open(getTsvFile(), FileCreationMode::OPEN_ONLY,
+		      FileAccessMode::READ_ONLY, FileOpenOptions::NONE,
+		      FilePermissions::ALL_RW, 64 * 1024);
+  }
+
+  void eachRow(State& state, const std::vector<size_t>& columns) {
+    uint64_t total = 0;
+    uint64_t rows = 0;
+    getTsvFile();
+    for (uint64_t i = 0; i < state.iterations(); ++i) {
+      File file = openTsvFile();
+      file.eachRow(DelimitedFormat::TSV, columns,
+		   [&total, &rows](const DelimitedRow& row) {
+	  for (std::string_view field : row) {
+	    total += field.size();
+	  }
+	  ++rows;
+      });
+    }
+    doNotOptimize(total);
+    state.setBytesProcessed(rows ? (TSV_FILE_SIZE * state.iterations()) : 0);
+    state.setItemsProcessed(rows);
+  }
+}
+
+PISTIS_BENCHMARK(Baseline_readLine_find_TSV) {
+  uint64_t total = 0;
+  uint64_t rows = 0;
+  getTsvFile();
+  for (uint64_t i = 0; i < state.iterations(); ++i) {
+    File file = openTsvFile();
+    std::string line;
+    std::vector<std::string> fields;
+    while (file.readLine(line)) {
+      fields.clear();
+      size_t start = 0;
+      size_t end;
+      while ((end = line.find('\t', start)) != std::string::npos) {
+	fields.push_back(line.substr(start, end - start));
+	start = end + 1;
+      }
+      fields.push_back(line.substr(start, line.size() - start - 1));
+      for (const std::string& field : fields) {
+	total += field.size();
+      }
+      ++rows;
+    }
+  }
+  doNotOptimize(total);
+  state.setBytesProcessed(TSV_FILE_SIZE * state.iterations());
+  state.setItemsProcessed(rows);
+}
+
+PISTIS_BENCHMARK(File_eachRow_TSV) {
+  eachRow(state, { });
+}
+
+PISTIS_BENCHMARK(File_eachRow_TSV_2_columns) {
+  eachRow(state, { 1, 5 });
+}
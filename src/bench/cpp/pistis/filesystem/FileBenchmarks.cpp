@@ -0,0 +1,210 @@
+/** @file FileBenchmarks.cpp
+ *
+ *  Benchmarks for reading and writing with pistis::filesystem::File, with
+ *  std::ifstream, fgets() and raw read() as baselines.
+ */
+
+#include "Benchmark.hpp"
+
+#include <pistis/filesystem/File.hpp>
+#include <pistis/filesystem/Path.hpp>
+
+#include <fstream>
+#include <memory>
+#include <string>
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+using namespace pistis::filesystem;
+using namespace pistis::filesystem::benchmark;
+
+namespace {
+  static const size_t WRITE_SIZE = 16 * 1024 * 1024;
+
+  File openTextFile() {
+    return File::open(getTextFile(), FileCreationMode::OPEN_ONLY,
+		      FileAccessMode::READ_ONLY);
+  }
+
+  void readFile(State& state, size_t n) {
+    std::unique_ptr<uint8_t[]> buffer(new uint8_t[n]);
+    uint64_t total = 0;
+    for (uint64_t i = 0; i < state.iterations(); ++i) {
+      File file = openTextFile();
+      size_t nRead;
+      while ((nRead = file.read(buffer.get(), n)) != 0) {
+	total += nRead;
+      }
+    }
+    state.setBytesProcessed(total);
+  }
+
+  void eachChunk(State& state, size_t n) {
+    uint64_t total = 0;
+    for (uint64_t i = 0; i < state.iterations(); ++i) {
+      File file = openTextFile();
+      file.eachChunk(n, [&total](uint8_t* data, size_t nRead) {
+	  doNotOptimize(data);
+	  total += nRead;
+      });
+    }
+    state.setBytesProcessed(total);
+  }
+
+  void writeFile(State& state, size_t n) {
+    const std::string fileName = getScratchFile("bench_write.txt");
+    std::unique_ptr<uint8_t[]> buffer(new uint8_t[n]);
+    uint64_t total = 0;
+
+    ::memset(buffer.get(), 'x', n);
+    for (uint64_t i = 0; i < state.iterations(); ++i) {
+      File file = File::open(fileName, FileAccessMode::WRITE_ONLY,
+			     FileOpenOptions::TRUNCATE);
+      for (size_t written = 0; written < WRITE_SIZE; written += n) {
+	total += file.write(buffer.get(), n);
+      }
+    }
+    state.setBytesProcessed(total);
+    File::unlink(fileName);
+  }
+
+  void rawRead(State& state, size_t n) {
+    std::unique_ptr<uint8_t[]> buffer(new uint8_t[n]);
+    uint64_t total = 0;
+    for (uint64_t i = 0; i < state.iterations(); ++i) {
+      int fd = ::open(getTextFile().c_str(), O_RDONLY);
+      ssize_t nRead;
+      while ((nRead = ::read(fd, buffer.get(), n)) > 0) {
+	total += nRead;
+      }
+      ::close(fd);
+    }
+    state.setBytesProcessed(total);
+  }
+
+  int registerSizedBenchmarks() {
+    for (size_t n : { 64, 4096, 65536, 1048576 }) {
+      const std::string size = std::to_string(n);
+      registerBenchmark("File_read/" + size,
+			[n](State& state) { readFile(state, n); });
+      registerBenchmark("Baseline_read/" + size,
+			[n](State& state) { rawRead(state, n); });
+    }
+    for (size_t n : { 4096, 65536 }) {
+      registerBenchmark("File_eachChunk/" + std::to_string(n),
+			[n](State& state) { eachChunk(state, n); });
+    }
+    for (size_t n : { 64, 4096, 65536 }) {
+      registerBenchmark("File_write/" + std::to_string(n),
+			[n](State& state) { writeFile(state, n); });
+    }
+    return 0;
+  }
+}
+
+PISTIS_BENCHMARK(File_readLine) {
+  uint64_t total = 0;
+  uint64_t lines = 0;
+  for (uint64_t i = 0; i < state.iterations(); ++i) {
+    File file = openTextFile();
+    std::string line = file.readLine();
+    while (!line.empty()) {
+      total += line.size();
+      ++lines;
+      line = file.readLine();
+    }
+  }
+  state.setBytesProcessed(total);
+  state.setItemsProcessed(lines);
+}
+
+PISTIS_BENCHMARK(File_eachLine) {
+  uint64_t total = 0;
+  uint64_t lines = 0;
+  for (uint64_t i = 0; i < state.iterations(); ++i) {
+    File file = openTextFile();
+    file.eachLine([&total, &lines](const std::string& line) {
+	total += line.size();
+	++lines;
+    });
+  }
+  state.setBytesProcessed(total);
+  state.setItemsProcessed(lines);
+}
+
+PISTIS_BENCHMARK(File_eachLineBatch) {
+  uint64_t total = 0;
+  uint64_t lines = 0;
+  for (uint64_t i = 0; i < state.iterations(); ++i) {
+    File file = openTextFile();
+    file.eachLineBatch(1024, [&total, &lines](const uint8_t* base,
+					      const LineSpan* spans,
+					      size_t n) {
+	for (size_t j = 0; j < n; ++j) {
+	  total += spans[j].length;
+	}
+	lines += n;
+	doNotOptimize(base);
+    });
+  }
+  state.setBytesProcessed(total);
+  state.setItemsProcessed(lines);
+}
+
+PISTIS_BENCHMARK(Baseline_File_readLines_size) {
+  const uint64_t size = path::fileSize(getTextFile());
+  uint64_t lines = 0;
+  for (uint64_t i = 0; i < state.iterations(); ++i) {
+    File file = openTextFile();
+    lines += file.readLines().size();
+  }
+  state.setBytesProcessed(size * state.iterations());
+  state.setItemsProcessed(lines);
+}
+
+PISTIS_BENCHMARK(File_countLines) {
+  const uint64_t size = path::fileSize(getTextFile());
+  uint64_t lines = 0;
+  for (uint64_t i = 0; i < state.iterations(); ++i) {
+    File file = openTextFile();
+    lines += file.countLines();
+  }
+  state.setBytesProcessed(size * state.iterations());
+  state.setItemsProcessed(lines);
+}
+
+PISTIS_BENCHMARK(Baseline_ifstream_getline) {
+  uint64_t total = 0;
+  uint64_t lines = 0;
+  for (uint64_t i = 0; i < state.iterations(); ++i) {
+    std::ifstream input(getTextFile());
+    std::string line;
+    while (std::getline(input, line)) {
+      total += line.size() + 1;
+      ++lines;
+    }
+  }
+  state.setBytesProcessed(total);
+  state.setItemsProcessed(lines);
+}
+
+PISTIS_BENCHMARK(Baseline_fgets) {
+  char line[8192];
+  uint64_t total = 0;
+  uint64_t lines = 0;
+  for (uint64_t i = 0; i < state.iterations(); ++i) {
+    FILE* input = ::fopen(getTextFile().c_str(), "r");
+    while (::fgets(line, sizeof(line), input)) {
+      total += ::strlen(line);
+      ++lines;
+    }
+    ::fclose(input);
+  }
+  state.setBytesProcessed(total);
+  state.setItemsProcessed(lines);
+}
+
+static const int sizedBenchmarksRegistered_ = registerSizedBenchmarks();
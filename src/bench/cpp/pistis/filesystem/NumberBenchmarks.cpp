@@ -0,0 +1,89 @@
+/** @file NumberBenchmarks.cpp
+ *
+ *  Benchmarks for parsing a file of numbers with File::readDouble(), with
+ *  readLine() followed by std::stod() as the baseline.
+ */
+
+#include "Benchmark.hpp"
+
+#include <pistis/filesystem/File.hpp>
+
+#include <random>
+#include <sstream>
+#include <string>
+
+using namespace pistis::filesystem;
+using namespace pistis::filesystem::benchmark;
+
+namespace {
+  static const size_t NUMBER_FILE_SIZE = 16 * 1024 * 1024;
+
+  std::string createNumberFile() {
+    const std::string fileName = getScratchFile("bench_numbers.txt");
+    std::mt19937 random(42);
+    std::normal_distribution<double> value(0.0, 1000.0);
+    std::ostringstream out;
+
+    out.precision(10);
+    while ((size_t)out.tellp() < NUMBER_FILE_SIZE) {
+      out << value(random) << "\n";
+    }
+
+    const std::string text = out.str();
+    File file = File::open(fileName, FileAccessMode::WRITE_ONLY,
+			   FileOpenOptions::TRUNCATE);
+    const char* p = text.data();
+    size_t n = text.size();
+    while (n) {
+      size_t nWritten = file.write(p, n);
+      p += nWritten;
+      n -= nWritten;
+    }
+    return fileName;
+  }
+
+  const std::string& getNumberFile() {
+    static const std::string NUMBER_FILE = createNumberFile();
+    return NUMBER_FILE;
+  }
+
+  File openNumberFile() {
+    return File::open(getNumberFile(), FileCreationMode::OPEN_ONLY,
+		      FileAccessMode::READ_ONLY, FileOpenOptions::NONE,
+		      FilePermissions::ALL_RW, 64 * 1024);
+  }
+}
+
+PISTIS_BENCHMARK(Baseline_readLine_stod) {
+  double total = 0.0;
+  uint64_t count = 0;
+  getNumberFile();
+  for (uint64_t i = 0; i < state.iterations(); ++i) {
+    File file = openNumberFile();
+    std::string line;
+    while (file.readLine(line)) {
+      total += std::stod(line);
+      ++count;
+    }
+  }
+  doNotOptimize(total);
+  state.setBytesProcessed(NUMBER_FILE_SIZE * state.iterations());
+  state.setItemsProcessed(count);
+}
+
+PISTIS_BENCHMARK(File_readDouble) {
+  double total = 0.0;
+  uint64_t count = 0;
+  getNumberFile();
+  for (uint64_t i = 0; i < state.iterations(); ++i) {
+    File file = openNumberFile();
+    double value;
+    while (file.readDouble(value)) {
+      total += value;
+      ++count;
+    }
+  }
+  doNotOptimize(total);
+  state.setBytesProcessed(NUMBER_FILE_SIZE * state.iterations());
+  state.setItemsProcessed(count);
+}
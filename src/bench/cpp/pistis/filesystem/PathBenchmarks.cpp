@@ -0,0 +1,143 @@
+/** @file PathBenchmarks.cpp
+ *
+ *  Benchmarks for the functions in pistis/filesystem/Path.hpp
+ */
+
+#include "Benchmark.hpp"
+
+#include <pistis/filesystem/Path.hpp>
+
+#include <string>
+#include <vector>
+
+#include <stdlib.h>
+
+using namespace pistis::filesystem;
+using namespace pistis::filesystem::benchmark;
+
+namespace {
+  static const std::vector<std::string> PATHS{
+    "/usr/local/lib/libpistis_filesystem.so.0.1",
+    "relative/path/to/some/file.txt",
+    "/var/log/",
+    "//srv//data///shard-0001/part-00042.gz",
+    "file",
+    "/home/somebody/.hidden/config/settings.json"
+  };
+}
+
+PISTIS_BENCHMARK(Path_join) {
+  for (uint64_t i = 0; i < state.iterations(); ++i) {
+    std::string joined = path::join(PATHS[i % PATHS.size()], "dir",
+				    "file.txt");
+    doNotOptimize(joined);
+  }
+  state.setItemsProcessed(state.iterations());
+}
+
+PISTIS_BENCHMARK(Path_split) {
+  for (uint64_t i = 0; i < state.iterations(); ++i) {
+    std::vector<std::string> components =
+	path::split(PATHS[i % PATHS.size()]);
+    doNotOptimize(components);
+  }
+  state.setItemsProcessed(state.iterations());
+}
+
+PISTIS_BENCHMARK(Path_splitViewsAndCall) {
+  size_t total = 0;
+  for (uint64_t i = 0; i < state.iterations(); ++i) {
+    path::splitViewsAndCall(PATHS[i % PATHS.size()],
+			    [&total](std::string_view component) {
+      total += component.size();
+    });
+  }
+  doNotOptimize(total);
+  state.setItemsProcessed(state.iterations());
+}
+
+PISTIS_BENCHMARK(Path_relativePath) {
+  static const std::string BASE("/usr/local/share/doc");
+  static const std::vector<std::string> TARGETS{
+    "/usr/local/lib/libpistis_filesystem.so.0.1",
+    "/usr/local/share/doc/pistis/README.md",
+    "/usr/bin/env"
+  };
+  for (uint64_t i = 0; i < state.iterations(); ++i) {
+    std::string relative =
+	path::relativePath(TARGETS[i % TARGETS.size()], BASE);
+    doNotOptimize(relative);
+  }
+  state.setItemsProcessed(state.iterations());
+}
+
+PISTIS_BENCHMARK(Path_commonPrefix) {
+  static const std::string BASE("/usr/local/share/doc/pistis/html");
+  for (uint64_t i = 0; i < state.iterations(); ++i) {
+    std::string prefix = path::commonPrefix(PATHS[i % PATHS.size()], BASE);
+    doNotOptimize(prefix);
+  }
+  state.setItemsProcessed(state.iterations());
+}
+
+PISTIS_BENCHMARK(Path_expandVars) {
+  ::setenv("PISTIS_BENCH_ROOT", "/srv/data", 1);
+  ::setenv("PISTIS_BENCH_SHARD", "shard-0001", 1);
+  for (uint64_t i = 0; i < state.iterations(); ++i) {
+    std::string expanded = path::expandVars(
+	"${PISTIS_BENCH_ROOT}/$PISTIS_BENCH_SHARD/part-00042.gz"
+    );
+    doNotOptimize(expanded);
+  }
+  state.setItemsProcessed(state.iterations());
+}
+
+PISTIS_BENCHMARK(Path_normalizePath) {
+  const std::string dir = getScratchDir();
+  const std::string p = dir + "/../" + path::baseName(dir) + "/./.";
+  for (uint64_t i = 0; i < state.iterations(); ++i) {
+    std::string normalized = path::normalizePath(p);
+    doNotOptimize(normalized);
+  }
+  state.setItemsProcessed(state.iterations());
+}
+
+PISTIS_BENCHMARK(Path_baseNameAndExtension) {
+  for (uint64_t i = 0; i < state.iterations(); ++i) {
+    const std::string& p = PATHS[i % PATHS.size()];
+    std::string base = path::baseName(p);
+    std::string ext = path::extension(p);
+    doNotOptimize(base);
+    doNotOptimize(ext);
+  }
+  state.setItemsProcessed(state.iterations());
+}
+
+PISTIS_BENCHMARK(Path_baseNameAndExtension_string_view) {
+  for (uint64_t i = 0; i < state.iterations(); ++i) {
+    const std::string_view p = PATHS[i % PATHS.size()];
+    std::string_view base = path::baseName(p);
+    std::string_view ext = path::extension(p);
+    doNotOptimize(base);
+    doNotOptimize(ext);
+  }
+  state.setItemsProcessed(state.iterations());
+}
+
+PISTIS_BENCHMARK(Path_splitFile) {
+  for (uint64_t i = 0; i < state.iterations(); ++i) {
+    std::tuple<std::string, std::string> parts =
+	path::splitFile(PATHS[i % PATHS.size()]);
+    doNotOptimize(parts);
+  }
+  state.setItemsProcessed(state.iterations());
+}
+
+PISTIS_BENCHMARK(Path_splitFile_string_view) {
+  for (uint64_t i = 0; i < state.iterations(); ++i) {
+    std::tuple<std::string_view, std::string_view> parts =
+	path::splitFile(std::string_view(PATHS[i % PATHS.size()]));
+    doNotOptimize(parts);
+  }
+  state.setItemsProcessed(state.iterations());
+}
@@ -0,0 +1,69 @@
+/** @file SearchBenchmarks.cpp
+ *
+ *  Benchmarks for searching a text file for a literal with
+ *  File::findAll() and File::eachMatchingLine(), with readLine() and
+ *  std::string::find() as the baseline.
+ */
+
+#include "Benchmark.hpp"
+
+#include <pistis/filesystem/File.hpp>
+#include <pistis/filesystem/Path.hpp>
+
+#include <string>
+
+using namespace pistis::filesystem;
+using namespace pistis::filesystem::benchmark;
+
+namespace {
+  // Rare in the random text, so the search mostly scans
+  static const std::string PATTERN("qzx");
+
+  File openTextFile() {
+    return File::open(getTextFile(), FileCreationMode::OPEN_ONLY,
+		      FileAccessMode::READ_ONLY);
+  }
+}
+
+PISTIS_BENCHMARK(Baseline_readLine_and_find) {
+  const uint64_t size = path::fileSize(getTextFile());
+  uint64_t matches = 0;
+  for (uint64_t i = 0; i < state.iterations(); ++i) {
+    File file = openTextFile();
+    std::string line;
+    while (file.readLine(line)) {
+      size_t j = 0;
+      while ((j = line.find(PATTERN, j)) != std::string::npos) {
+	++matches;
+	j += PATTERN.size();
+      }
+    }
+  }
+  doNotOptimize(matches);
+  state.setBytesProcessed(size * state.iterations());
+}
+
+PISTIS_BENCHMARK(File_findAll) {
+  const uint64_t size = path::fileSize(getTextFile());
+  uint64_t matches = 0;
+  for (uint64_t i = 0; i < state.iterations(); ++i) {
+    File file = openTextFile();
+    matches += file.findAll(PATTERN).size();
+  }
+  doNotOptimize(matches);
+  state.setBytesProcessed(size * state.iterations());
+}
+
+PISTIS_BENCHMARK(File_eachMatchingLine) {
+  const uint64_t size = path::fileSize(getTextFile());
+  uint64_t matches = 0;
+  for (uint64_t i = 0; i < state.iterations(); ++i) {
+    File file = openTextFile();
+    file.eachMatchingLine(PATTERN, [&matches](uint64_t,
+					      std::string_view line) {
+      matches += line.size();
+    });
+  }
+  doNotOptimize(matches);
+  state.setBytesProcessed(size * state.iterations());
+}
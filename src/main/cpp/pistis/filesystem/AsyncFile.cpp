@@ -0,0 +1,220 @@
+#include "AsyncFile.hpp"
+
+#if (__cplusplus >= 202002L) && defined(__cpp_impl_coroutine)
+
+#include <pistis/exceptions/IOError.hpp>
+
+#include <algorithm>
+
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+using namespace pistis::filesystem;
+using namespace pistis::exceptions;
+
+const size_t AsyncExecutor::DEFAULT_BLOCKING_THREADS;
+
+// A coroutine that nobody awaits.  It starts suspended so spawn() can
+// queue it, and destroys itself when it finishes.
+class AsyncExecutor::Detached {
+public:
+  struct promise_type {
+    Detached get_return_object() {
+      return Detached(
+	  std::coroutine_handle<promise_type>::from_promise(*this)
+      );
+    }
+    std::suspend_always initial_suspend() const noexcept { return { }; }
+    std::suspend_never final_suspend() const noexcept { return { }; }
+    void return_void() const { }
+    void unhandled_exception() const { std::terminate(); }
+  };
+
+  explicit Detached(std::coroutine_handle<> h): handle(h) { }
+
+  std::coroutine_handle<> handle;
+};
+
+void AsyncExecutor::ReadyAwaitable::await_suspend(std::coroutine_handle<> h) {
+  AsyncExecutor* executor = executor_;
+  const int fd = fd_;
+  executor->reactor_.add(fd, events_, [executor, fd, h](uint32_t) {
+    executor->reactor_.remove(fd);
+    executor->ready_.push_back(h);
+  });
+}
+
+void AsyncExecutor::OffloadAwaitable::await_suspend(
+    std::coroutine_handle<> h
+) {
+  executor_->submit_([this, h]() {
+    try {
+      job_();
+    } catch(...) {
+      error_ = std::current_exception();
+    }
+    executor_->complete_(h);
+  });
+}
+
+void AsyncExecutor::OffloadAwaitable::await_resume() const {
+  if (error_) {
+    std::rethrow_exception(error_);
+  }
+}
+
+AsyncExecutor::AsyncExecutor(size_t blockingThreads):
+    reactor_(), ready_(), active_(0), firstError_(), workers_(), jobs_(),
+    completed_(), mutex_(), jobAvailable_(), shutdown_(false), doneFd_(-1) {
+  doneFd_ = ::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+  if (doneFd_ < 0) {
+    throw IOError::fromSystemError("Error creating eventfd: #ERR#",
+				   PISTIS_EX_HERE);
+  }
+  reactor_.add(doneFd_, Reactor::READABLE,
+	       [this](uint32_t) { collectCompleted_(); });
+
+  const size_t n = std::max<size_t>(blockingThreads, 1);
+  workers_.reserve(n);
+  for (size_t i = 0; i < n; ++i) {
+    workers_.emplace_back([this]() { work_(); });
+  }
+}
+
+AsyncExecutor::~AsyncExecutor() {
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    shutdown_ = true;
+  }
+  jobAvailable_.notify_all();
+  for (std::thread& worker : workers_) {
+    worker.join();
+  }
+  reactor_.remove(doneFd_);
+  ::close(doneFd_);
+}
+
+void AsyncExecutor::spawn(Task<void> task) {
+  ++active_;
+  ready_.push_back(runDetached_(this, std::move(task)).handle);
+}
+
+void AsyncExecutor::run() {
+  while (active_) {
+    while (!ready_.empty()) {
+      std::coroutine_handle<> h = ready_.front();
+      ready_.pop_front();
+      h.resume();
+    }
+    if (active_) {
+      reactor_.runOnce();
+    }
+  }
+
+  if (firstError_) {
+    std::exception_ptr error = firstError_;
+    firstError_ = nullptr;
+    std::rethrow_exception(error);
+  }
+}
+
+void AsyncExecutor::submit_(std::function<void ()> job) {
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    jobs_.push_back(std::move(job));
+  }
+  jobAvailable_.notify_one();
+}
+
+void AsyncExecutor::complete_(std::coroutine_handle<> h) {
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    completed_.push_back(h);
+  }
+  const uint64_t one = 1;
+  ssize_t nWritten = ::write(doneFd_, &one, sizeof(one));
+  (void)nWritten;
+}
+
+void AsyncExecutor::collectCompleted_() {
+  uint64_t count;
+  ssize_t nRead = ::read(doneFd_, &count, sizeof(count));
+  (void)nRead;
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  ready_.insert(ready_.end(), completed_.begin(), completed_.end());
+  completed_.clear();
+}
+
+void AsyncExecutor::work_() {
+  while (true) {
+    std::function<void ()> job;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      jobAvailable_.wait(lock, [this]() { return shutdown_ || !jobs_.empty(); });
+      if (jobs_.empty()) {
+	return;
+      }
+      job = std::move(jobs_.front());
+      jobs_.pop_front();
+    }
+    job();
+  }
+}
+
+AsyncExecutor::Detached AsyncExecutor::runDetached_(AsyncExecutor* executor,
+						    Task<void> task) {
+  try {
+    co_await task;
+  } catch(...) {
+    if (!executor->firstError_) {
+      executor->firstError_ = std::current_exception();
+    }
+  }
+  --executor->active_;
+}
+
+Task<size_t> pistis::filesystem::asyncRead(AsyncExecutor& executor,
+					   File& file, void* buffer,
+					   size_t n) {
+  size_t nRead;
+  if (file.nonBlocking()) {
+    while ((nRead = file.tryRead(buffer, n)) == File::WOULD_BLOCK) {
+      co_await executor.readable(file.fd());
+    }
+  } else {
+    co_await executor.offload([&]() { nRead = file.read(buffer, n); });
+  }
+  co_return nRead;
+}
+
+Task<size_t> pistis::filesystem::asyncWrite(AsyncExecutor& executor,
+					    File& file, const void* buffer,
+					    size_t n) {
+  size_t nWritten;
+  if (file.nonBlocking()) {
+    while ((nWritten = file.tryWrite(buffer, n)) == File::WOULD_BLOCK) {
+      co_await executor.writable(file.fd());
+    }
+  } else {
+    co_await executor.offload([&]() { nWritten = file.write(buffer, n); });
+  }
+  co_return nWritten;
+}
+
+Task<bool> pistis::filesystem::asyncReadLine(AsyncExecutor& executor,
+					     File& file, std::string& line) {
+  bool found;
+  if (file.nonBlocking()) {
+    size_t n;
+    while ((n = file.tryReadLine(line)) == File::WOULD_BLOCK) {
+      co_await executor.readable(file.fd());
+    }
+    found = n != 0;
+  } else {
+    co_await executor.offload([&]() { found = file.readLine(line); });
+  }
+  co_return found;
+}
+
+#endif
@@ -0,0 +1,295 @@
+#ifndef __PISTIS__FILESYSTEM__ASYNCFILE_HPP__
+#define __PISTIS__FILESYSTEM__ASYNCFILE_HPP__
+
+/** @file AsyncFile.hpp
+ *
+ *  Coroutine versions of File's read(), write() and readLine(), and the
+ *  executor that runs them.
+ *
+ *  Requires C++20.  The library only contains this API when it is built
+ *  with CXX_STANDARD=c++20 or later, and including this header from an
+ *  earlier standard declares nothing.
+ */
+
+#if (__cplusplus >= 202002L) && defined(__cpp_impl_coroutine)
+
+#include <pistis/filesystem/File.hpp>
+#include <pistis/filesystem/Reactor.hpp>
+
+#include <condition_variable>
+#include <coroutine>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <stddef.h>
+
+namespace pistis {
+  namespace filesystem {
+
+    template <typename T> class Task;
+
+    /** @brief State shared by the promises of every Task type */
+    class TaskPromiseBase {
+    public:
+      struct FinalAwaiter {
+	bool await_ready() const noexcept { return false; }
+
+	template <typename Promise>
+	std::coroutine_handle<> await_suspend(
+	    std::coroutine_handle<Promise> h
+	) noexcept {
+	  std::coroutine_handle<> next = h.promise().continuation();
+	  return next ? next : std::noop_coroutine();
+	}
+
+	void await_resume() const noexcept { }
+      };
+
+      std::suspend_always initial_suspend() const noexcept { return { }; }
+      FinalAwaiter final_suspend() const noexcept { return { }; }
+      void unhandled_exception() { error_ = std::current_exception(); }
+
+      std::coroutine_handle<> continuation() const { return continuation_; }
+      void setContinuation(std::coroutine_handle<> h) { continuation_ = h; }
+
+    protected:
+      std::coroutine_handle<> continuation_;
+      std::exception_ptr error_;
+
+      void rethrow_() const {
+	if (error_) {
+	  std::rethrow_exception(error_);
+	}
+      }
+    };
+
+    template <typename T>
+    class TaskPromise : public TaskPromiseBase {
+    public:
+      Task<T> get_return_object();
+      void return_value(T value) { value_ = std::move(value); }
+
+      T result() {
+	rethrow_();
+	return std::move(*value_);
+      }
+
+    private:
+      std::optional<T> value_;
+    };
+
+    template <>
+    class TaskPromise<void> : public TaskPromiseBase {
+    public:
+      Task<void> get_return_object();
+      void return_void() const { }
+      void result() const { rethrow_(); }
+    };
+
+    /** @brief A coroutine that produces a T.
+     *
+     *  Tasks start when they are awaited, and resume their awaiter when
+     *  they finish.  Exceptions thrown inside the task are rethrown by
+     *  co_await.  Run a top-level Task<void> with AsyncExecutor::spawn().
+     */
+    template <typename T>
+    class Task {
+    public:
+      typedef TaskPromise<T> promise_type;
+      typedef std::coroutine_handle<promise_type> Handle;
+
+    public:
+      Task(): handle_() { }
+      explicit Task(Handle h): handle_(h) { }
+      Task(const Task&) = delete;
+      Task(Task&& other): handle_(std::exchange(other.handle_, nullptr)) { }
+      ~Task() {
+	if (handle_) {
+	  handle_.destroy();
+	}
+      }
+
+      bool await_ready() const noexcept { return !handle_ || handle_.done(); }
+
+      std::coroutine_handle<> await_suspend(std::coroutine_handle<> h) {
+	handle_.promise().setContinuation(h);
+	return handle_;
+      }
+
+      T await_resume() { return handle_.promise().result(); }
+
+      Task& operator=(const Task&) = delete;
+      Task& operator=(Task&& other) {
+	if (this != &other) {
+	  if (handle_) {
+	    handle_.destroy();
+	  }
+	  handle_ = std::exchange(other.handle_, nullptr);
+	}
+	return *this;
+      }
+
+    private:
+      Handle handle_;
+    };
+
+    template <typename T>
+    inline Task<T> TaskPromise<T>::get_return_object() {
+      return Task<T>(Task<T>::Handle::from_promise(*this));
+    }
+
+    inline Task<void> TaskPromise<void>::get_return_object() {
+      return Task<void>(Task<void>::Handle::from_promise(*this));
+    }
+
+    /** @brief Runs coroutines on one thread, resuming them when their
+     *         I/O completes.
+     *
+     *  Pipes, FIFOs and sockets in non-blocking mode wait on a Reactor,
+     *  so any number of them cost no threads.  epoll can't watch regular
+     *  files, so I/O on them, and on any file in blocking mode, runs on
+     *  a small pool of threads while the coroutine is suspended.
+     *  Coroutines themselves always run on the thread that calls run().
+     *
+     *  A File may have only one asynchronous operation outstanding at a
+     *  time.
+     */
+    class AsyncExecutor {
+    public:
+      static const size_t DEFAULT_BLOCKING_THREADS = 4;
+
+      /** @brief Suspends the awaiting coroutine until a descriptor is
+       *         ready
+       */
+      class ReadyAwaitable {
+      public:
+	ReadyAwaitable(AsyncExecutor* executor, int fd, uint32_t events):
+	    executor_(executor), fd_(fd), events_(events) {
+	}
+
+	bool await_ready() const noexcept { return false; }
+	void await_suspend(std::coroutine_handle<> h);
+	void await_resume() const noexcept { }
+
+      private:
+	AsyncExecutor* executor_;
+	int fd_;
+	uint32_t events_;
+      };
+
+      /** @brief Suspends the awaiting coroutine while a function runs on
+       *         the executor's thread pool
+       */
+      class OffloadAwaitable {
+      public:
+	OffloadAwaitable(AsyncExecutor* executor, std::function<void ()> job):
+	    executor_(executor), job_(std::move(job)), error_() {
+	}
+
+	bool await_ready() const noexcept { return false; }
+	void await_suspend(std::coroutine_handle<> h);
+	void await_resume() const;
+
+      private:
+	AsyncExecutor* executor_;
+	std::function<void ()> job_;
+	std::exception_ptr error_;
+      };
+
+    public:
+      AsyncExecutor(size_t blockingThreads = DEFAULT_BLOCKING_THREADS);
+      AsyncExecutor(const AsyncExecutor&) = delete;
+      ~AsyncExecutor();
+
+      /** @brief Start task the next time run() is called, or on its
+       *         next pass if it is running.
+       */
+      void spawn(Task<void> task);
+
+      /** @brief Run coroutines until every spawned task finishes.
+       *
+       *  If a spawned task throws, the other tasks still run to
+       *  completion, and then run() rethrows the first exception.
+       */
+      void run();
+
+      /** @brief Suspend until fd has data to read */
+      ReadyAwaitable readable(int fd) {
+	return ReadyAwaitable(this, fd, Reactor::READABLE);
+      }
+
+      /** @brief Suspend until fd has room to write */
+      ReadyAwaitable writable(int fd) {
+	return ReadyAwaitable(this, fd, Reactor::WRITABLE);
+      }
+
+      /** @brief Run job on the thread pool and suspend until it ends.
+       *
+       *  Exceptions thrown by job are rethrown in the coroutine.
+       */
+      OffloadAwaitable offload(std::function<void ()> job) {
+	return OffloadAwaitable(this, std::move(job));
+      }
+
+      AsyncExecutor& operator=(const AsyncExecutor&) = delete;
+
+    private:
+      class Detached;
+
+      Reactor reactor_;
+      std::deque<std::coroutine_handle<>> ready_;
+      size_t active_;
+      std::exception_ptr firstError_;
+
+      // Thread pool.  Workers take jobs from jobs_ and, when they finish,
+      // put the suspended coroutine on completed_ and signal doneFd_,
+      // which wakes the reactor.
+      std::vector<std::thread> workers_;
+      std::deque<std::function<void ()>> jobs_;
+      std::vector<std::coroutine_handle<>> completed_;
+      std::mutex mutex_;
+      std::condition_variable jobAvailable_;
+      bool shutdown_;
+      int doneFd_;
+
+      void submit_(std::function<void ()> job);
+      void complete_(std::coroutine_handle<> h);
+      void collectCompleted_();
+      void work_();
+
+      static Detached runDetached_(AsyncExecutor* executor, Task<void> task);
+    };
+
+    /** @brief Read up to n bytes from file, as File::read() does, but
+     *         without blocking the executor's thread.
+     */
+    Task<size_t> asyncRead(AsyncExecutor& executor, File& file,
+			   void* buffer, size_t n);
+
+    /** @brief Write up to n bytes to file, as File::write() does, but
+     *         without blocking the executor's thread.
+     */
+    Task<size_t> asyncWrite(AsyncExecutor& executor, File& file,
+			    const void* buffer, size_t n);
+
+    /** @brief Read the next line into line, as File::readLine() does,
+     *         but without blocking the executor's thread.
+     *
+     *  Returns false at the end of the file.
+     */
+    Task<bool> asyncReadLine(AsyncExecutor& executor, File& file,
+			     std::string& line);
+
+  }
+}
+
+#endif
+
+#endif
@@ -0,0 +1,76 @@
+#include "BinaryWriter.hpp"
+
+#include <pistis/exceptions/IOError.hpp>
+
+#include <string.h>
+
+using namespace pistis::exceptions;
+using namespace pistis::filesystem;
+
+const size_t BinaryWriter::DEFAULT_BUFFER_SIZE;
+
+BinaryWriter::BinaryWriter(File& file, size_t bufferSize):
+    file_(file), buffer_(), size_(bufferSize ? bufferSize : 1), used_(0) {
+  buffer_.reset(new uint8_t[size_]);
+}
+
+BinaryWriter::~BinaryWriter() {
+  try {
+    flush();
+  } catch(...) {
+    // Call flush() explicitly to see errors
+  }
+}
+
+void BinaryWriter::writeVarint(uint64_t v) {
+  if (size_ - used_ < byteorder::MAX_VARINT_SIZE) {
+    makeRoom_(byteorder::MAX_VARINT_SIZE);
+  }
+  uint8_t* p = buffer_.get() + used_;
+  while (v >= 0x80) {
+    *p++ = (uint8_t)v | 0x80;
+    v >>= 7;
+  }
+  *p++ = (uint8_t)v;
+  used_ = p - buffer_.get();
+}
+
+void BinaryWriter::writeBytes(const void* data, size_t n) {
+  if (n <= size_ - used_) {
+    ::memcpy(buffer_.get() + used_, data, n);
+    used_ += n;
+  } else {
+    flush();
+    if (n < size_) {
+      ::memcpy(buffer_.get(), data, n);
+      used_ = n;
+    } else {
+      writeAll_((const uint8_t*)data, n);
+    }
+  }
+}
+
+void BinaryWriter::flush() {
+  if (used_) {
+    // Empty the buffer first, so an error doesn't write the data twice
+    const size_t n = used_;
+    used_ = 0;
+    writeAll_(buffer_.get(), n);
+  }
+}
+
+void BinaryWriter::makeRoom_(size_t n) {
+  flush();
+  if (n > size_) {
+    buffer_.reset(new uint8_t[n]);
+    size_ = n;
+  }
+}
+
+void BinaryWriter::writeAll_(const uint8_t* data, size_t n) {
+  while (n) {
+    const size_t nWritten = file_.write(data, n);
+    data += nWritten;
+    n -= nWritten;
+  }
+}
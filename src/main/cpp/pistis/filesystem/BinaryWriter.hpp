@@ -0,0 +1,103 @@
+#ifndef __PISTIS__FILESYSTEM__BINARYWRITER_HPP__
+#define __PISTIS__FILESYSTEM__BINARYWRITER_HPP__
+
+/** @file BinaryWriter.hpp
+ *
+ *  Declaration of pistis::filesystem::BinaryWriter, which encodes binary
+ *  values into a buffer and writes them to a File in large blocks.
+ */
+
+#include <pistis/filesystem/ByteOrder.hpp>
+#include <pistis/filesystem/File.hpp>
+
+#include <memory>
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace pistis {
+  namespace filesystem {
+
+    /** @brief Writes binary values to a File through a buffer.
+     *
+     *  The counterpart of File's binary readers.  Values are stored into
+     *  the buffer with one bounds check each, and the buffer is written
+     *  with File::write() when it fills or flush() is called, so a record
+     *  of many small fields costs no system calls of its own.  A fixed-size
+     *  record can reserve() its space once and store its fields with the
+     *  functions in ByteOrder.hpp.
+     *
+     *  The File must outlive the writer and should not be written to
+     *  directly until flush() has been called.  The destructor flushes
+     *  but ignores errors, so call flush() explicitly to see them.
+     */
+    class BinaryWriter {
+    public:
+      static const size_t DEFAULT_BUFFER_SIZE = 64 * 1024;
+
+    public:
+      BinaryWriter(File& file, size_t bufferSize = DEFAULT_BUFFER_SIZE);
+      BinaryWriter(const BinaryWriter&) = delete;
+      ~BinaryWriter();
+
+      File& file() const { return file_; }
+
+      /** @brief Number of bytes waiting to be written */
+      size_t buffered() const { return used_; }
+
+      /** @brief Return space for n bytes in the buffer.
+       *
+       *  The bytes are written at the next flush, so fill them in before
+       *  then.  The buffer grows if n is larger than it.
+       */
+      uint8_t* reserve(size_t n) {
+	if (size_ - used_ < n) {
+	  makeRoom_(n);
+	}
+	uint8_t* p = buffer_.get() + used_;
+	used_ += n;
+	return p;
+      }
+
+      void writeU8(uint8_t v) { *reserve(1) = v; }
+      void writeU16LE(uint16_t v) { byteorder::storeLE(reserve(2), v); }
+      void writeU16BE(uint16_t v) { byteorder::storeBE(reserve(2), v); }
+      void writeU32LE(uint32_t v) { byteorder::storeLE(reserve(4), v); }
+      void writeU32BE(uint32_t v) { byteorder::storeBE(reserve(4), v); }
+      void writeU64LE(uint64_t v) { byteorder::storeLE(reserve(8), v); }
+      void writeU64BE(uint64_t v) { byteorder::storeBE(reserve(8), v); }
+      void writeF32LE(float v) { byteorder::storeLE(reserve(4), v); }
+      void writeF32BE(float v) { byteorder::storeBE(reserve(4), v); }
+      void writeF64LE(double v) { byteorder::storeLE(reserve(8), v); }
+      void writeF64BE(double v) { byteorder::storeBE(reserve(8), v); }
+
+      /** @brief Write v as an unsigned LEB128 varint */
+      void writeVarint(uint64_t v);
+
+      /** @brief Write v as a zigzag-encoded varint */
+      void writeSignedVarint(int64_t v) {
+	writeVarint(byteorder::zigzagEncode(v));
+      }
+
+      /** @brief Write n bytes.  Blocks larger than the buffer bypass it. */
+      void writeBytes(const void* data, size_t n);
+
+      /** @brief Write everything in the buffer to the file */
+      void flush();
+
+      BinaryWriter& operator=(const BinaryWriter&) = delete;
+
+    private:
+      File& file_;
+      std::unique_ptr<uint8_t[]> buffer_;
+      size_t size_;
+      size_t used_;
+
+      void makeRoom_(size_t n);
+      void writeAll_(const uint8_t* data, size_t n);
+    };
+
+  }
+}
+
+#endif
@@ -0,0 +1,12 @@
+#include "BufferPolicy.hpp"
+
+using namespace pistis::filesystem;
+
+namespace {
+  static const std::string NAMES[]{ "FIXED", "ADAPTIVE" };
+}
+
+const BufferPolicy BufferPolicy::FIXED(0);
+const BufferPolicy BufferPolicy::ADAPTIVE(1);
+
+const std::string& BufferPolicy::name() const { return NAMES[ordinal_]; }
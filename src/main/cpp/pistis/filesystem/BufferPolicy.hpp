@@ -0,0 +1,52 @@
+#ifndef __PISTIS__FILESYSTEM__BUFFERPOLICY_HPP__
+#define __PISTIS__FILESYSTEM__BUFFERPOLICY_HPP__
+
+#include <ostream>
+#include <string>
+
+namespace pistis {
+  namespace filesystem {
+
+    /** @brief How a File sizes its line buffer */
+    class BufferPolicy {
+    public:
+      /** @brief Start at the initial size and double whenever a line
+       *         doesn't fit.  The buffer never shrinks.
+       */
+      static const BufferPolicy FIXED;
+
+      /** @brief Size the buffer from the lengths of recent lines.
+       *
+       *  Grows straight to the size recent long lines needed, and faster
+       *  than doubling when one line needs several growths.  Shrinks back
+       *  once a few hundred lines have passed without needing the extra
+       *  space, so one outlying line doesn't pin a large buffer for the
+       *  rest of the file.
+       */
+      static const BufferPolicy ADAPTIVE;
+
+    public:
+      BufferPolicy() : ordinal_(0) { }
+
+      const std::string& name() const;
+
+      bool operator==(BufferPolicy other) const {
+	return ordinal_ == other.ordinal_;
+      }
+      bool operator!=(BufferPolicy other) const {
+	return ordinal_ != other.ordinal_;
+      }
+
+    private:
+      int ordinal_;
+
+      BufferPolicy(int o): ordinal_(o) { }
+    };
+
+    inline std::ostream& operator<<(std::ostream& out, BufferPolicy p) {
+      return out << p.name();
+    }
+
+  }
+}
+#endif
@@ -0,0 +1,100 @@
+#ifndef __PISTIS__FILESYSTEM__BYTEORDER_HPP__
+#define __PISTIS__FILESYSTEM__BYTEORDER_HPP__
+
+/** @file ByteOrder.hpp
+ *
+ *  Functions that load and store integers and floating-point numbers in
+ *  little- or big-endian byte order, regardless of the host's.
+ */
+
+#include <type_traits>
+
+#include <stdint.h>
+#include <string.h>
+
+namespace pistis {
+  namespace filesystem {
+    namespace byteorder {
+
+      inline uint8_t swap(uint8_t v) { return v; }
+      inline uint16_t swap(uint16_t v) { return __builtin_bswap16(v); }
+      inline uint32_t swap(uint32_t v) { return __builtin_bswap32(v); }
+      inline uint64_t swap(uint64_t v) { return __builtin_bswap64(v); }
+
+      /** @brief Unsigned integer the same size as T */
+      template <typename T>
+      using Bits = typename std::conditional<
+	  sizeof(T) == 1, uint8_t, typename std::conditional<
+	      sizeof(T) == 2, uint16_t, typename std::conditional<
+		  sizeof(T) == 4, uint32_t, uint64_t
+	      >::type
+	  >::type
+      >::type;
+
+      /** @brief Load a T stored at p, least significant byte first */
+      template <typename T>
+      inline T loadLE(const uint8_t* p) {
+	Bits<T> bits;
+	::memcpy(&bits, p, sizeof(bits));
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+	bits = swap(bits);
+#endif
+	T value;
+	::memcpy(&value, &bits, sizeof(value));
+	return value;
+      }
+
+      /** @brief Load a T stored at p, most significant byte first */
+      template <typename T>
+      inline T loadBE(const uint8_t* p) {
+	Bits<T> bits;
+	::memcpy(&bits, p, sizeof(bits));
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+	bits = swap(bits);
+#endif
+	T value;
+	::memcpy(&value, &bits, sizeof(value));
+	return value;
+      }
+
+      /** @brief Store value at p, least significant byte first */
+      template <typename T>
+      inline void storeLE(uint8_t* p, T value) {
+	Bits<T> bits;
+	::memcpy(&bits, &value, sizeof(bits));
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+	bits = swap(bits);
+#endif
+	::memcpy(p, &bits, sizeof(bits));
+      }
+
+      /** @brief Store value at p, most significant byte first */
+      template <typename T>
+      inline void storeBE(uint8_t* p, T value) {
+	Bits<T> bits;
+	::memcpy(&bits, &value, sizeof(bits));
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+	bits = swap(bits);
+#endif
+	::memcpy(p, &bits, sizeof(bits));
+      }
+
+      /** @brief Maximum length of a varint holding a 64-bit value */
+      static const size_t MAX_VARINT_SIZE = 10;
+
+      /** @brief Map signed values to unsigned ones so small magnitudes
+       *         of either sign have short varints
+       */
+      inline uint64_t zigzagEncode(int64_t v) {
+	return ((uint64_t)v << 1) ^ (uint64_t)(v >> 63);
+      }
+
+      inline int64_t zigzagDecode(uint64_t v) {
+	return (int64_t)(v >> 1) ^ -(int64_t)(v & 1);
+      }
+
+    }
+  }
+}
+
+#endif
@@ -0,0 +1,162 @@
+#include "ByteScanning.hpp"
+
+#include <algorithm>
+
+#include <string.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+using namespace pistis::filesystem;
+
+namespace {
+#ifdef __SSE2__
+  // Bit i of the result is the xor of bits 0..i of mask, so a run of ones
+  // starts at each odd-numbered quote and ends just before the next one
+  inline uint32_t prefixXor16(uint32_t mask) {
+    mask ^= mask << 1;
+    mask ^= mask << 2;
+    mask ^= mask << 4;
+    mask ^= mask << 8;
+    return mask & 0xFFFF;
+  }
+
+  inline uint32_t matches(__m128i block, __m128i pattern) {
+    return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(block, pattern));
+  }
+#endif
+}
+
+size_t scanning::findSeparators(const uint8_t* data, size_t n,
+				uint8_t delimiter, int quote, bool& inQuotes,
+				uint32_t* positions) {
+  size_t count = 0;
+  size_t i = 0;
+
+#ifdef __SSE2__
+  const __m128i delimiters = _mm_set1_epi8((char)delimiter);
+  const __m128i newlines = _mm_set1_epi8('\n');
+  const __m128i quotes = _mm_set1_epi8((char)quote);
+
+  for (; i + 16 <= n; i += 16) {
+    const __m128i block = _mm_loadu_si128((const __m128i*)(data + i));
+    uint32_t found = matches(block, delimiters) | matches(block, newlines);
+
+    if (quote >= 0) {
+      const uint32_t quoteMask = matches(block, quotes);
+      if (quoteMask || inQuotes) {
+	const uint32_t quoted = prefixXor16(quoteMask) ^
+				(inQuotes ? 0xFFFF : 0);
+	found &= ~quoted;
+	inQuotes = (quoted >> 15) & 1;
+      }
+    }
+
+    while (found) {
+      positions[count++] = (uint32_t)(i + __builtin_ctz(found));
+      found &= found - 1;
+    }
+  }
+#endif
+
+  for (; i < n; ++i) {
+    const uint8_t c = data[i];
+    if ((int)c == quote) {
+      inQuotes = !inQuotes;
+    } else if (!inQuotes && ((c == delimiter) || (c == '\n'))) {
+      positions[count++] = (uint32_t)i;
+    }
+  }
+  return count;
+}
+
+size_t scanning::firstDifference(const uint8_t* a, const uint8_t* b,
+				 size_t n) {
+  size_t i = 0;
+
+#ifdef __SSE2__
+  for (; i + 16 <= n; i += 16) {
+    const __m128i x = _mm_loadu_si128((const __m128i*)(a + i));
+    const __m128i y = _mm_loadu_si128((const __m128i*)(b + i));
+    const uint32_t different = matches(x, y) ^ 0xFFFF;
+    if (different) {
+      return i + __builtin_ctz(different);
+    }
+  }
+#endif
+
+  for (; (i < n) && (a[i] == b[i]); ++i) {
+  }
+  return i;
+}
+
+size_t scanning::find(const uint8_t* data, size_t n, const uint8_t* pattern,
+		      size_t m) {
+  if (m > n) {
+    return n;
+  } else if (m == 1) {
+    const void* p = ::memchr(data, pattern[0], n);
+    return p ? (const uint8_t*)p - data : n;
+  }
+
+  // Matches can start anywhere in [0, last]
+  const size_t last = n - m;
+  size_t i = 0;
+
+#ifdef __SSE2__
+  const __m128i firstBytes = _mm_set1_epi8((char)pattern[0]);
+  const __m128i lastBytes = _mm_set1_epi8((char)pattern[m - 1]);
+
+  for (; i + 15 <= last; i += 16) {
+    const __m128i starts = _mm_loadu_si128((const __m128i*)(data + i));
+    const __m128i ends = _mm_loadu_si128((const __m128i*)(data + i + m - 1));
+    uint32_t candidates = matches(starts, firstBytes) &
+			  matches(ends, lastBytes);
+    while (candidates) {
+      const size_t j = i + __builtin_ctz(candidates);
+      if (!::memcmp(data + j + 1, pattern + 1, m - 2)) {
+	return j;
+      }
+      candidates &= candidates - 1;
+    }
+  }
+#endif
+
+  for (; i <= last; ++i) {
+    if ((data[i] == pattern[0]) && (data[i + m - 1] == pattern[m - 1]) &&
+	!::memcmp(data + i + 1, pattern + 1, m - 2)) {
+      return i;
+    }
+  }
+  return n;
+}
+
+size_t scanning::count(const uint8_t* data, size_t n, uint8_t c) {
+  size_t total = 0;
+  size_t i = 0;
+
+#ifdef __SSE2__
+  const __m128i target = _mm_set1_epi8((char)c);
+  const __m128i zero = _mm_setzero_si128();
+
+  // Each byte lane counts up to 255 matches, one per block, and then
+  // _mm_sad_epu8() adds the lanes up
+  while (i + 16 <= n) {
+    const size_t nBlocks = std::min<size_t>((n - i) / 16, 255);
+    const size_t end = i + nBlocks * 16;
+    __m128i counts = zero;
+    for (; i < end; i += 16) {
+      const __m128i block = _mm_loadu_si128((const __m128i*)(data + i));
+      counts = _mm_sub_epi8(counts, _mm_cmpeq_epi8(block, target));
+    }
+    const __m128i sums = _mm_sad_epu8(counts, zero);
+    total += _mm_cvtsi128_si32(sums) + _mm_extract_epi16(sums, 4);
+  }
+#endif
+
+  for (; i < n; ++i) {
+    total += (data[i] == c);
+  }
+  return total;
+}
@@ -0,0 +1,55 @@
+#ifndef __PISTIS__FILESYSTEM__BYTESCANNING_HPP__
+#define __PISTIS__FILESYSTEM__BYTESCANNING_HPP__
+
+/** @file ByteScanning.hpp
+ *
+ *  Functions that search blocks of bytes sixteen at a time with SSE2,
+ *  falling back to a byte-at-a-time loop on other processors.  File uses
+ *  them to find the structure of the text in its read buffer.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace pistis {
+  namespace filesystem {
+    namespace scanning {
+
+      /** @brief Find the delimiters and newlines in data[0..n) that are
+       *         not inside quotes.
+       *
+       *  Writes the offset of each one to positions, which must have room
+       *  for n entries, and returns how many were found.  If quote is
+       *  negative, quotes are ignored.  Otherwise each quote character
+       *  starts or ends a quoted run, so a doubled quote inside a quoted
+       *  field ends the run and starts it again, leaving the field
+       *  quoted.  inQuotes says whether data starts inside a quoted run,
+       *  and is set to whether it ends in one.  n must be less than 4 GB.
+       */
+      size_t findSeparators(const uint8_t* data, size_t n,
+			    uint8_t delimiter, int quote, bool& inQuotes,
+			    uint32_t* positions);
+
+      /** @brief Offset of the first byte where a[0..n) and b[0..n)
+       *         differ, or n if they are the same.
+       */
+      size_t firstDifference(const uint8_t* a, const uint8_t* b, size_t n);
+
+      /** @brief Number of times c occurs in data[0..n) */
+      size_t count(const uint8_t* data, size_t n, uint8_t c);
+
+      /** @brief Offset of the first occurrence of pattern[0..m) in
+       *         data[0..n), or n if there is none.
+       *
+       *  Candidates are the positions where both the first and the last
+       *  byte of the pattern match, which are found sixteen at a time,
+       *  and only those are compared in full.  m must be at least 1.
+       */
+      size_t find(const uint8_t* data, size_t n, const uint8_t* pattern,
+		  size_t m);
+
+    }
+  }
+}
+
+#endif
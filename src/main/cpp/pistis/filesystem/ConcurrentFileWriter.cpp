@@ -0,0 +1,259 @@
+#include "ConcurrentFileWriter.hpp"
+
+#include <pistis/exceptions/IOError.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <new>
+
+#include <string.h>
+#include <unistd.h>
+
+using namespace pistis::exceptions;
+using namespace pistis::filesystem;
+
+namespace {
+  // The writer thread rechecks the queue this often while it sleeps, in
+  // case a wakeup is somehow missed
+  static const std::chrono::milliseconds IDLE_WAIT(100);
+}
+
+const size_t ConcurrentFileWriter::DEFAULT_BATCH_SIZE;
+
+ConcurrentFileWriter::ConcurrentFileWriter(File&& file, size_t batchSize):
+    file_(std::move(file)), batchSize_(std::max<size_t>(batchSize, 1)),
+    head_(&stub_), tail_(&stub_), stub_(), writerWaiting_(false),
+    stopping_(false), failed_(false), recordsWritten_(0), error_(),
+    mutex_(), wakeWriter_(), writer_() {
+  stub_.next.store(nullptr, std::memory_order_relaxed);
+  stub_.size = 0;
+  stub_.written = nullptr;
+  stub_.sync = false;
+  writer_ = std::thread([this]() { run_(); });
+}
+
+ConcurrentFileWriter::~ConcurrentFileWriter() {
+  try {
+    close();
+  } catch(...) {
+    // Call close() explicitly to see errors
+  }
+}
+
+void ConcurrentFileWriter::write(const void* data, size_t n) {
+  throwIfFailed_();
+  if (stopping_.load(std::memory_order_relaxed)) {
+    throw IOError("Error writing to " + name() + ": Writer is closed",
+		  PISTIS_EX_HERE);
+  }
+
+  Record* record = new (::operator new(sizeof(Record) + n)) Record();
+  record->size = n;
+  record->written = nullptr;
+  record->sync = false;
+  ::memcpy(record->data(), data, n);
+  push_(record);
+
+  // Pairs with the store in run_(): either this load sees the writer
+  // waiting, or the writer sees this record before it sleeps
+  if (writerWaiting_.load(std::memory_order_seq_cst)) {
+    wake_();
+  }
+}
+
+void ConcurrentFileWriter::close() {
+  if (writer_.joinable()) {
+    stopping_.store(true);
+    wake_();
+    writer_.join();
+    file_.close();
+  }
+  throwIfFailed_();
+}
+
+ConcurrentFileWriter ConcurrentFileWriter::open(const std::string& name,
+						size_t batchSize,
+						FilePermissions permissions) {
+  return ConcurrentFileWriter(
+      File::open(name, FileCreationMode::CREATE_OR_OPEN,
+		 FileAccessMode::WRITE_ONLY, FileOpenOptions::APPEND,
+		 permissions),
+      batchSize
+  );
+}
+
+void ConcurrentFileWriter::push_(Record* record) {
+  record->next.store(nullptr, std::memory_order_relaxed);
+  Record* previous = head_.exchange(record, std::memory_order_seq_cst);
+  previous->next.store(record, std::memory_order_release);
+}
+
+ConcurrentFileWriter::Record* ConcurrentFileWriter::pop_() {
+  Record* tail = tail_;
+  Record* next = tail->next.load(std::memory_order_acquire);
+
+  if (tail == &stub_) {
+    if (!next) {
+      return nullptr;
+    }
+    tail_ = next;
+    tail = next;
+    next = next->next.load(std::memory_order_acquire);
+  }
+  if (next) {
+    tail_ = next;
+    return tail;
+  }
+
+  if (tail != head_.load(std::memory_order_acquire)) {
+    // A producer has taken head_ but not yet linked its record
+    return nullptr;
+  }
+
+  // tail is the last record.  Put the stub behind it so it can be
+  // removed without leaving the queue without a node.
+  push_(&stub_);
+  next = tail->next.load(std::memory_order_acquire);
+  if (next) {
+    tail_ = next;
+    return tail;
+  }
+  return nullptr;
+}
+
+bool ConcurrentFileWriter::empty_() const {
+  return (tail_ == &stub_) &&
+	 (head_.load(std::memory_order_seq_cst) == &stub_);
+}
+
+void ConcurrentFileWriter::wake_() {
+  {
+    // Taking the mutex means the writer is either not yet checking the
+    // queue or already waiting, so the notification can't be lost
+    std::lock_guard<std::mutex> lock(mutex_);
+  }
+  wakeWriter_.notify_one();
+}
+
+void ConcurrentFileWriter::waitForWriter_(bool sync) {
+  throwIfFailed_();
+  if (!writer_.joinable()) {
+    return;
+  }
+
+  std::promise<void> written;
+  std::future<void> done = written.get_future();
+  Record* request = new (::operator new(sizeof(Record))) Record();
+  request->size = 0;
+  request->written = &written;
+  request->sync = sync;
+  push_(request);
+  wake_();
+  done.get();
+}
+
+void ConcurrentFileWriter::throwIfFailed_() {
+  if (failed_.load(std::memory_order_acquire)) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::rethrow_exception(error_);
+  }
+}
+
+void ConcurrentFileWriter::run_() {
+  std::unique_ptr<uint8_t[]> batch(new uint8_t[batchSize_]);
+  size_t nBatched = 0;
+  uint64_t nRecordsBatched = 0;
+
+  auto writeBatch = [&]() {
+    if (nBatched && !failed_.load(std::memory_order_relaxed)) {
+      try {
+	writeAll_(batch.get(), nBatched);
+	recordsWritten_.fetch_add(nRecordsBatched, std::memory_order_relaxed);
+      } catch(...) {
+	fail_(std::current_exception());
+      }
+    }
+    nBatched = 0;
+    nRecordsBatched = 0;
+  };
+
+  while (true) {
+    Record* record = pop_();
+    if (record && record->written) {
+      writeBatch();
+      finish_(record);
+    } else if (record) {
+      if (!failed_.load(std::memory_order_relaxed)) {
+	if (nBatched + record->size > batchSize_) {
+	  writeBatch();
+	}
+	if (record->size > batchSize_) {
+	  // Too big to batch, so write it from the record
+	  try {
+	    writeAll_(record->data(), record->size);
+	    recordsWritten_.fetch_add(1, std::memory_order_relaxed);
+	  } catch(...) {
+	    fail_(std::current_exception());
+	  }
+	} else {
+	  ::memcpy(batch.get() + nBatched, record->data(), record->size);
+	  nBatched += record->size;
+	  ++nRecordsBatched;
+	}
+      }
+      ::operator delete(record);
+    } else if (nBatched) {
+      // The queue has run dry, so write what has accumulated
+      writeBatch();
+    } else if (!empty_()) {
+      // A producer is in the middle of push_()
+      std::this_thread::yield();
+    } else if (stopping_.load()) {
+      return;
+    } else {
+      std::unique_lock<std::mutex> lock(mutex_);
+      writerWaiting_.store(true, std::memory_order_seq_cst);
+      if (empty_() && !stopping_.load()) {
+	wakeWriter_.wait_for(lock, IDLE_WAIT);
+      }
+      writerWaiting_.store(false, std::memory_order_relaxed);
+    }
+  }
+}
+
+void ConcurrentFileWriter::writeAll_(const uint8_t* data, size_t n) {
+  while (n) {
+    const size_t nWritten = file_.write(data, n);
+    data += nWritten;
+    n -= nWritten;
+  }
+}
+
+void ConcurrentFileWriter::fail_(std::exception_ptr error) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!error_) {
+    error_ = error;
+  }
+  failed_.store(true, std::memory_order_release);
+}
+
+void ConcurrentFileWriter::finish_(Record* request) {
+  std::promise<void>* written = request->written;
+  if (request->sync && !failed_.load(std::memory_order_relaxed) &&
+      (::fdatasync(file_.fd()) < 0)) {
+    try {
+      throw IOError::fromSystemError("Error syncing " + name() + ": #ERR#",
+				     PISTIS_EX_HERE);
+    } catch(...) {
+      fail_(std::current_exception());
+    }
+  }
+  ::operator delete(request);
+
+  if (failed_.load(std::memory_order_acquire)) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    written->set_exception(error_);
+  } else {
+    written->set_value();
+  }
+}
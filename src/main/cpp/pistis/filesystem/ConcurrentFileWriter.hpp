@@ -0,0 +1,157 @@
+#ifndef __PISTIS__FILESYSTEM__CONCURRENTFILEWRITER_HPP__
+#define __PISTIS__FILESYSTEM__CONCURRENTFILEWRITER_HPP__
+
+/** @file ConcurrentFileWriter.hpp
+ *
+ *  Declaration of pistis::filesystem::ConcurrentFileWriter, which lets
+ *  many threads append records to one file without a lock.
+ */
+
+#include <pistis/filesystem/File.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace pistis {
+  namespace filesystem {
+
+    /** @brief Appends records from many threads to one file.
+     *
+     *  write() copies the record onto a lock-free multiple-producer,
+     *  single-consumer queue and returns without making a system call.  A
+     *  dedicated thread drains the queue, copying records into a batch
+     *  buffer and writing the buffer with one File::write() call when it
+     *  fills or the queue runs dry.  Producers never wait for each other
+     *  or for the disk; they only wake the writer thread, with a mutex
+     *  and condition variable, when it has gone to sleep on an empty
+     *  queue.
+     *
+     *  Each record is written whole and contiguously, and records from the
+     *  same thread appear in the order that thread wrote them.  write()
+     *  returns before the record reaches the file; call flush() to wait
+     *  for it, or sync() to wait for it to reach the device.  Neither is
+     *  needed for the data to be written eventually, since the writer
+     *  thread drains the queue continuously and close() drains it
+     *  completely.
+     *
+     *  If a write fails, the writer thread stops writing, and the error
+     *  is rethrown by the next call to write(), flush(), sync() or
+     *  close().  The destructor calls close() but ignores errors.
+     */
+    class ConcurrentFileWriter {
+    public:
+      static const size_t DEFAULT_BATCH_SIZE = 1024 * 1024;
+
+    public:
+      /** @brief Append records to file.
+       *
+       *  Records are copied into a buffer of batchSize bytes, so most
+       *  write system calls are about that large.  Records larger than
+       *  the buffer are written on their own.
+       */
+      ConcurrentFileWriter(File&& file,
+			   size_t batchSize = DEFAULT_BATCH_SIZE);
+      ConcurrentFileWriter(const ConcurrentFileWriter&) = delete;
+      ~ConcurrentFileWriter();
+
+      const std::string& name() const { return file_.name(); }
+
+      /** @brief Number of records written to the file so far */
+      uint64_t recordsWritten() const {
+	return recordsWritten_.load(std::memory_order_relaxed);
+      }
+
+      /** @brief Queue n bytes to be appended to the file.  Thread-safe. */
+      void write(const void* data, size_t n);
+      void write(const std::string& record) {
+	write(record.data(), record.size());
+      }
+
+      /** @brief Wait until every record queued by this thread before the
+       *         call has been written to the file.
+       */
+      void flush() { waitForWriter_(false); }
+
+      /** @brief Like flush(), but also wait for the data to reach the
+       *         device with fdatasync().
+       */
+      void sync() { waitForWriter_(true); }
+
+      /** @brief Write all queued records, stop the writer thread and
+       *         close the file.
+       *
+       *  No thread may call write() during or after close().
+       */
+      void close();
+
+      ConcurrentFileWriter& operator=(const ConcurrentFileWriter&) = delete;
+
+      /** @brief Open the named file for appending, creating it if it
+       *         doesn't exist
+       */
+      static ConcurrentFileWriter open(
+	  const std::string& name, size_t batchSize = DEFAULT_BATCH_SIZE,
+	  FilePermissions permissions = FilePermissions::ALL_RW
+      );
+
+    private:
+      // A queued record, with its bytes stored after the header.  Flush
+      // requests travel through the queue as records with a promise to
+      // fulfill, so they are handled after everything queued before them.
+      struct Record {
+	std::atomic<Record*> next;
+	size_t size;
+	std::promise<void>* written;
+	bool sync;
+
+	uint8_t* data() { return (uint8_t*)(this + 1); }
+      };
+
+      File file_;
+      size_t batchSize_;
+
+      // Intrusive MPSC queue (after Dmitry Vyukov's design).  Producers
+      // exchange head_ and then link the old head to their record;
+      // the writer thread follows next pointers from tail_.  stub_ keeps
+      // the queue from ever being truly empty, so producers never have to
+      // update tail_.
+      std::atomic<Record*> head_;
+      Record* tail_;
+      Record stub_;
+
+      std::atomic<bool> writerWaiting_;
+      std::atomic<bool> stopping_;
+      std::atomic<bool> failed_;
+      std::atomic<uint64_t> recordsWritten_;
+      std::exception_ptr error_;
+      std::mutex mutex_;
+      std::condition_variable wakeWriter_;
+      std::thread writer_;
+
+      void push_(Record* record);
+      Record* pop_();
+      void wake_();
+      void waitForWriter_(bool sync);
+      void throwIfFailed_();
+
+      bool empty_() const;
+
+      void run_();
+      void writeAll_(const uint8_t* data, size_t n);
+      void fail_(std::exception_ptr error);
+      void finish_(Record* request);
+    };
+
+  }
+}
+
+#endif
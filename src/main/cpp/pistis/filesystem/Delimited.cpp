@@ -0,0 +1,21 @@
+#include "Delimited.hpp"
+
+#include <algorithm>
+
+using namespace pistis::filesystem;
+
+const DelimitedFormat DelimitedFormat::TSV('\t');
+const DelimitedFormat DelimitedFormat::CSV(',', true, '"');
+
+DelimitedScanner::DelimitedScanner(const DelimitedFormat& format,
+				   const std::vector<size_t>& columns):
+    format_(format), slots_(), numSlots_(columns.size()), positions_(),
+    count_(0), cursor_(0), base_(nullptr), scanned_(0), rowStart_(0),
+    rowCount_(0), started_(false), atEnd_(false) {
+  if (!columns.empty()) {
+    slots_.assign(*std::max_element(columns.begin(), columns.end()) + 1, -1);
+    for (size_t i = 0; i < columns.size(); ++i) {
+      slots_[columns[i]] = (int)i;
+    }
+  }
+}
@@ -0,0 +1,128 @@
+#ifndef __PISTIS__FILESYSTEM__DELIMITED_HPP__
+#define __PISTIS__FILESYSTEM__DELIMITED_HPP__
+
+/** @file Delimited.hpp
+ *
+ *  Declarations of DelimitedFormat and DelimitedRow, which File::eachRow()
+ *  uses to split delimited text such as CSV and TSV files into fields.
+ */
+
+#include <string_view>
+#include <vector>
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace pistis {
+  namespace filesystem {
+
+    class File;
+
+    /** @brief How fields are separated and quoted in a delimited file */
+    class DelimitedFormat {
+    public:
+      /** @brief Tab-separated fields, without quoting */
+      static const DelimitedFormat TSV;
+
+      /** @brief Comma-separated fields, which may be quoted with '"' as
+       *         in RFC 4180
+       */
+      static const DelimitedFormat CSV;
+
+    public:
+      /** @brief Fields separated by delimiter.
+       *
+       *  If quoting is true, a field that starts with quote may contain
+       *  delimiters and newlines, and a doubled quote inside it stands
+       *  for one quote.
+       */
+      DelimitedFormat(char delimiter, bool quoting = false, char quote = '"'):
+	  delimiter_(delimiter), quote_(quote), quoting_(quoting) {
+      }
+
+      char delimiter() const { return delimiter_; }
+      char quote() const { return quote_; }
+      bool quoting() const { return quoting_; }
+
+    private:
+      char delimiter_;
+      char quote_;
+      bool quoting_;
+    };
+
+    /** @brief One row of a delimited file, passed to the function given to
+     *         File::eachRow().
+     *
+     *  Fields are views into File's read buffer with quotes removed, and
+     *  are valid only until that function returns.  When eachRow() is
+     *  given a list of distinct columns, field i is column columns[i],
+     *  and a row that doesn't have that column gives an empty field.  Trailing
+     *  carriage returns are removed, so files with CRLF line endings
+     *  read the same as ones with LF endings.
+     */
+    class DelimitedRow {
+    public:
+      DelimitedRow(): fields_(), fieldCount_(0), number_(0) { }
+
+      /** @brief Number of fields returned, which is the number of columns
+       *         requested or, if no columns were given, fieldCount()
+       */
+      size_t size() const { return fields_.size(); }
+
+      /** @brief Number of fields in the row in the file */
+      size_t fieldCount() const { return fieldCount_; }
+
+      /** @brief The row's position in the sequence passed to eachRow(),
+       *         starting from zero
+       */
+      uint64_t number() const { return number_; }
+
+      std::string_view operator[](size_t i) const { return fields_[i]; }
+
+      std::vector<std::string_view>::const_iterator begin() const {
+	return fields_.begin();
+      }
+      std::vector<std::string_view>::const_iterator end() const {
+	return fields_.end();
+      }
+
+    private:
+      std::vector<std::string_view> fields_;
+      size_t fieldCount_;
+      uint64_t number_;
+
+      friend class File;
+    };
+
+    /** @brief Where File::eachRow() is in the file.  For internal use. */
+    class DelimitedScanner {
+    public:
+      DelimitedScanner(const DelimitedFormat& format,
+		       const std::vector<size_t>& columns);
+
+    private:
+      DelimitedFormat format_;
+
+      // slots_[c] is the position in the row of column c, or -1 if it
+      // wasn't requested.  Empty when every column is wanted.
+      std::vector<int> slots_;
+      size_t numSlots_;
+
+      // Separators found in the buffer, as offsets from base_
+      std::vector<uint32_t> positions_;
+      size_t count_;
+      size_t cursor_;
+      uint8_t* base_;
+      size_t scanned_;
+      size_t rowStart_;
+      uint64_t rowCount_;
+      bool started_;
+      bool atEnd_;
+
+      friend class File;
+    };
+
+  }
+}
+
+#endif
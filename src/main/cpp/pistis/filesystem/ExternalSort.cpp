@@ -0,0 +1,225 @@
+#include "ExternalSort.hpp"
+#include "MergeReader.hpp"
+
+#include <pistis/exceptions/IOError.hpp>
+
+#include <algorithm>
+#include <thread>
+
+#include <stdlib.h>
+#include <unistd.h>
+
+using namespace pistis::exceptions;
+using namespace pistis::filesystem;
+
+namespace {
+  static const size_t OUTPUT_BUFFER_SIZE = 1024 * 1024;
+
+  // Larger read-ahead buffers don't make the merge any faster
+  static const size_t MAX_READ_AHEAD = 4 * 1024 * 1024;
+
+  void writeAll(File& file, const std::string& data) {
+    const char* p = data.data();
+    size_t n = data.size();
+    while (n) {
+      size_t nWritten = file.write(p, n);
+      p += nWritten;
+      n -= nWritten;
+    }
+  }
+
+  // Collects output lines and writes them in large blocks
+  class OutputBuffer {
+  public:
+    OutputBuffer(File& file): file_(file), data_() {
+      data_.reserve(OUTPUT_BUFFER_SIZE);
+    }
+
+    void append(const std::string& line) {
+      data_.append(line);
+      if (data_.size() >= OUTPUT_BUFFER_SIZE) {
+	flush();
+      }
+    }
+
+    void flush() {
+      writeAll(file_, data_);
+      data_.clear();
+    }
+
+  private:
+    File& file_;
+    std::string data_;
+  };
+}
+
+ExternalSorter::ExternalSorter(const ExternalSortOptions& options,
+			       Comparator compare):
+    options_(options), compare_(compare), batchBudget_(0), batch_(),
+    batchBytes_(0), pending_(), runs_() {
+  if (!options_.threads) {
+    options_.threads = std::max(std::thread::hardware_concurrency(), 1u);
+  }
+  if (options_.maxMergeWidth < 2) {
+    options_.maxMergeWidth = 2;
+  }
+  // One batch is being filled while each thread sorts and writes another
+  batchBudget_ = std::max<size_t>(
+      options_.memoryBudget / (options_.threads + 1), 1
+  );
+}
+
+ExternalSorter::~ExternalSorter() {
+  removeRuns_();
+}
+
+void ExternalSorter::add(const std::string& line) {
+  batch_.push_back(line);
+  if (line.empty() || (line.back() != '\n')) {
+    batch_.back().push_back('\n');
+  }
+  batchBytes_ += line.size() + sizeof(std::string);
+  if (batchBytes_ >= batchBudget_) {
+    spill_();
+  }
+}
+
+void ExternalSorter::finish(File& output) {
+  if (runs_.empty() && pending_.empty()) {
+    // Everything fit in memory, so skip the temporary files
+    OutputBuffer out(output);
+    std::sort(batch_.begin(), batch_.end(), compare_);
+    for (const std::string& line : batch_) {
+      out.append(line);
+    }
+    out.flush();
+    batch_.clear();
+    batchBytes_ = 0;
+    return;
+  }
+
+  spill_();
+  collectRuns_(0);
+
+  // Merge in several passes if there are too many runs to open at once
+  while (runs_.size() > options_.maxMergeWidth) {
+    std::vector<std::string> group(runs_.begin(),
+				   runs_.begin() + options_.maxMergeWidth);
+    File merged(-1);
+
+    runs_.push_back(createRunFile_(merged));
+    merge_(group, merged, readAheadFor_(group.size()));
+    runs_.erase(runs_.begin(), runs_.begin() + options_.maxMergeWidth);
+    for (const std::string& name : group) {
+      ::unlink(name.c_str());
+    }
+  }
+
+  merge_(runs_, output, readAheadFor_(runs_.size()));
+  removeRuns_();
+}
+
+void ExternalSorter::sortFile(const std::string& input,
+			      const std::string& output,
+			      const ExternalSortOptions& options,
+			      Comparator compare) {
+  ExternalSorter sorter(options, compare);
+  File in = File::open(input, FileCreationMode::OPEN_ONLY,
+		       FileAccessMode::READ_ONLY);
+  sorter.addFile(in);
+  in.close();
+
+  File out = File::open(output, FileAccessMode::WRITE_ONLY,
+			FileOpenOptions::TRUNCATE);
+  sorter.finish(out);
+}
+
+void ExternalSorter::spill_() {
+  if (batch_.empty()) {
+    return;
+  }
+
+  // Wait for a thread to become free
+  collectRuns_(options_.threads - 1);
+  pending_.push_back(std::async(
+      std::launch::async,
+      [this, lines = std::move(batch_)]() mutable { return writeRun_(lines); }
+  ));
+  batch_ = std::vector<std::string>();
+  batchBytes_ = 0;
+}
+
+void ExternalSorter::collectRuns_(size_t maxPending) {
+  while (pending_.size() > maxPending) {
+    std::future<std::string> run = std::move(pending_.front());
+    pending_.erase(pending_.begin());
+    runs_.push_back(run.get());
+  }
+}
+
+std::string ExternalSorter::createRunFile_(File& file) const {
+  std::string dir = options_.tempDirectory;
+  if (dir.empty()) {
+    const char* tmpDir = ::getenv("TMPDIR");
+    dir = tmpDir ? tmpDir : "/tmp";
+  }
+
+  std::string name = dir + "/pistis_sort_XXXXXX";
+  int fd = ::mkstemp(&name[0]);
+  if (fd < 0) {
+    throw IOError::fromSystemError("Error creating temporary file in " + dir +
+				   ": #ERR#", PISTIS_EX_HERE);
+  }
+  file = File(fd, name);
+  return name;
+}
+
+std::string ExternalSorter::writeRun_(std::vector<std::string>& lines) const {
+  File file(-1);
+  std::string name = createRunFile_(file);
+  try {
+    OutputBuffer out(file);
+    std::sort(lines.begin(), lines.end(), compare_);
+    for (const std::string& line : lines) {
+      out.append(line);
+    }
+    out.flush();
+  } catch(...) {
+    ::unlink(name.c_str());
+    throw;
+  }
+  return name;
+}
+
+size_t ExternalSorter::readAheadFor_(size_t numRuns) const {
+  const size_t share = options_.memoryBudget / std::max<size_t>(numRuns, 1);
+  return std::max(options_.minReadAhead, std::min(share, MAX_READ_AHEAD));
+}
+
+void ExternalSorter::merge_(const std::vector<std::string>& runs,
+			    File& output, size_t readAhead) const {
+  MergeReader reader(runs, compare_, readAhead * runs.size());
+  OutputBuffer out(output);
+
+  while (reader.next()) {
+    out.append(reader.line());
+  }
+  out.flush();
+}
+
+void ExternalSorter::removeRuns_() noexcept {
+  for (auto& run : pending_) {
+    try {
+      runs_.push_back(run.get());
+    } catch(...) {
+      // The run was never written, or writeRun_() removed it
+    }
+  }
+  pending_.clear();
+  for (const std::string& name : runs_) {
+    ::unlink(name.c_str());
+  }
+  runs_.clear();
+  batch_.clear();
+  batchBytes_ = 0;
+}
@@ -0,0 +1,127 @@
+#ifndef __PISTIS__FILESYSTEM__EXTERNALSORT_HPP__
+#define __PISTIS__FILESYSTEM__EXTERNALSORT_HPP__
+
+/** @file ExternalSort.hpp
+ *
+ *  Declaration of pistis::filesystem::ExternalSorter, which sorts more
+ *  lines than fit in memory.
+ */
+
+#include <pistis/filesystem/File.hpp>
+
+#include <functional>
+#include <future>
+#include <string>
+#include <vector>
+
+#include <stddef.h>
+
+namespace pistis {
+  namespace filesystem {
+
+    /** @brief Options that control how an ExternalSorter uses memory,
+     *         threads and temporary files
+     */
+    struct ExternalSortOptions {
+      /** @brief Approximate number of bytes of lines held in memory at
+       *         once, across all threads.
+       */
+      size_t memoryBudget = 256 * 1024 * 1024;
+
+      /** @brief Number of threads that sort and write runs.  Zero means
+       *         one per hardware thread.
+       */
+      size_t threads = 0;
+
+      /** @brief Directory for the sorted runs.  Empty means the value of
+       *         the TMPDIR environment variable, or /tmp if it isn't set.
+       */
+      std::string tempDirectory;
+
+      /** @brief Smallest read-ahead buffer given to each run during the
+       *         merge.  Runs share what is left of memoryBudget equally.
+       */
+      size_t minReadAhead = 64 * 1024;
+
+      /** @brief Largest number of runs merged at once.  If there are
+       *         more, they are merged in several passes.
+       */
+      size_t maxMergeWidth = 256;
+    };
+
+    /** @brief Sorts lines using temporary files when they don't fit in
+     *         memory.
+     *
+     *  Lines are collected in memory until their share of the memory
+     *  budget is used up.  The batch is then handed to a worker thread
+     *  that sorts it and writes it to a temporary "run" file while more
+     *  lines are collected.  finish() merges the runs with a MergeReader,
+     *  giving each run its own read-ahead buffer, and writes the result.
+     *  Every line in the output ends with a newline, including the last
+     *  line of an input that didn't end with one.  The sort is not
+     *  stable.
+     *
+     *  Temporary files are removed by finish() and by the destructor.
+     */
+    class ExternalSorter {
+    public:
+      typedef std::function<bool (const std::string&, const std::string&)>
+	  Comparator;
+
+    public:
+      ExternalSorter(const ExternalSortOptions& options = ExternalSortOptions(),
+		     Comparator compare = std::less<std::string>());
+      ExternalSorter(const ExternalSorter&) = delete;
+      ~ExternalSorter();
+
+      /** @brief Add one line.  The line may or may not end with a
+       *         newline.
+       */
+      void add(const std::string& line);
+
+      /** @brief Add every line in file */
+      void addFile(File& file) {
+	file.eachLine([this](const std::string& line) { add(line); });
+      }
+
+      /** @brief Number of runs written to temporary files so far */
+      size_t runCount() const { return runs_.size() + pending_.size(); }
+
+      /** @brief Merge everything added so far and write it to output.
+       *
+       *  The sorter is empty afterwards and may be reused.
+       */
+      void finish(File& output);
+
+      ExternalSorter& operator=(const ExternalSorter&) = delete;
+
+      /** @brief Sort the lines of the file input into the file output */
+      static void sortFile(
+	  const std::string& input, const std::string& output,
+	  const ExternalSortOptions& options = ExternalSortOptions(),
+	  Comparator compare = std::less<std::string>()
+      );
+
+    private:
+      ExternalSortOptions options_;
+      Comparator compare_;
+      size_t batchBudget_;
+      std::vector<std::string> batch_;
+      size_t batchBytes_;
+      std::vector<std::future<std::string>> pending_;
+      std::vector<std::string> runs_;
+
+      void spill_();
+      void collectRuns_(size_t maxPending);
+      std::string createRunFile_(File& file) const;
+      std::string writeRun_(std::vector<std::string>& lines) const;
+      size_t readAheadFor_(size_t numRuns) const;
+      void merge_(const std::vector<std::string>& runs, File& output,
+		  size_t readAhead) const;
+      void removeRuns_() noexcept;
+    };
+
+  }
+}
+
+#endif
@@ -1,35 +1,342 @@
 #include "File.hpp"
+#include "ByteScanning.hpp"
 
 #include <pistis/exceptions/IOError.hpp>
 
 #include <algorithm>
+#include <charconv>
 #include <sstream>
 
+#include <errno.h>
 #include <fcntl.h>
 #include <stdint.h>
+#include <sys/sendfile.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <string.h>
 #include <unistd.h>
 
+// When the library is built with instrumentation, File times each
+// operation and records it with FileInstrumentation.  Otherwise these
+// macros expand to nothing and the operations carry no extra cost.
+#ifdef PISTIS_FILESYSTEM_INSTRUMENTATION
+#include "FileInstrumentation.hpp"
+
+#define PISTIS_FILESYSTEM_TIME_OPERATION(OP, NAME) \
+    FileOperationTimer operationTimer_(FileOperation::OP, NAME)
+#define PISTIS_FILESYSTEM_OPERATION_BYTES(N) operationTimer_.setBytes(N)
+#else
+#define PISTIS_FILESYSTEM_TIME_OPERATION(OP, NAME)
+#define PISTIS_FILESYSTEM_OPERATION_BYTES(N)
+#endif
+
 using namespace pistis::filesystem;
 using namespace pistis::exceptions;
 
-File::Buffer::Buffer(size_t initialSize, size_t maxSize):
-    data_(nullptr), initialSize_(initialSize), maxSize_(maxSize), size_(0),
-    current_(0), end_(0) {
+const size_t File::INITIAL_BUFFER_SIZE;
+const size_t File::MAX_BUFFER_SIZE;
+const size_t File::WOULD_BLOCK;
+const size_t File::HUGE_PAGE_SIZE;
+const uint64_t File::NO_DIFFERENCE;
+const size_t File::LINE_BATCH_SIZE_;
+
+namespace {
+  static const size_t SPLICE_CHUNK_SIZE = 1024 * 1024;
+  static const size_t COPY_BUFFER_SIZE = 64 * 1024;
+
+  // firstDifference() and countLines() read the file in chunks this
+  // size, into scratch space kept for each thread
+  static const size_t CHUNK_SIZE = 256 * 1024;
+
+  // Searches grow the read buffer to at least this size, so each read
+  // brings in a useful amount of text to scan
+  static const size_t SEARCH_BUFFER_SIZE = 64 * 1024;
+  static const unsigned SPLICE_FLAGS = SPLICE_F_MOVE | SPLICE_F_MORE;
+
+  // An adaptive buffer recomputes its target size every ADAPT_INTERVAL
+  // lines, sizing it to hold two lines as long as all but 1 in
+  // TAIL_FRACTION recent lines.  It shrinks once it is SHRINK_RATIO times
+  // the target, and grows by at most 2^MAX_GROWTH_SHIFT at a time.
+  static const uint32_t ADAPT_INTERVAL = 256;
+  static const uint64_t TAIL_FRACTION = 100;
+  static const size_t SHRINK_RATIO = 4;
+  static const uint32_t MAX_GROWTH_SHIFT = 4;
+
+  // Room for two chunks
+  uint8_t* chunkBuffer() {
+    static thread_local std::unique_ptr<uint8_t[]> chunks(
+	new uint8_t[2 * CHUNK_SIZE]
+    );
+    return chunks.get();
+  }
+
+  inline bool isSpace(char c) {
+    return (c == ' ') || ((c >= '\t') && (c <= '\r'));
+  }
+
+  // Parse all of [begin, end) as a T.  Unlike std::from_chars(), accepts
+  // a leading '+'.
+  template <typename T>
+  bool parseNumber(const char* begin, const char* end, T& value) {
+    if ((end - begin > 1) && (*begin == '+') && (begin[1] != '-')) {
+      ++begin;
+    }
+    const std::from_chars_result result = std::from_chars(begin, end, value);
+    return (result.ec == std::errc()) && (result.ptr == end) &&
+	   (begin != end);
+  }
+
+  template <typename T> const char* typeName();
+  template <> const char* typeName<int64_t>() { return "integer"; }
+  template <> const char* typeName<double>() { return "number"; }
+
+  template <typename T>
+  void parseToken(const File& file, const char* begin, const char* end,
+		  T& value) {
+    if (!parseNumber(begin, end, value)) {
+      throw IOError("Error reading " +
+		    (file.name().size() ? file.name() : std::string("file")) +
+		    ": \"" + std::string(begin, end) + "\" is not a valid " +
+		    typeName<T>(), PISTIS_EX_HERE);
+    }
+  }
+
+  template <typename T>
+  std::vector<T> readColumn(File& file, const DelimitedFormat& format,
+			    size_t column) {
+    std::vector<T> values;
+    file.eachRow(format, { column }, [&](const DelimitedRow& row) {
+      const char* begin = row[0].data();
+      const char* end = begin + row[0].size();
+      while ((begin < end) && isSpace(*begin)) {
+	++begin;
+      }
+      while ((end > begin) && isSpace(end[-1])) {
+	--end;
+      }
+      values.push_back(T());
+      if (!parseNumber(begin, end, values.back())) {
+	throw IOError("Error reading " +
+		      (file.name().size() ? file.name()
+					  : std::string("file")) +
+		      ": Row " + std::to_string(row.number()) + ", column " +
+		      std::to_string(column) + ": \"" +
+		      std::string(begin, end) + "\" is not a valid " +
+		      typeName<T>(), PISTIS_EX_HERE);
+      }
+    });
+    return values;
+  }
+
+  enum class FdType { PIPE, SOCKET, REGULAR, OTHER };
+
+  FdType typeOf(int fd) {
+    struct stat statistics;
+    if (::fstat(fd, &statistics) < 0) {
+      return FdType::OTHER;
+    } else if (S_ISFIFO(statistics.st_mode)) {
+      return FdType::PIPE;
+    } else if (S_ISSOCK(statistics.st_mode)) {
+      return FdType::SOCKET;
+    } else if (S_ISREG(statistics.st_mode)) {
+      return FdType::REGULAR;
+    }
+    return FdType::OTHER;
+  }
+
+  // The pipe that carries data between two descriptors when neither of
+  // them is a pipe.  Each thread has its own, created on first use and
+  // closed when the thread exits.
+  class RelayPipe {
+  public:
+    RelayPipe(): readFd(-1), writeFd(-1) { }
+    ~RelayPipe() { close(); }
+
+    bool open() {
+      if (readFd < 0) {
+	int fds[2];
+	if (::pipe2(fds, O_CLOEXEC) < 0) {
+	  return false;
+	}
+	readFd = fds[0];
+	writeFd = fds[1];
+	// A bigger pipe moves more data per splice().  If the system limit
+	// is lower, keep the default size.
+	::fcntl(writeFd, F_SETPIPE_SZ, (int)SPLICE_CHUNK_SIZE);
+      }
+      return true;
+    }
+
+    // After an error, data may be stuck in the pipe and would leak into
+    // the next transfer, so throw the pipe away
+    void close() {
+      if (readFd >= 0) {
+	::close(readFd);
+	::close(writeFd);
+	readFd = -1;
+	writeFd = -1;
+      }
+    }
+
+    int readFd;
+    int writeFd;
+  };
+
+  thread_local RelayPipe relayPipe;
+
+  // Make a view of the field in [start, end), removing the quotes around
+  // it and undoubling the quotes inside it.  The text is unquoted in place,
+  // since it has already been scanned.
+  std::string_view unquoteField(uint8_t* start, uint8_t* end, int quote) {
+    if ((quote < 0) || (start == end) || (*start != quote)) {
+      return std::string_view((const char*)start, end - start);
+    }
+
+    uint8_t* out = start;
+    for (uint8_t* p = start + 1; p < end; ++p) {
+      if (*p != quote) {
+	*out++ = *p;
+      } else if ((p + 1 < end) && (p[1] == quote)) {
+	*out++ = *p++;
+      }
+    }
+    return std::string_view((const char*)start, out - start);
+  }
+
+  void writeAll(int fd, const uint8_t* data, size_t n,
+		const std::string& errorMessage) {
+    while (n) {
+      ssize_t nWritten = ::write(fd, data, n);
+      if (nWritten < 0) {
+	if (errno == EINTR) {
+	  continue;
+	}
+	throw IOError::fromSystemError(errorMessage, PISTIS_EX_HERE);
+      }
+      data += nWritten;
+      n -= nWritten;
+    }
+  }
+
+  // Splice exactly n bytes from a pipe to out
+  void drainPipe(int pipeFd, int out, size_t n,
+		 const std::string& errorMessage) {
+    while (n) {
+      ssize_t nMoved = ::splice(pipeFd, nullptr, out, nullptr, n,
+				SPLICE_FLAGS);
+      if (nMoved <= 0) {
+	if ((nMoved < 0) && (errno == EINTR)) {
+	  continue;
+	}
+	relayPipe.close();
+	throw IOError::fromSystemError(errorMessage, PISTIS_EX_HERE);
+      }
+      n -= nMoved;
+    }
+  }
+
+  // Move data from in to out through user space, for descriptors the
+  // kernel can't splice
+  size_t copyData(int in, int out, size_t n,
+		  const std::string& readErrorMessage,
+		  const std::string& writeErrorMessage) {
+    std::unique_ptr<uint8_t[]> buffer(new uint8_t[COPY_BUFFER_SIZE]);
+    size_t total = 0;
+    while (total < n) {
+      ssize_t nRead = ::read(in, buffer.get(),
+			     std::min(n - total, COPY_BUFFER_SIZE));
+      if (nRead < 0) {
+	if (errno == EINTR) {
+	  continue;
+	}
+	throw IOError::fromSystemError(readErrorMessage, PISTIS_EX_HERE);
+      } else if (!nRead) {
+	break;
+      }
+      writeAll(out, buffer.get(), nRead, writeErrorMessage);
+      total += nRead;
+    }
+    return total;
+  }
+
+  // Move up to n bytes from in to out without copying through user space.
+  // Returns the number of bytes moved, which is less than n only at the
+  // end of in.
+  size_t transfer(int in, int out, size_t n,
+		  const std::string& readErrorMessage,
+		  const std::string& writeErrorMessage) {
+    const FdType inType = typeOf(in);
+    const FdType outType = typeOf(out);
+    size_t total = 0;
+
+    while (total < n) {
+      const size_t chunk = std::min(n - total, SPLICE_CHUNK_SIZE);
+      ssize_t nMoved;
+
+      if ((inType == FdType::PIPE) || (outType == FdType::PIPE)) {
+	nMoved = ::splice(in, nullptr, out, nullptr, chunk, SPLICE_FLAGS);
+      } else if ((inType == FdType::REGULAR) &&
+		 (outType == FdType::SOCKET)) {
+	nMoved = ::sendfile(out, in, nullptr, chunk);
+      } else if (relayPipe.open()) {
+	nMoved = ::splice(in, nullptr, relayPipe.writeFd, nullptr, chunk,
+			  SPLICE_FLAGS);
+	if (nMoved > 0) {
+	  drainPipe(relayPipe.readFd, out, nMoved, writeErrorMessage);
+	}
+      } else {
+	nMoved = -1;
+	errno = EINVAL;
+      }
+
+      if (nMoved < 0) {
+	if (errno == EINTR) {
+	  continue;
+	} else if ((errno == EINVAL) || (errno == ENOSYS)) {
+	  // These descriptors can't be spliced
+	  return total + copyData(in, out, n - total, readErrorMessage,
+				  writeErrorMessage);
+	}
+	throw IOError::fromSystemError(readErrorMessage, PISTIS_EX_HERE);
+      } else if (!nMoved) {
+	break;
+      }
+      total += nMoved;
+    }
+    return total;
+  }
+}
+
+void File::Buffer::Deleter::operator()(uint8_t* p) const {
+  if (mappedSize) {
+    hugepages::release(p, mappedSize);
+  } else {
+    delete[] p;
+  }
+}
+
+File::Buffer::Buffer(size_t initialSize, size_t maxSize,
+		     BufferPolicy policy):
+    data_(nullptr), hugePages_(false), initialSize_(initialSize),
+    maxSize_(maxSize), size_(0), current_(0), end_(0),
+    adaptive_(policy == BufferPolicy::ADAPTIVE), shrinkPending_(false),
+    linesSinceUpdate_(0), growthsInLine_(0), targetSize_(initialSize),
+    lineLengths_() {
 }
 
 size_t File::Buffer::fill(File* file) {
   if (!data_) {
     // Initial fill
-    data_ = std::unique_ptr<uint8_t[]>(new uint8_t[initialSize_]);
+    data_ = allocate_(file, initialSize_);
     size_ = initialSize_;
     current_ = 0;
     end_ = file->read_(data_.get(), size_);
     return end_;
   } else {
-    shift_();
+    if (shrinkPending_) {
+      shrink_(file);
+    }
+    file->stats_.bytesShifted += shift_();
 
     if (size_ == end_) {
       return 0;
@@ -41,25 +348,31 @@ size_t File::Buffer::fill(File* file) {
   }
 }
 
-size_t File::Buffer::doubleAndFill(File* file) {
-  if (data_ && (size_ < maxSize_)) {
-    size_t newSize = size_ << 1;
-    // If size_ << 1 overflows, its value will be <= size_
-    if ((newSize > maxSize_) || (newSize <= size_)) {
-      newSize = maxSize_;
+size_t File::Buffer::tryFill(File* file) {
+  if (!data_) {
+    data_ = allocate_(file, initialSize_);
+    size_ = initialSize_;
+    current_ = 0;
+    end_ = 0;
+  } else {
+    if (shrinkPending_) {
+      shrink_(file);
     }
-    if (newSize > size_) {
-      std::unique_ptr<uint8_t[]> newData(new uint8_t[newSize]);
-      size_t nInBuffer = end_ - current_;
-      if (nInBuffer) {
-	::memcpy((void*)newData.get(), data_.get() + current_, nInBuffer);
-      }
-      data_.swap(newData);
-      size_ = newSize;
-      current_ = 0;
-      end_ = nInBuffer;
+    file->stats_.bytesShifted += shift_();
+    if (size_ == end_) {
+      return 0;
     }
   }
+
+  size_t nRead = file->tryRead_(data_.get() + end_, size_ - end_);
+  if (nRead != WOULD_BLOCK) {
+    end_ += nRead;
+  }
+  return nRead;
+}
+
+size_t File::Buffer::doubleAndFill(File* file) {
+  double_(file);
   return fill(file);
 }
 
@@ -72,18 +385,26 @@ size_t File::Buffer::empty(uint8_t* buffer, size_t n) {
   return nToUse;
 }
 
+size_t File::Buffer::hugePageBytes() const {
+  const size_t mappedSize = data_.get_deleter().mappedSize;
+  return mappedSize ? hugepages::backedBytes(data_.get(), mappedSize) : 0;
+}
+
 void File::Buffer::clear() {
   current_ = 0;
   end_ = 0;
 }
 
-std::string File::Buffer::nextLine(File* file) {
-  // First try: see if there is a line already in the buffer
+bool File::Buffer::nextLine(File* file, std::string& line) {
+  // First try: see if there is a line already in the buffer.  Skip this
+  //            when the buffer is empty, since findLineEnd_() would mistake
+  //            an empty buffer left by clear() for the end of the file.
   const uint8_t* pStart = data();
-  const uint8_t* p = findLineEnd_(data());
+  const uint8_t* p = remaining() ? findLineEnd_(pStart) : nullptr;
   if (p) {
     current_ += p - pStart;
-    return std::string(pStart, p);
+    line.assign(pStart, p);
+    return !line.empty();
   }
 
   // Second try: Fill the buffer and look for the end of a line.
@@ -95,7 +416,8 @@ std::string File::Buffer::nextLine(File* file) {
   p = findLineEnd_(pStart + nScanned);
   if (p) {
     current_ += p - pStart;
-    return std::string(pStart, p);
+    line.assign(pStart, p);
+    return !line.empty();
   }
     
   // Third try: Double the buffer size and keep looking for the end of a line.
@@ -106,28 +428,171 @@ std::string File::Buffer::nextLine(File* file) {
     p = findLineEnd_(pStart + nScanned);
     if (p) {
       current_ += p - pStart;
-      return std::string(pStart, p);
+      line.assign(pStart, p);
+      return !line.empty();
     }
   }
 
   // The line won't fit into the buffer, even at maximum size.  Accumulate
-  // the line into an ostringstream
-  std::ostringstream text;
+  // the line a buffer at a time.
+  line.clear();
   while (true) {
-    text.write((const char*)pStart, end_);
+    line.append((const char*)pStart, end_);
     current_ = end_;
 
+    // An adaptive buffer may shrink during the fill, which reallocates it
     fill(file);
+    pStart = data();
     p = findLineEnd_(pStart);
     if (p) {
       current_ += (p - pStart);
-      text.write((const char*)pStart, p - pStart);
-      return text.str();
+      line.append((const char*)pStart, p - pStart);
+      return true;
+    }
+  }
+}
+
+size_t File::Buffer::tryNextLine(File* file, std::string& line) {
+  // Unlike nextLine(), this can't take a short read for the end of the
+  // file, so it only stops when read() returns 0
+  size_t nScanned = 0;
+  while (true) {
+    const uint8_t* pStart = data();
+    if (remaining() > nScanned) {
+      const uint8_t* p = (const uint8_t*)::memchr(pStart + nScanned, '\n',
+						  remaining() - nScanned);
+      if (p) {
+	++p;
+	line.assign(pStart, p);
+	current_ += p - pStart;
+	return line.size();
+      }
+      nScanned = remaining();
+    }
+
+    if (data_ && (remaining() == size_) && !double_(file)) {
+      throw IOError("Error reading " +
+		    (file->name_.size() ? file->name_ : std::string("file")) +
+		    ": Line is longer than the maximum buffer size",
+		    PISTIS_EX_HERE);
+    }
+
+    // tryFill() moves the data to the start of the buffer, so nScanned
+    // stays valid
+    size_t nRead = tryFill(file);
+    if (nRead == WOULD_BLOCK) {
+      return WOULD_BLOCK;
+    } else if (!nRead) {
+      line.assign(data(), end());
+      current_ = end_;
+      return line.size();
+    }
+  }
+}
+
+size_t File::Buffer::scanLines(LineSpan* spans, size_t maxLines) {
+  const uint8_t* const pStart = data();
+  const uint8_t* const pEnd = end();
+  const uint8_t* p = pStart;
+  size_t n = 0;
+
+  while ((n < maxLines) && (p < pEnd)) {
+    const uint8_t* q = (const uint8_t*)::memchr(p, '\n', pEnd - p);
+    if (!q) {
+      break;
+    }
+    ++q;
+    spans[n].offset = p - pStart;
+    spans[n].length = q - p;
+    ++n;
+    p = q;
+  }
+  current_ += p - pStart;
+  return n;
+}
+
+bool File::Buffer::skipLine(File* file) {
+  bool skipped = false;
+  while (true) {
+    const uint8_t* pStart = data();
+    const uint8_t* p = remaining()
+	? (const uint8_t*)::memchr(pStart, '\n', remaining()) : nullptr;
+    if (p) {
+      current_ += (p + 1) - pStart;
+      return true;
+    }
+    skipped = skipped || remaining();
+    current_ = end_;
+    if (!fill(file)) {
+      // End of file.  A final line without a newline still counts.
+      return skipped;
+    }
+  }
+}
+
+File::Buffer::Storage File::Buffer::allocate_(File* file, size_t n) {
+  if (hugePages_ && (n >= hugepages::HUGE_PAGE_SIZE)) {
+    Storage storage(hugepages::allocate(n), Deleter(n));
+    ++file->stats_.hugePageBuffers;
+    return storage;
+  }
+  return Storage(new uint8_t[n]);
+}
+
+void File::Buffer::noteLine_(size_t length) {
+  ++lineLengths_[length ? 64 - __builtin_clzll(length) : 0];
+  growthsInLine_ = 0;
+  if (++linesSinceUpdate_ >= ADAPT_INTERVAL) {
+    updateTargetSize_();
+  }
+}
+
+void File::Buffer::updateTargetSize_() {
+  uint64_t total = 0;
+  for (uint32_t count : lineLengths_) {
+    total += count;
+  }
+
+  // Find the fewest bits that hold the length of all but the longest
+  // 1 in TAIL_FRACTION lines
+  const uint64_t tail = total / TAIL_FRACTION;
+  uint64_t longer = 0;
+  size_t bits = 64;
+  while (bits && (longer + lineLengths_[bits] <= tail)) {
+    longer += lineLengths_[bits];
+    --bits;
+  }
+
+  // Lines with that many bits are shorter than 2^bits, so a buffer of
+  // 2^(bits + 1) holds at least two of them
+  const size_t target = (bits < 62) ? ((size_t)2 << bits) : maxSize_;
+  targetSize_ = std::min(std::max(target, initialSize_), maxSize_);
+  shrinkPending_ = data_ && (size_ >= SHRINK_RATIO * targetSize_);
+
+  for (uint32_t& count : lineLengths_) {
+    count >>= 1;
+  }
+  linesSinceUpdate_ = 0;
+}
+
+void File::Buffer::shrink_(File* file) {
+  // Wait until the data still in the buffer fits with room to spare
+  const size_t nInBuffer = remaining();
+  if (nInBuffer < targetSize_) {
+    Storage newData = allocate_(file, targetSize_);
+    if (nInBuffer) {
+      ::memcpy((void*)newData.get(), data_.get() + current_, nInBuffer);
     }
+    data_.swap(newData);
+    size_ = targetSize_;
+    current_ = 0;
+    end_ = nInBuffer;
+    shrinkPending_ = false;
+    ++file->stats_.bufferShrinks;
   }
 }
 
-void File::Buffer::shift_() {
+size_t File::Buffer::shift_() {
   if (current_) {
     size_t nInBuffer = remaining();
     if (nInBuffer) {
@@ -135,7 +600,43 @@ void File::Buffer::shift_() {
     }
     current_ = 0;
     end_ = nInBuffer;
+    return nInBuffer;
   }
+  return 0;
+}
+
+bool File::Buffer::double_(File* file) {
+  if (data_ && (size_ < maxSize_)) {
+    size_t newSize = size_ << 1;
+    if (adaptive_) {
+      // Go straight to the size recent long lines needed, and grow faster
+      // each time the same line needs more room
+      newSize = std::max(
+	  size_ << std::min(growthsInLine_ + 1, MAX_GROWTH_SHIFT),
+	  targetSize_
+      );
+      ++growthsInLine_;
+      shrinkPending_ = false;
+    }
+    // If the shift overflows, its value will be <= size_
+    if ((newSize > maxSize_) || (newSize <= size_)) {
+      newSize = maxSize_;
+    }
+    if (newSize > size_) {
+      Storage newData = allocate_(file, newSize);
+      size_t nInBuffer = end_ - current_;
+      if (nInBuffer) {
+	::memcpy((void*)newData.get(), data_.get() + current_, nInBuffer);
+      }
+      data_.swap(newData);
+      size_ = newSize;
+      current_ = 0;
+      end_ = nInBuffer;
+      ++file->stats_.bufferGrowths;
+      return true;
+    }
+  }
+  return false;
 }
 
 const uint8_t* File::Buffer::findLineEnd_(const uint8_t* start) {
@@ -158,13 +659,16 @@ const uint8_t* File::Buffer::findLineEnd_(const uint8_t* start) {
   return nullptr;
 }
 
-File::File(int fd, size_t initialBufferSize, size_t maxBufferSize):
-    fd_(fd), name_(), buffer_(initialBufferSize, maxBufferSize) {
+File::File(int fd, size_t initialBufferSize, size_t maxBufferSize,
+	   BufferPolicy bufferPolicy):
+    fd_(fd), name_(),
+    buffer_(initialBufferSize, maxBufferSize, bufferPolicy), stats_() {
 }
 
 File::File(int fd, const std::string& name, size_t initialBufferSize,
-	   size_t maxBufferSize):
-    fd_(fd), name_(name), buffer_(initialBufferSize, maxBufferSize) {
+	   size_t maxBufferSize, BufferPolicy bufferPolicy):
+    fd_(fd), name_(name),
+    buffer_(initialBufferSize, maxBufferSize, bufferPolicy), stats_() {
 }
 
 File::~File() {
@@ -182,29 +686,82 @@ size_t File::position() const {
   return pos;
 }
 
+bool File::nonBlocking() const {
+  int flags = ::fcntl(fd_, F_GETFL);
+  if (flags < 0) {
+    throw IOError::fromSystemError(createErrorMessage_("reading flags of"),
+				   PISTIS_EX_HERE);
+  }
+  return (bool)(flags & O_NONBLOCK);
+}
+
+void File::setNonBlocking(bool nonBlocking) {
+  int flags = ::fcntl(fd_, F_GETFL);
+  if (flags >= 0) {
+    flags = nonBlocking ? (flags | O_NONBLOCK) : (flags & ~O_NONBLOCK);
+    if (::fcntl(fd_, F_SETFL, flags) >= 0) {
+      return;
+    }
+  }
+  throw IOError::fromSystemError(createErrorMessage_("setting flags of"),
+				 PISTIS_EX_HERE);
+}
+
 size_t File::read(void* buffer, size_t n) {
   size_t nInBuffer = buffer_.remaining();
   if (nInBuffer >= n) {
-    buffer_.empty((uint8_t*)buffer, n);
+    return buffer_.empty((uint8_t*)buffer, n);
   } else if (nInBuffer) {
     buffer_.empty((uint8_t*)buffer, nInBuffer);
-    return nInBuffer + read_(((uint8_t*)buffer) + nInBuffer, n - nInBuffer);
+    size_t nRead = tryRead_(((uint8_t*)buffer) + nInBuffer, n - nInBuffer);
+    return (nRead == WOULD_BLOCK) ? nInBuffer : nInBuffer + nRead;
   } else {
     return read_((uint8_t*)buffer, n);
   }
 }
 
+size_t File::tryRead(void* buffer, size_t n) {
+  size_t nInBuffer = buffer_.remaining();
+  if (nInBuffer >= n) {
+    return buffer_.empty((uint8_t*)buffer, n);
+  } else if (nInBuffer) {
+    buffer_.empty((uint8_t*)buffer, nInBuffer);
+    size_t nRead = tryRead_(((uint8_t*)buffer) + nInBuffer, n - nInBuffer);
+    return (nRead == WOULD_BLOCK) ? nInBuffer : nInBuffer + nRead;
+  } else {
+    return tryRead_((uint8_t*)buffer, n);
+  }
+}
+
 size_t File::write(const void* buffer, size_t n) {
+  size_t nWritten = tryWrite(buffer, n);
+  if (nWritten == WOULD_BLOCK) {
+    errno = EAGAIN;
+    throw IOError::fromSystemError(createErrorMessage_("writing"),
+				   PISTIS_EX_HERE);
+  }
+  return nWritten;
+}
+
+size_t File::tryWrite(const void* buffer, size_t n) {
+  PISTIS_FILESYSTEM_TIME_OPERATION(WRITE, name_);
   ssize_t nWritten = ::write(fd_, buffer, n);
   if (nWritten < 0) {
+    if ((errno == EAGAIN) || (errno == EWOULDBLOCK)) {
+      return WOULD_BLOCK;
+    }
     throw IOError::fromSystemError(createErrorMessage_("writing"),
 				   PISTIS_EX_HERE);
   }
-  buffer_.clear();
+  ++stats_.writeCalls;
+  stats_.bytesWritten += nWritten;
+  PISTIS_FILESYSTEM_OPERATION_BYTES(nWritten);
+  clearBuffer_();
   return nWritten;
 }
 
 size_t File::seek(FileOrigin origin, ssize_t offset) {
+  PISTIS_FILESYSTEM_TIME_OPERATION(SEEK, name_);
   size_t pos = ::lseek(fd_, offset, origin.value());
   if (pos == (size_t)-1) {
     std::string msg =
@@ -212,34 +769,544 @@ size_t File::seek(FileOrigin origin, ssize_t offset) {
     throw IOError::fromSystemError(createErrorMessage_("seeking in"),
 				   PISTIS_EX_HERE);
   }
-  buffer_.clear();
+  clearBuffer_();
   return pos;
 }
 
 void File::truncate(size_t size) {
+  PISTIS_FILESYSTEM_TIME_OPERATION(TRUNCATE, name_);
   if (::ftruncate(fd_, size) < 0) {
     throw IOError::fromSystemError(createErrorMessage_("truncating"),
 				   PISTIS_EX_HERE);
   }
-  buffer_.clear();
+  clearBuffer_();
+}
+
+size_t File::spliceTo(int fd, size_t n) {
+  const std::string readErrorMessage = createErrorMessage_("splicing from");
+  const std::string writeErrorMessage =
+      createErrorMessage_("descriptor " + std::to_string(fd),
+			  "splicing to");
+  size_t total = std::min(n, buffer_.remaining());
+
+  if (total) {
+    // This data has already been read, so it has to be written from the
+    // buffer
+    writeAll(fd, buffer_.data(), total, writeErrorMessage);
+    buffer_.skip(total);
+    n -= total;
+  }
+  if (n) {
+    size_t nMoved = transfer(fd_, fd, n, readErrorMessage, writeErrorMessage);
+    ++stats_.readCalls;
+    stats_.bytesRead += nMoved;
+    total += nMoved;
+  }
+  return total;
+}
+
+size_t File::spliceFrom(int fd, size_t n) {
+  const std::string readErrorMessage =
+      createErrorMessage_("descriptor " + std::to_string(fd),
+			  "splicing from");
+  const std::string writeErrorMessage = createErrorMessage_("splicing to");
+  clearBuffer_();
+
+  size_t nMoved = transfer(fd, fd_, n, readErrorMessage, writeErrorMessage);
+  ++stats_.writeCalls;
+  stats_.bytesWritten += nMoved;
+  return nMoved;
+}
+
+size_t File::teeTo(int fd, size_t n) {
+  while (true) {
+    ssize_t nCopied = ::tee(fd_, fd, n, 0);
+    if (nCopied >= 0) {
+      return nCopied;
+    } else if (errno != EINTR) {
+      throw IOError::fromSystemError(createErrorMessage_("teeing from"),
+				     PISTIS_EX_HERE);
+    }
+  }
+}
+
+const FileStatistics& File::stats() const {
+  // Measured here rather than when the buffer is allocated, because
+  // backedBytes() parses /proc/self/smaps
+  stats_.hugePageBytes = buffer_.hugePageBytes();
+  return stats_;
 }
 
 void File::close() noexcept {
   if (fd_ >= 0) {
+    PISTIS_FILESYSTEM_TIME_OPERATION(CLOSE, name_);
     ::close(fd_);
     fd_ = -1;
+    FileStatistics::addToProcessTotals(stats());
+  }
+}
+
+
+bool File::readLine(std::string& line) {
+  bool found = buffer_.nextLine(this, line);
+  if (found) {
+    noteLine_(line.size());
+  }
+  return found;
+}
+
+size_t File::tryReadLine(std::string& line) {
+  size_t n = buffer_.tryNextLine(this, line);
+  if (n && (n != WOULD_BLOCK)) {
+    noteLine_(n);
   }
+  return n;
 }
 
+size_t File::nextLineBatch_(LineSpan* spans, size_t maxLines,
+			    const uint8_t*& base, std::string& longLine) {
+  while (true) {
+    base = buffer_.data();
+    size_t n = buffer_.scanLines(spans, maxLines);
+    if (n) {
+      for (size_t i = 0; i < n; ++i) {
+	noteLine_(spans[i].length);
+      }
+      return n;
+    }
 
-std::string File::readLine() {
-  return buffer_.nextLine(this);
+    // The buffer doesn't hold a complete line, so read more, growing the
+    // buffer if it is full
+    const bool full = buffer_.size() &&
+		      (buffer_.remaining() == buffer_.size());
+    if (full && (buffer_.size() >= buffer_.maxSize())) {
+      // The line won't fit in the buffer, so nextLine() has to copy it
+      readLine(longLine);
+      base = (const uint8_t*)longLine.data();
+      spans[0].offset = 0;
+      spans[0].length = longLine.size();
+      return 1;
+    }
+    if (!(full ? buffer_.doubleAndFill(this) : buffer_.fill(this))) {
+      // End of file.  Whatever is left is the last line.
+      base = buffer_.data();
+      n = buffer_.remaining();
+      if (!n) {
+	return 0;
+      }
+      buffer_.skip(n);
+      spans[0].offset = 0;
+      spans[0].length = n;
+      noteLine_(n);
+      return 1;
+    }
+  }
+}
+
+bool File::readInt64(int64_t& value) {
+  const char* begin;
+  const char* end;
+  if (!nextToken_(begin, end)) {
+    return false;
+  }
+  parseToken(*this, begin, end, value);
+  return true;
+}
+
+bool File::readDouble(double& value) {
+  const char* begin;
+  const char* end;
+  if (!nextToken_(begin, end)) {
+    return false;
+  }
+  parseToken(*this, begin, end, value);
+  return true;
+}
+
+uint64_t File::readVarint() {
+  uint64_t value = 0;
+  if (buffer_.remaining() >= byteorder::MAX_VARINT_SIZE) {
+    // The whole varint is in the buffer, so decode without bounds checks
+    const uint8_t* p = buffer_.data();
+    for (size_t i = 0; i < byteorder::MAX_VARINT_SIZE; ++i) {
+      value |= (uint64_t)(p[i] & 0x7F) << (7 * i);
+      if (!(p[i] & 0x80)) {
+	buffer_.skip(i + 1);
+	return value;
+      }
+    }
+  } else {
+    for (size_t i = 0; i < byteorder::MAX_VARINT_SIZE; ++i) {
+      const uint8_t b = readU8();
+      value |= (uint64_t)(b & 0x7F) << (7 * i);
+      if (!(b & 0x80)) {
+	return value;
+      }
+    }
+  }
+  throw IOError("Error reading " +
+		(name_.size() ? name_ : std::string("file")) +
+		": Varint is longer than 10 bytes", PISTIS_EX_HERE);
+}
+
+void File::readBytes(void* data, size_t n) {
+  if (readFully_((uint8_t*)data, n) < n) {
+    throwUnexpectedEnd_();
+  }
+}
+
+uint64_t File::firstDifference(File& other) {
+  uint8_t* const mine = chunkBuffer();
+  uint8_t* const theirs = mine + CHUNK_SIZE;
+
+  // Known sizes let the comparison stop at the end of the shorter file
+  uint64_t mySize = 0;
+  uint64_t theirSize = 0;
+  const bool sizesKnown = remainingSize_(mySize) &&
+			  other.remainingSize_(theirSize);
+  const uint64_t limit = sizesKnown ? std::min(mySize, theirSize)
+				    : NO_DIFFERENCE;
+  uint64_t offset = 0;
+
+  while (offset < limit) {
+    const size_t n = (size_t)std::min<uint64_t>(CHUNK_SIZE,
+						limit - offset);
+    const size_t myCount = readFully_(mine, n);
+    const size_t theirCount = other.readFully_(theirs, n);
+    const size_t common = std::min(myCount, theirCount);
+
+    if (::memcmp(mine, theirs, common)) {
+      return offset + scanning::firstDifference(mine, theirs, common);
+    } else if (myCount != theirCount) {
+      return offset + common;
+    } else if (myCount < n) {
+      // Both ended, possibly earlier than their sizes said
+      return NO_DIFFERENCE;
+    }
+    offset += n;
+  }
+  return (sizesKnown && (mySize != theirSize)) ? limit : NO_DIFFERENCE;
+}
+
+uint64_t File::countLines() {
+  uint64_t count = 0;
+  int lastByte = -1;
+  size_t n = buffer_.remaining();
+
+  if (n) {
+    count += scanning::count(buffer_.data(), n, '\n');
+    lastByte = buffer_.data()[n - 1];
+    buffer_.skip(n);
+  }
+
+  uint8_t* const chunk = chunkBuffer();
+  while ((n = read_(chunk, CHUNK_SIZE)) != 0) {
+    count += scanning::count(chunk, n, '\n');
+    lastByte = chunk[n - 1];
+  }
+
+  // Like readLine(), count a last line without a newline
+  return ((lastByte < 0) || (lastByte == '\n')) ? count : count + 1;
+}
+
+std::vector<uint64_t> File::findAll(std::string_view pattern) {
+  std::vector<uint64_t> offsets;
+  eachMatch(pattern, [&offsets](uint64_t offset) {
+    offsets.push_back(offset);
+  });
+  return offsets;
+}
+
+bool File::seekMatch_(std::string_view pattern, uint64_t& skipped) {
+  const uint8_t* p = (const uint8_t*)pattern.data();
+  const size_t m = pattern.size();
+  if (m > buffer_.maxSize()) {
+    throw IOError("Error reading " +
+		  (name_.size() ? name_ : std::string("file")) +
+		  ": Pattern is longer than the maximum buffer size",
+		  PISTIS_EX_HERE);
+  }
+
+  const size_t minSize = std::max(m, std::min(SEARCH_BUFFER_SIZE,
+					      buffer_.maxSize()));
+  skipped = 0;
+  while (true) {
+    const size_t n = buffer_.remaining();
+    if (n >= m) {
+      const size_t i = scanning::find(buffer_.data(), n, p, m);
+      if (i < n) {
+	buffer_.skip(i);
+	skipped += i;
+	return true;
+      }
+
+      // The last m - 1 bytes could be the start of a match that crosses
+      // the end of the buffer, so keep them for the next pass
+      buffer_.skip(n - m + 1);
+      skipped += n - m + 1;
+    }
+
+    const size_t nRead = (buffer_.size() && (buffer_.size() < minSize))
+	? buffer_.doubleAndFill(this) : buffer_.fill(this);
+    if (!nRead) {
+      skipped += buffer_.remaining();
+      buffer_.skip(buffer_.remaining());
+      return false;
+    }
+  }
+}
+
+void File::findLines_(std::string_view pattern, const uint8_t* base,
+		      const LineSpan* spans, size_t n,
+		      std::vector<size_t>& matching) {
+  // The lines in a batch are back to back, so search them as one block
+  const uint8_t* p = (const uint8_t*)pattern.data();
+  const size_t m = pattern.size();
+  const size_t end = spans[n - 1].offset + spans[n - 1].length;
+  size_t start = spans[0].offset;
+  size_t line = 0;
+
+  matching.clear();
+  while (start < end) {
+    const size_t i = start + scanning::find(base + start, end - start, p, m);
+    if (i == end) {
+      break;
+    }
+    while (spans[line].offset + spans[line].length <= i) {
+      ++line;
+    }
+
+    const size_t lineEnd = spans[line].offset + spans[line].length;
+    if (i + m <= lineEnd) {
+      matching.push_back(line);
+      start = lineEnd;
+      ++line;
+    } else {
+      // The match runs past the end of the line
+      start = i + 1;
+    }
+  }
+}
+
+bool File::fillTo_(size_t n) {
+  if (n > buffer_.maxSize()) {
+    throw IOError("Error reading " +
+		  (name_.size() ? name_ : std::string("file")) + ": " +
+		  std::to_string(n) + " bytes won't fit in the read buffer",
+		  PISTIS_EX_HERE);
+  }
+  while (buffer_.remaining() < n) {
+    const size_t nRead = (buffer_.size() && (buffer_.size() < n))
+	? buffer_.doubleAndFill(this) : buffer_.fill(this);
+    if (!nRead) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void File::throwUnexpectedEnd_() const {
+  throw IOError("Error reading " +
+		(name_.size() ? name_ : std::string("file")) +
+		": Unexpected end of file", PISTIS_EX_HERE);
+}
+
+std::vector<int64_t> File::readInt64Column(const DelimitedFormat& format,
+					   size_t column) {
+  return readColumn<int64_t>(*this, format, column);
+}
+
+std::vector<double> File::readDoubleColumn(const DelimitedFormat& format,
+					   size_t column) {
+  return readColumn<double>(*this, format, column);
+}
+
+bool File::nextToken_(const char*& begin, const char*& end) {
+  // The token always starts at buffer_.data(), since whitespace before it
+  // is skipped.  nScanned counts the bytes of it already checked.
+  bool inToken = false;
+  size_t nScanned = 0;
+
+  while (true) {
+    const char* p = (const char*)buffer_.data();
+    const char* const pEnd = (const char*)buffer_.end();
+    if (!inToken) {
+      while ((p < pEnd) && isSpace(*p)) {
+	++p;
+      }
+      buffer_.skip(p - (const char*)buffer_.data());
+      inToken = p < pEnd;
+    }
+    if (inToken) {
+      const char* q = p + nScanned;
+      while ((q < pEnd) && !isSpace(*q)) {
+	++q;
+      }
+      if (q < pEnd) {
+	begin = p;
+	end = q;
+	buffer_.skip(q - p);
+	return true;
+      }
+      nScanned = q - p;
+    }
+
+    // The token runs to the end of the buffer, or the buffer is empty
+    const bool full = buffer_.size() &&
+		      (buffer_.remaining() == buffer_.size());
+    if (full && (buffer_.size() >= buffer_.maxSize())) {
+      throw IOError("Error reading " +
+		    (name_.size() ? name_ : std::string("file")) +
+		    ": Token is longer than the maximum buffer size",
+		    PISTIS_EX_HERE);
+    }
+    if (!(full ? buffer_.doubleAndFill(this) : buffer_.fill(this))) {
+      // End of file.  A token that was cut off by it is complete.
+      if (inToken && buffer_.remaining()) {
+	begin = (const char*)buffer_.data();
+	end = begin + buffer_.remaining();
+	buffer_.skip(buffer_.remaining());
+	return true;
+      }
+      return false;
+    }
+  }
+}
+
+LineBlock File::readLinesCompact() {
+  static const size_t BATCH_SIZE = 1024;
+  LineBlock block;
+  struct stat statistics;
+
+  // For a regular file, allocate the text buffer once
+  if ((::fstat(fd_, &statistics) == 0) && S_ISREG(statistics.st_mode)) {
+    const size_t here = position() - buffer_.remaining();
+    if ((size_t)statistics.st_size > here) {
+      block.reserveText(statistics.st_size - here);
+    }
+  }
+
+  eachLineBatch(BATCH_SIZE, [&block](const uint8_t* base,
+				     const LineSpan* spans, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+      block.append((const char*)base + spans[i].offset, spans[i].length);
+    }
+  });
+  block.shrinkToFit();
+  return block;
+}
+
+bool File::nextRow_(DelimitedScanner& scanner, DelimitedRow& row) {
+  DelimitedScanner& s = scanner;
+  if (!s.started_) {
+    s.started_ = true;
+    scanRows_(s);
+  }
+
+  while (true) {
+    // Look for the separator that ends the row
+    size_t last = s.cursor_;
+    while ((last < s.count_) && (s.base_[s.positions_[last]] != '\n')) {
+      ++last;
+    }
+
+    if ((last < s.count_) || s.atEnd_) {
+      size_t rowEnd = (last < s.count_) ? s.positions_[last] : s.scanned_;
+      if ((s.rowStart_ >= rowEnd) && (last >= s.count_)) {
+	return false;  // No more rows
+      }
+      const size_t nextRowStart = rowEnd + 1;
+      if ((rowEnd > s.rowStart_) && (s.base_[rowEnd - 1] == '\r')) {
+	--rowEnd;
+      }
+
+      const int quote = s.format_.quoting() ? (uint8_t)s.format_.quote()
+					    : -1;
+      const size_t numFields = last - s.cursor_ + 1;
+      size_t start = s.rowStart_;
+
+      row.fieldCount_ = numFields;
+      if (s.slots_.empty()) {
+	row.fields_.resize(numFields);
+	for (size_t i = 0; i < numFields; ++i) {
+	  const size_t end = (i + 1 < numFields) ? s.positions_[s.cursor_ + i]
+						 : rowEnd;
+	  row.fields_[i] = unquoteField(s.base_ + start, s.base_ + end, quote);
+	  start = end + 1;
+	}
+      } else {
+	row.fields_.assign(s.numSlots_, std::string_view());
+	const size_t n = std::min(numFields, s.slots_.size());
+	for (size_t i = 0; i < n; ++i) {
+	  const size_t end = (i + 1 < numFields) ? s.positions_[s.cursor_ + i]
+						 : rowEnd;
+	  if (s.slots_[i] >= 0) {
+	    row.fields_[s.slots_[i]] = unquoteField(s.base_ + start,
+						    s.base_ + end, quote);
+	  }
+	  start = end + 1;
+	}
+      }
+
+      row.number_ = s.rowCount_++;
+      s.cursor_ = last + 1;
+      s.rowStart_ = nextRowStart;
+      return true;
+    }
+
+    // The row continues past the end of the buffer.  Drop the rows already
+    // returned and read more.
+    buffer_.skip(s.rowStart_);
+    scanRows_(s);
+  }
+}
+
+void File::scanRows_(DelimitedScanner& s) {
+  if (!buffer_.remaining() || s.base_) {
+    const bool full = buffer_.size() &&
+		      (buffer_.remaining() == buffer_.size());
+    if (full && (buffer_.size() >= buffer_.maxSize())) {
+      throw IOError("Error reading " +
+		    (name_.size() ? name_ : std::string("file")) +
+		    ": Row is longer than the maximum buffer size",
+		    PISTIS_EX_HERE);
+    }
+    if (!(full ? buffer_.doubleAndFill(this) : buffer_.fill(this))) {
+      s.atEnd_ = true;
+    }
+  }
+
+  // Scanning restarts at the start of a row, which can't be inside quotes
+  bool inQuotes = false;
+  s.base_ = buffer_.data();
+  s.scanned_ = buffer_.remaining();
+  s.positions_.resize(s.scanned_);
+  s.count_ = scanning::findSeparators(
+      s.base_, s.scanned_, (uint8_t)s.format_.delimiter(),
+      s.format_.quoting() ? (uint8_t)s.format_.quote() : -1, inQuotes,
+      s.positions_.data()
+  );
+  s.cursor_ = 0;
+  s.rowStart_ = 0;
+}
+
+bool File::seekToLine(const LineIndex& index, uint64_t n) {
+  uint64_t line;
+  seek(FileOrigin::START, index.nearestOffset(n, line));
+  for (; line < n; ++line) {
+    if (!buffer_.skipLine(this)) {
+      return false;
+    }
+  }
+  // Make sure line n exists
+  return buffer_.remaining() || buffer_.fill(this);
 }
 
 File File::open(const std::string& name, FileCreationMode creation,
 		FileAccessMode access, FileOpenOptions options,
 		FilePermissions permissions, size_t initialBufferSize,
-		size_t maxBufferSize) {
+		size_t maxBufferSize, BufferPolicy bufferPolicy) {
+  PISTIS_FILESYSTEM_TIME_OPERATION(OPEN, name);
   int fd = ::open(name.c_str(),
 		  creation.flags() | access.flags() | options.flags(),
 		  permissions.flags());
@@ -247,7 +1314,7 @@ File File::open(const std::string& name, FileCreationMode creation,
     throw IOError::fromSystemError("Error opening " + name + ": #ERR#",
 				   PISTIS_EX_HERE);
   }
-  return File(fd, name, initialBufferSize, maxBufferSize);
+  return File(fd, name, initialBufferSize, maxBufferSize, bufferPolicy);
 }
 
 void File::unlink(const std::string& name) {
@@ -258,14 +1325,66 @@ void File::unlink(const std::string& name) {
 }
 
 size_t File::read_(uint8_t* buffer, size_t n) {
+  size_t nRead = tryRead_(buffer, n);
+  if (nRead == WOULD_BLOCK) {
+    errno = EAGAIN;
+    std::string msg = "reading " + (name_.size() ? name_ : std::string("file"));
+    throw IOError::fromSystemError(msg, PISTIS_EX_HERE);
+  }
+  return nRead;
+}
+
+size_t File::readFully_(uint8_t* buffer, size_t n) {
+  size_t nCopied = buffer_.empty(buffer, n);
+  while (nCopied < n) {
+    const size_t nRead = read_(buffer + nCopied, n - nCopied);
+    if (!nRead) {
+      break;
+    }
+    nCopied += nRead;
+  }
+  return nCopied;
+}
+
+bool File::remainingSize_(uint64_t& size) {
+  struct stat info;
+  if ((::fstat(fd_, &info) < 0) || !S_ISREG(info.st_mode)) {
+    return false;
+  }
+  const off_t position = ::lseek(fd_, 0, SEEK_CUR);
+  if (position < 0) {
+    return false;
+  }
+  size = buffer_.remaining() +
+	 ((position < info.st_size) ? (uint64_t)(info.st_size - position) : 0);
+  return true;
+}
+
+size_t File::tryRead_(uint8_t* buffer, size_t n) {
+  PISTIS_FILESYSTEM_TIME_OPERATION(READ, name_);
   ssize_t nRead = ::read(fd_, (void*)buffer, n);
   if (nRead < 0) {
+    if ((errno == EAGAIN) || (errno == EWOULDBLOCK)) {
+      return WOULD_BLOCK;
+    }
     std::string msg = "reading " + (name_.size() ? name_ : std::string("file"));
     throw IOError::fromSystemError(msg, PISTIS_EX_HERE);
   }
+  ++stats_.readCalls;
+  stats_.bytesRead += nRead;
+  PISTIS_FILESYSTEM_OPERATION_BYTES(nRead);
   return nRead;
 }
 
+void File::clearBuffer_() {
+  size_t nInBuffer = buffer_.remaining();
+  if (nInBuffer) {
+    ++stats_.bufferClears;
+    stats_.bytesDiscarded += nInBuffer;
+  }
+  buffer_.clear();
+}
+
 std::string File::createErrorMessage_(const std::string& name,
 				      const std::string& action) {
   std::ostringstream msg;
@@ -6,13 +6,22 @@
  *  Declaration of pistis::filesystem::File, a simple file representation.
  */
 
+#include <pistis/filesystem/BufferPolicy.hpp>
+#include <pistis/filesystem/ByteOrder.hpp>
+#include <pistis/filesystem/Delimited.hpp>
 #include <pistis/filesystem/FileAccessMode.hpp>
 #include <pistis/filesystem/FileCreationMode.hpp>
 #include <pistis/filesystem/FileOpenOptions.hpp>
 #include <pistis/filesystem/FileOrigin.hpp>
 #include <pistis/filesystem/FilePermissions.hpp>
+#include <pistis/filesystem/FileStatistics.hpp>
+#include <pistis/filesystem/HugePages.hpp>
+#include <pistis/filesystem/LineBlock.hpp>
+#include <pistis/filesystem/LineIndex.hpp>
+#include <pistis/filesystem/LineSpan.hpp>
 
 #include <memory>
+#include <string_view>
 #include <vector>
 
 #include <stdint.h>
@@ -25,31 +34,178 @@ namespace pistis {
     public:
       static const size_t INITIAL_BUFFER_SIZE = 1024;
       static const size_t MAX_BUFFER_SIZE = 128 * 1024 * 1024;
+
+      /** @brief Returned by tryRead(), tryWrite() and tryReadLine()
+       *         when the call would have had to wait.
+       */
+      static const size_t WOULD_BLOCK = (size_t)-1;
+
+      /** @brief Returned by firstDifference() when the files match */
+      static const uint64_t NO_DIFFERENCE = (uint64_t)-1;
+
+      /** @brief Smallest line buffer setHugePages() applies to */
+      static const size_t HUGE_PAGE_SIZE = hugepages::HUGE_PAGE_SIZE;
       
     public:
       File(int fd, size_t initialBufferSize = INITIAL_BUFFER_SIZE,
-	   size_t maxBufferSize = MAX_BUFFER_SIZE);
+	   size_t maxBufferSize = MAX_BUFFER_SIZE,
+	   BufferPolicy bufferPolicy = BufferPolicy::FIXED);
       File(int fd, const std::string& name,
 	   size_t initialBufferSize = INITIAL_BUFFER_SIZE,
-	   size_t maxBufferSize = MAX_BUFFER_SIZE);
+	   size_t maxBufferSize = MAX_BUFFER_SIZE,
+	   BufferPolicy bufferPolicy = BufferPolicy::FIXED);
       File(const File&) = delete;
-      File(File&& other) = default;
+      File(File&& other):
+	  fd_(other.fd_), name_(std::move(other.name_)),
+	  buffer_(std::move(other.buffer_)), stats_(other.stats_) {
+	other.fd_ = -1;
+      }
       ~File();
 
       int fd() const { return fd_; }
       const std::string& name() const { return name_; }
       size_t position() const;
+
+      /** @brief How the line buffer is sized */
+      BufferPolicy bufferPolicy() const { return buffer_.policy(); }
+
+      /** @brief Current size of the line buffer.  Zero until the first
+       *         call that reads through it.
+       */
+      size_t bufferSize() const { return buffer_.size(); }
+
+      /** @brief True if line buffers of HUGE_PAGE_SIZE or more are
+       *         allocated from memory backed by transparent huge pages
+       */
+      bool hugePages() const { return buffer_.hugePages(); }
+
+      /** @brief Allocate line buffers of HUGE_PAGE_SIZE or more from
+       *         memory backed by transparent huge pages.
+       *
+       *  A buffer that has grown to tens of megabytes for very long lines
+       *  spans thousands of 4 KB pages, and scanning it misses the TLB on
+       *  nearly every page.  With huge pages enabled, such buffers are
+       *  aligned to HUGE_PAGE_SIZE and advised with MADV_HUGEPAGE.  The
+       *  kernel may decline, so stats().hugePageBytes reports how much of
+       *  the current buffer it actually backed with huge pages.  Applies to buffers
+       *  allocated after the call; off by default.
+       */
+      void setHugePages(bool enable) { buffer_.setHugePages(enable); }
+
+      /** @brief Counters describing the I/O this file has performed */
+      const FileStatistics& stats() const;
+      void resetStats() { stats_ = FileStatistics(); }
       
+      /** @brief Whether the descriptor is in non-blocking mode */
+      bool nonBlocking() const;
+
+      /** @brief Turn non-blocking mode on or off.
+       *
+       *  Useful for descriptors that didn't come from open(), such as
+       *  pipes.  Files opened with FileOpenOptions::NON_BLOCKING start
+       *  in non-blocking mode.
+       *
+       *  Only tryRead(), tryWrite() and tryReadLine() report that a
+       *  non-blocking file isn't ready, by returning WOULD_BLOCK.  Every
+       *  other method, and every class that reads or writes a File for
+       *  its caller (BinaryWriter, ConcurrentFileWriter, ExternalSorter,
+       *  LineIndex and the rest), throws IOError when the file would
+       *  block.
+       */
+      void setNonBlocking(bool nonBlocking);
+
+      /** @brief Read up to n bytes.
+       *
+       *  Returns 0 at the end of the file.  Throws IOError if the file
+       *  is in non-blocking mode and no data is buffered or waiting to
+       *  be read.
+       */
       size_t read(void* buffer, size_t n);
+
+      /** @brief Read up to n bytes without waiting.
+       *
+       *  Like read(), but returns WOULD_BLOCK instead of throwing if no
+       *  data is buffered or waiting to be read.
+       */
+      size_t tryRead(void* buffer, size_t n);
+
+      /** @brief Write up to n bytes.
+       *
+       *  Throws IOError if the file is in non-blocking mode and nothing
+       *  could be written without waiting.
+       */
       size_t write(const void* buffer, size_t n);
+
+      /** @brief Write up to n bytes without waiting.
+       *
+       *  Like write(), but returns WOULD_BLOCK instead of throwing if
+       *  nothing could be written without waiting.
+       */
+      size_t tryWrite(const void* buffer, size_t n);
       size_t seek(ssize_t offset) { return seek(FileOrigin::HERE, offset); }
       size_t seek(FileOrigin origin, ssize_t offset);
       void truncate() { truncate(0); }
       void truncate(size_t size);
+
+      /** @brief Move up to n bytes from this file to the descriptor fd
+       *         without copying them through user space.
+       *
+       *  Data already read into this file's buffer is written to fd
+       *  first.  The rest moves with splice() when either side is a pipe,
+       *  with sendfile() when this is a regular file and fd is a socket,
+       *  and otherwise with splice() through a pipe kept for each thread.
+       *  If the kernel can't splice these descriptors, the data is
+       *  copied with read() and write() instead.  Both descriptors must
+       *  be blocking.  Returns the number of bytes moved, which is less
+       *  than n only if this file reached its end.
+       */
+      size_t spliceTo(int fd, size_t n);
+
+      /** @brief Move up to n bytes from the descriptor fd into this file
+       *         without copying them through user space.
+       *
+       *  Uses the same mechanisms as spliceTo().  Returns the number of
+       *  bytes moved, which is less than n only if fd reached its end.
+       */
+      size_t spliceFrom(int fd, size_t n);
+
+      /** @brief Copy up to n bytes from this file to fd without
+       *         consuming them.
+       *
+       *  Both this file and fd must be pipes.  Unlike spliceTo(), the
+       *  data stays in this file's pipe to be read again.  Returns the
+       *  number of bytes copied, which may be less than n if fewer are
+       *  waiting in the pipe.  Ignores data in this file's buffer.
+       */
+      size_t teeTo(int fd, size_t n);
       
       void close() noexcept;
 
-      std::string readLine();
+      std::string readLine() {
+	std::string line;
+	readLine(line);
+	return line;
+      }
+
+      /** @brief Read the next line into line, reusing its storage.
+       *
+       *  Returns false, leaving line empty, at the end of the file.
+       *  Reading into the same string repeatedly avoids allocating
+       *  memory for every line.
+       */
+      bool readLine(std::string& line);
+
+      /** @brief Read the next line without waiting for more data.
+       *
+       *  Meant for files in non-blocking mode, where readLine() would
+       *  throw.  Returns the length of the line, or 0 at the end of the
+       *  file.  If the next line hasn't fully arrived, returns
+       *  WOULD_BLOCK and keeps the part that has, so call again once the
+       *  file is readable.  A short read is not taken for the end of the
+       *  file, so this also suits blocking pipes.  Throws IOError if a
+       *  line won't fit in the maximum buffer size.
+       */
+      size_t tryReadLine(std::string& line);
 
       std::vector<std::string> readLines() {
 	std::vector<std::string> lines;
@@ -57,15 +213,287 @@ namespace pistis {
 	return std::move(lines);
       }
 
+      /** @brief Call f with each remaining row of a delimited file.
+       *
+       *  f is called as f(const DelimitedRow&).  Separators are found by
+       *  scanning the read buffer in bulk, and fields are handed back as
+       *  views into it, so rows cost no allocation.  If columns is not
+       *  empty, only those columns are returned, in that order, and
+       *  the others are never unquoted or copied.  Throws IOError if a
+       *  row won't fit in the maximum buffer size.
+       */
+      template <typename Function>
+      void eachRow(const DelimitedFormat& format,
+		   const std::vector<size_t>& columns, Function f) {
+	DelimitedScanner scanner(format, columns);
+	DelimitedRow row;
+	while (nextRow_(scanner, row)) {
+	  f((const DelimitedRow&)row);
+	}
+      }
+
+      template <typename Function>
+      void eachRow(const DelimitedFormat& format, Function f) {
+	eachRow(format, std::vector<size_t>(), f);
+      }
+
+      /** @brief Read the rest of the file into a LineBlock.
+       *
+       *  Takes far less memory than readLines() for files with many short
+       *  lines: one buffer for the text plus 4 bytes per line, instead of
+       *  a std::string per line.
+       */
+      LineBlock readLinesCompact();
+
+      /** @brief Read the next whitespace-separated integer.
+       *
+       *  The number is parsed straight out of the read buffer with
+       *  std::from_chars(), so no string is allocated and the locale
+       *  doesn't matter.  Returns false at the end of the file.  Throws
+       *  IOError if the next token isn't a decimal integer that fits in
+       *  an int64_t.  Can be mixed freely with readLine().
+       */
+      bool readInt64(int64_t& value);
+
+      /** @brief Read the next whitespace-separated floating-point number.
+       *
+       *  Like readInt64(), but accepts anything std::from_chars() parses
+       *  as a double, such as "-1.5e3", "inf" or "nan".
+       */
+      bool readDouble(double& value);
+
+      /** @brief Call f with each remaining whitespace-separated number.
+       *
+       *  T is int64_t or double.  Throws IOError at the first token that
+       *  isn't a number.
+       */
+      template <typename T = double, typename Function>
+      void eachNumber(Function f) {
+	T value;
+	while (readNumber_(value)) {
+	  f(value);
+	}
+      }
+
+      /** @brief Make sure the next n bytes are in the read buffer.
+       *
+       *  Returns false if the file ends first.  A decoder can call this
+       *  once for a fixed-size record and then read its fields with the
+       *  binary readers below, which then never leave the buffer.
+       *  Throws IOError if n is larger than the maximum buffer size.
+       */
+      bool ensureBuffered(size_t n) {
+	return (buffer_.remaining() >= n) || fillTo_(n);
+      }
+
+      /** @brief Read binary values stored in little- or big-endian byte
+       *         order.
+       *
+       *  These decode straight from the read buffer and only fill it when
+       *  it runs short, so a field costs a comparison and a load rather
+       *  than a read() call.  They throw IOError if the file ends in the
+       *  middle of the value.
+       */
+      uint8_t readU8() { return *take_(1); }
+      uint16_t readU16LE() { return byteorder::loadLE<uint16_t>(take_(2)); }
+      uint16_t readU16BE() { return byteorder::loadBE<uint16_t>(take_(2)); }
+      uint32_t readU32LE() { return byteorder::loadLE<uint32_t>(take_(4)); }
+      uint32_t readU32BE() { return byteorder::loadBE<uint32_t>(take_(4)); }
+      uint64_t readU64LE() { return byteorder::loadLE<uint64_t>(take_(8)); }
+      uint64_t readU64BE() { return byteorder::loadBE<uint64_t>(take_(8)); }
+      float readF32LE() { return byteorder::loadLE<float>(take_(4)); }
+      float readF32BE() { return byteorder::loadBE<float>(take_(4)); }
+      double readF64LE() { return byteorder::loadLE<double>(take_(8)); }
+      double readF64BE() { return byteorder::loadBE<double>(take_(8)); }
+
+      /** @brief Read an unsigned LEB128 varint of up to 64 bits.
+       *
+       *  Throws IOError if the varint is longer than 10 bytes or the file
+       *  ends in the middle of it.
+       */
+      uint64_t readVarint();
+
+      /** @brief Read a zigzag-encoded signed varint */
+      int64_t readSignedVarint() {
+	return byteorder::zigzagDecode(readVarint());
+      }
+
+      /** @brief Read exactly n bytes into data.
+       *
+       *  Unlike read(), throws IOError if the file ends first.  Bytes in
+       *  the read buffer are copied, and the rest read directly into
+       *  data.
+       */
+      void readBytes(void* data, size_t n);
+
+      /** @brief Compare the rest of this file with the rest of other.
+       *
+       *  Returns the offset, counted from each file's current position,
+       *  of the first byte that differs, or NO_DIFFERENCE if both files
+       *  hold the same data.  If one file is a prefix of the other, the
+       *  first difference is the end of the shorter one.  When both are
+       *  regular files, their sizes are compared first, so the longer
+       *  file is only read as far as the end of the shorter one.  The
+       *  data is read in large chunks and compared with memcmp(), and
+       *  both files are left somewhere past the difference.
+       */
+      uint64_t firstDifference(File& other);
+
+      /** @brief Parse one column of the remaining rows of a delimited
+       *         file as integers.
+       *
+       *  Fields are parsed in place, as eachRow() returns them, and may
+       *  be surrounded by spaces.  Throws IOError if a field, including
+       *  a missing one, isn't an integer.  Skip a header line by calling
+       *  readLine() first.
+       */
+      std::vector<int64_t> readInt64Column(const DelimitedFormat& format,
+					   size_t column);
+
+      /** @brief Parse one column of the remaining rows of a delimited
+       *         file as floating-point numbers.
+       */
+      std::vector<double> readDoubleColumn(const DelimitedFormat& format,
+					   size_t column);
+
       template <typename Function>
       void eachLine(Function f) {
-	std::string tmp = readLine();
-	while (!tmp.empty()) {
+	std::string tmp;
+	while (readLine(tmp)) {
 	  f(tmp);
-	  tmp = readLine();
 	}
       }
+
+      /** @brief Call f with batches of up to maxLines lines.
+       *
+       *  f is called as f(base, spans, n), where spans[0..n-1] give the
+       *  location of each line relative to base.  Each batch holds every
+       *  complete line in the read buffer (up to maxLines), so parsers
+       *  can loop over an array instead of taking one call per line.
+       *  The lines are not copied, so base is valid only until f
+       *  returns.  As with readLine(), lines include their trailing
+       *  newline, and the last line may not have one.
+       */
+      template <typename Function>
+      void eachLineBatch(size_t maxLines, Function f) {
+	std::vector<LineSpan> spans(maxLines ? maxLines : 1);
+	std::string longLine;
+	const uint8_t* base;
+	size_t n;
+	while ((n = nextLineBatch_(spans.data(), spans.size(), base,
+				   longLine)) != 0) {
+	  f(base, (const LineSpan*)spans.data(), n);
+	}
+      }
+
+      /** @brief Count the lines in the rest of the file.
+       *
+       *  Gives the number of lines readLine() would return, including a
+       *  last line without a newline, but builds none of them.  The
+       *  file is read in large chunks and the newlines in each are
+       *  counted sixteen bytes at a time.  Afterwards, the file is at
+       *  its end.
+       */
+      uint64_t countLines();
+
+      /** @brief Offsets of every occurrence of pattern in the rest of the
+       *         file.
+       *
+       *  Offsets count from the file's position when the search starts,
+       *  and matches don't overlap.  See eachMatch().
+       */
+      std::vector<uint64_t> findAll(std::string_view pattern);
+
+      /** @brief Call f(offset) for each occurrence of pattern in the rest
+       *         of the file.
+       *
+       *  The read buffer is searched in place, sixteen bytes at a time,
+       *  so no lines are built.  Matches that cross the end of the
+       *  buffer are found by keeping the last pattern.size() - 1 bytes
+       *  when it is refilled.  Offsets count from the file's position
+       *  when the search starts, and matches don't overlap.  An empty
+       *  pattern matches nothing.  Afterwards, the file is at its end.
+       *  Throws IOError if the pattern is longer than the maximum buffer
+       *  size.
+       */
+      template <typename Function>
+      void eachMatch(std::string_view pattern, Function f) {
+	if (pattern.empty()) {
+	  return;
+	}
+	uint64_t offset = 0;
+	uint64_t skipped;
+	while (seekMatch_(pattern, skipped)) {
+	  offset += skipped;
+	  f(offset);
+	  buffer_.skip(pattern.size());
+	  offset += pattern.size();
+	}
+      }
+
+      /** @brief Call f(offset, line) for each line in the rest of the
+       *         file that contains pattern.
+       *
+       *  offset is where the line starts, counting from the file's
+       *  position when the search starts, and line is a view into the
+       *  read buffer that is valid only until f returns.  As with
+       *  readLine(), lines include their trailing newline.  Lines are
+       *  found as eachLineBatch() finds them, and each batch is searched
+       *  as one block, so no lines are copied.  An empty pattern matches
+       *  nothing.
+       */
+      template <typename Function>
+      void eachMatchingLine(std::string_view pattern, Function f) {
+	if (pattern.empty()) {
+	  return;
+	}
+	std::vector<size_t> matching;
+	uint64_t offset = 0;
+	eachLineBatch(LINE_BATCH_SIZE_, [&](const uint8_t* base,
+					    const LineSpan* spans, size_t n) {
+	  findLines_(pattern, base, spans, n, matching);
+	  for (size_t i : matching) {
+	    f(offset + spans[i].offset,
+	      std::string_view((const char*)base + spans[i].offset,
+			       spans[i].length));
+	  }
+	  offset += spans[n - 1].offset + spans[n - 1].length;
+	});
+      }
       
+      /** @brief Position the file at the start of line n.
+       *
+       *  Seeks to the nearest line recorded in index and skips forward
+       *  to line n.  Lines appended after the index was last updated can
+       *  still be reached, but are found by scanning.  Returns false if
+       *  the file has fewer than n + 1 lines.
+       */
+      bool seekToLine(const LineIndex& index, uint64_t n);
+
+      /** @brief Read line n, counting from zero.
+       *
+       *  Like readLine(), the result includes the trailing newline.
+       *  Returns an empty string if the file has fewer than n + 1 lines.
+       */
+      std::string lineAt(const LineIndex& index, uint64_t n) {
+	return seekToLine(index, n) ? readLine() : std::string();
+      }
+
+      /** @brief Call f with each of lines [first, last) */
+      template <typename Function>
+      void eachLineInRange(const LineIndex& index, uint64_t first,
+			   uint64_t last, Function f) {
+	if ((first < last) && seekToLine(index, first)) {
+	  for (uint64_t n = first; n < last; ++n) {
+	    std::string tmp = readLine();
+	    if (tmp.empty()) {
+	      break;
+	    }
+	    f(tmp);
+	  }
+	}
+      }
+
       template <typename Function>
       void eachChunk(size_t n, Function f) {
 	std::unique_ptr<uint8_t[]> buffer(new uint8_t[n]);
@@ -92,6 +520,7 @@ namespace pistis {
 	  other.fd_ = -1;
 	  name_ = std::move(other.name_);
 	  buffer_ = std::move(other.buffer_);
+	  stats_ = other.stats_;
 	}
 	return *this;
       }
@@ -100,10 +529,11 @@ namespace pistis {
 		       FileAccessMode access = FileAccessMode::READ_WRITE,
 		       FileOpenOptions options = FileOpenOptions::NONE,
 		       size_t initialBufferSize = INITIAL_BUFFER_SIZE,
-		       size_t maxBufferSize = MAX_BUFFER_SIZE) {
+		       size_t maxBufferSize = MAX_BUFFER_SIZE,
+		       BufferPolicy bufferPolicy = BufferPolicy::FIXED) {
 	return File::open(name, FileCreationMode::CREATE_OR_OPEN, access,
 			  options, FilePermissions::ALL_RW,
-			  initialBufferSize, maxBufferSize);
+			  initialBufferSize, maxBufferSize, bufferPolicy);
       }
 
       static File open(const std::string& name, FileCreationMode creation,
@@ -111,48 +541,133 @@ namespace pistis {
 		       FileOpenOptions options = FileOpenOptions::NONE,
 		       FilePermissions permissions = FilePermissions::ALL_RW,
 		       size_t initialBufferSize = INITIAL_BUFFER_SIZE,
-		       size_t maxBufferSize = MAX_BUFFER_SIZE);
+		       size_t maxBufferSize = MAX_BUFFER_SIZE,
+		       BufferPolicy bufferPolicy = BufferPolicy::FIXED);
       static void unlink(const std::string& name);
 
     private:
       class Buffer {
       public:
-	Buffer(size_t initialSize, size_t maxSize);
+	Buffer(size_t initialSize, size_t maxSize, BufferPolicy policy);
 	Buffer(const Buffer&) = delete;
 	Buffer(Buffer&&) = default;
 
+	BufferPolicy policy() const {
+	  return adaptive_ ? BufferPolicy::ADAPTIVE : BufferPolicy::FIXED;
+	}
+	bool hugePages() const { return hugePages_; }
+	void setHugePages(bool enable) { hugePages_ = enable; }
+	size_t hugePageBytes() const;
 	uint8_t* data() const { return data_.get() + current_; }
 	uint8_t* end() const { return data_.get() + end_; }
 	size_t size() const { return size_; }
+	size_t maxSize() const { return maxSize_; }
 	size_t remaining() const { return end_ - current_; }
 
 	size_t fill(File* file);
+	size_t tryFill(File* file);
 	size_t doubleAndFill(File* file);
 	size_t empty(uint8_t* buffer, size_t n);
-	std::string nextLine(File* file);
+	void skip(size_t n) { current_ += n; }
+
+	/** @brief Record the length of a line the File returned */
+	void noteLine(size_t length) {
+	  if (adaptive_) {
+	    noteLine_(length);
+	  }
+	}
+
+	bool nextLine(File* file, std::string& line);
+	size_t tryNextLine(File* file, std::string& line);
+	size_t scanLines(LineSpan* spans, size_t maxLines);
+	bool skipLine(File* file);
 	void clear();
 
 	Buffer& operator=(const Buffer&) = delete;
 	Buffer& operator=(Buffer&&) = default;
 	
       private:
-	std::unique_ptr<uint8_t[]> data_;
+	// Frees memory from new[], or from hugepages::allocate() when
+	// mappedSize is nonzero
+	struct Deleter {
+	  size_t mappedSize;
+
+	  Deleter(): mappedSize(0) { }
+	  explicit Deleter(size_t n): mappedSize(n) { }
+	  void operator()(uint8_t* p) const;
+	};
+
+	typedef std::unique_ptr<uint8_t[], Deleter> Storage;
+
+	Storage data_;
+	bool hugePages_;
 	size_t initialSize_;
 	size_t maxSize_;
 	size_t size_;
 	size_t current_;
 	size_t end_;
 
-	void shift_();
+	// State for BufferPolicy::ADAPTIVE.  lineLengths_[i] counts recent
+	// lines whose length has i significant bits.  Every ADAPT_INTERVAL
+	// lines, targetSize_ is recomputed from the counts, which are then
+	// halved so older lines fade out.
+	bool adaptive_;
+	bool shrinkPending_;
+	uint32_t linesSinceUpdate_;
+	uint32_t growthsInLine_;
+	size_t targetSize_;
+	uint32_t lineLengths_[65];
+
+	Storage allocate_(File* file, size_t n);
+	void noteLine_(size_t length);
+	void updateTargetSize_();
+	void shrink_(File* file);
+	size_t shift_();
+	bool double_(File* file);
 	const uint8_t* findLineEnd_(const uint8_t* start);
       };
 	
     private:
+      // Lines eachMatchingLine() searches at a time
+      static const size_t LINE_BATCH_SIZE_ = 1024;
+
       int fd_;
       std::string name_;
       Buffer buffer_;
+      mutable FileStatistics stats_;
 
       size_t read_(uint8_t* buffer, size_t n);
+      size_t tryRead_(uint8_t* buffer, size_t n);
+      size_t readFully_(uint8_t* buffer, size_t n);
+      bool remainingSize_(uint64_t& size);
+      size_t nextLineBatch_(LineSpan* spans, size_t maxLines,
+			    const uint8_t*& base, std::string& longLine);
+      bool nextRow_(DelimitedScanner& scanner, DelimitedRow& row);
+      void scanRows_(DelimitedScanner& scanner);
+      void clearBuffer_();
+      bool nextToken_(const char*& begin, const char*& end);
+      bool fillTo_(size_t n);
+      bool seekMatch_(std::string_view pattern, uint64_t& skipped);
+      static void findLines_(std::string_view pattern, const uint8_t* base,
+			     const LineSpan* spans, size_t n,
+			     std::vector<size_t>& matching);
+      void throwUnexpectedEnd_() const;
+      const uint8_t* take_(size_t n) {
+	if ((buffer_.remaining() < n) && !fillTo_(n)) {
+	  throwUnexpectedEnd_();
+	}
+	const uint8_t* p = buffer_.data();
+	buffer_.skip(n);
+	return p;
+      }
+      bool readNumber_(int64_t& value) { return readInt64(value); }
+      bool readNumber_(double& value) { return readDouble(value); }
+      void noteLine_(size_t length) {
+	if (length > stats_.maxLineLength) {
+	  stats_.maxLineLength = length;
+	}
+	buffer_.noteLine(length);
+      }
       std::string createErrorMessage_(const std::string& action) const {
 	return createErrorMessage_(name_, action);
       }
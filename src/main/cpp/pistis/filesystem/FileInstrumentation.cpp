@@ -0,0 +1,117 @@
+#include "FileInstrumentation.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+using namespace pistis::filesystem;
+
+namespace {
+  typedef std::vector< std::pair<uint64_t, FileInstrumentation::TraceCallback> >
+      CallbackList;
+
+#ifdef PISTIS_FILESYSTEM_INSTRUMENTATION
+  static std::atomic<bool> recording(true);
+#else
+  static std::atomic<bool> recording(false);
+#endif
+
+  static LatencyHistogram histograms[FileOperation::COUNT];
+
+  // Readers take a snapshot of the callback list with std::atomic_load(),
+  // so registering a callback never blocks a timed operation.  Writers
+  // serialize on callbackMutex and publish a new list.
+  static std::shared_ptr<const CallbackList> callbacks;
+  static std::atomic<bool> haveCallbacks(false);
+  static std::mutex callbackMutex;
+  static uint64_t nextCallbackId = 1;
+}
+
+bool FileInstrumentation::compiledIn() {
+#ifdef PISTIS_FILESYSTEM_INSTRUMENTATION
+  return true;
+#else
+  return false;
+#endif
+}
+
+bool FileInstrumentation::enabled() {
+  return recording.load(std::memory_order_relaxed);
+}
+
+void FileInstrumentation::enable() {
+  recording.store(true, std::memory_order_relaxed);
+}
+
+void FileInstrumentation::disable() {
+  recording.store(false, std::memory_order_relaxed);
+}
+
+LatencyHistogram& FileInstrumentation::histogram(FileOperation op) {
+  return histograms[op.ordinal()];
+}
+
+void FileInstrumentation::resetHistograms() {
+  for (int i = 0; i < FileOperation::COUNT; ++i) {
+    histograms[i].reset();
+  }
+}
+
+uint64_t FileInstrumentation::addTraceCallback(
+    const TraceCallback& callback
+) {
+  std::lock_guard<std::mutex> lock(callbackMutex);
+  std::shared_ptr<const CallbackList> current = std::atomic_load(&callbacks);
+  std::shared_ptr<CallbackList> updated =
+      current ? std::make_shared<CallbackList>(*current)
+	      : std::make_shared<CallbackList>();
+  const uint64_t id = nextCallbackId++;
+
+  updated->push_back(std::make_pair(id, callback));
+  std::atomic_store(&callbacks,
+		    std::shared_ptr<const CallbackList>(std::move(updated)));
+  haveCallbacks.store(true, std::memory_order_release);
+  return id;
+}
+
+bool FileInstrumentation::removeTraceCallback(uint64_t id) {
+  std::lock_guard<std::mutex> lock(callbackMutex);
+  std::shared_ptr<const CallbackList> current = std::atomic_load(&callbacks);
+  if (!current) {
+    return false;
+  }
+
+  std::shared_ptr<CallbackList> updated =
+      std::make_shared<CallbackList>(*current);
+  auto i = std::find_if(
+      updated->begin(), updated->end(),
+      [id](const CallbackList::value_type& c) { return c.first == id; }
+  );
+  if (i == updated->end()) {
+    return false;
+  }
+
+  updated->erase(i);
+  haveCallbacks.store(!updated->empty(), std::memory_order_release);
+  std::atomic_store(&callbacks,
+		    std::shared_ptr<const CallbackList>(std::move(updated)));
+  return true;
+}
+
+void FileInstrumentation::record(FileOperation op,
+				 const std::string& fileName, size_t bytes,
+				 uint64_t nanoseconds) {
+  histograms[op.ordinal()].record(nanoseconds);
+  if (haveCallbacks.load(std::memory_order_acquire)) {
+    std::shared_ptr<const CallbackList> current =
+	std::atomic_load(&callbacks);
+    if (current) {
+      for (const auto& callback : *current) {
+	callback.second(op, fileName, bytes, nanoseconds);
+      }
+    }
+  }
+}
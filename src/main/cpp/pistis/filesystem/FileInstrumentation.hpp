@@ -0,0 +1,122 @@
+#ifndef __PISTIS__FILESYSTEM__FILEINSTRUMENTATION_HPP__
+#define __PISTIS__FILESYSTEM__FILEINSTRUMENTATION_HPP__
+
+/** @file FileInstrumentation.hpp
+ *
+ *  Latency histograms and trace callbacks for File operations.
+ *
+ *  Instrumentation is opt-in at build time: File only times its
+ *  operations when the library is compiled with
+ *  PISTIS_FILESYSTEM_INSTRUMENTATION defined (make INSTRUMENTATION=1).
+ *  Otherwise the timing code is compiled out of File entirely, and the
+ *  histograms below stay empty unless the application records into them
+ *  itself.
+ */
+
+#include <pistis/filesystem/FileOperation.hpp>
+#include <pistis/filesystem/LatencyHistogram.hpp>
+
+#include <functional>
+#include <string>
+
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+namespace pistis {
+  namespace filesystem {
+
+    /** @brief Process-wide latency histograms and trace callbacks for
+     *         File operations.
+     */
+    class FileInstrumentation {
+    public:
+      /** @brief Function called after each timed operation with the
+       *         operation, the name of the file, the number of bytes
+       *         transferred and the latency in nanoseconds.
+       *
+       *  Trace callbacks run on the thread that performed the operation
+       *  and must not throw.
+       */
+      typedef std::function<void (FileOperation, const std::string&, size_t,
+				  uint64_t)> TraceCallback;
+
+    public:
+      /** @brief True if the library was built with instrumentation */
+      static bool compiledIn();
+
+      /** @brief True if timed operations are currently recorded.
+       *
+       *  Recording is on by default when instrumentation is compiled in.
+       */
+      static bool enabled();
+      static void enable();
+      static void disable();
+
+      /** @brief Latency histogram for the given operation */
+      static LatencyHistogram& histogram(FileOperation op);
+
+      /** @brief Clear the histograms for all operations */
+      static void resetHistograms();
+
+      /** @brief Register a trace callback
+       *
+       *  @returns  An identifier that can be passed to
+       *            removeTraceCallback()
+       */
+      static uint64_t addTraceCallback(const TraceCallback& callback);
+
+      /** @brief Unregister a trace callback
+       *
+       *  @returns  True if a callback with the given id was registered
+       */
+      static bool removeTraceCallback(uint64_t id);
+
+      /** @brief Record an operation in its histogram and pass it to
+       *         the registered trace callbacks
+       */
+      static void record(FileOperation op, const std::string& fileName,
+			 size_t bytes, uint64_t nanoseconds);
+
+      /** @brief Current value of the monotonic clock, in nanoseconds */
+      static uint64_t now() {
+	struct timespec t;
+	::clock_gettime(CLOCK_MONOTONIC, &t);
+	return (uint64_t)t.tv_sec * 1000000000 + t.tv_nsec;
+      }
+    };
+
+    /** @brief Times an operation from construction to destruction and
+     *         records it with FileInstrumentation::record().
+     */
+    class FileOperationTimer {
+    public:
+      FileOperationTimer(FileOperation op, const std::string& fileName):
+	  op_(op), fileName_(fileName), bytes_(0),
+	  start_(FileInstrumentation::enabled() ? FileInstrumentation::now()
+						: 0) {
+      }
+      FileOperationTimer(const FileOperationTimer&) = delete;
+      ~FileOperationTimer() {
+	if (start_) {
+	  FileInstrumentation::record(op_, fileName_, bytes_,
+				      FileInstrumentation::now() - start_);
+	}
+      }
+
+      /** @brief Set the number of bytes the operation transferred */
+      void setBytes(size_t n) { bytes_ = n; }
+
+      FileOperationTimer& operator=(const FileOperationTimer&) = delete;
+
+    private:
+      FileOperation op_;
+      const std::string& fileName_;
+      size_t bytes_;
+      uint64_t start_;
+    };
+
+  }
+}
+
+#endif
@@ -9,7 +9,8 @@ using namespace pistis::filesystem;
 
 namespace {
   static const int ALL_BITS =
-      O_APPEND|O_CLOEXEC|O_NOATIME|O_NOFOLLOW|O_TRUNC|O_DSYNC|O_SYNC;
+      O_APPEND|O_CLOEXEC|O_NOATIME|O_NOFOLLOW|O_TRUNC|O_NONBLOCK|O_DSYNC|
+      O_SYNC;
 
   static const std::vector< std::tuple<int, std::string> >&
       optionToNameMap() {
@@ -22,6 +23,7 @@ namespace {
       std::tuple<int, std::string>{ O_NOFOLLOW,
 	                            std::string("DONT_FOLLOW_SYMLINKS") },
       std::tuple<int, std::string>{ O_TRUNC, std::string("TRUNCATE") },
+      std::tuple<int, std::string>{ O_NONBLOCK, std::string("NON_BLOCKING") },
       /* std::tuple<int, std::string>{
           (int)O_DYSNC, std::string("ENSURE_DATA_INTEGRITY") 
       } , */
@@ -40,6 +42,7 @@ const FileOpenOptions FileOpenOptions::CLOSE_ON_EXEC(O_CLOEXEC);
 const FileOpenOptions FileOpenOptions::DONT_UPDATE_LAST_ACCESS_TIME(O_NOATIME);
 const FileOpenOptions FileOpenOptions::DONT_FOLLOW_SYMLINKS(O_NOFOLLOW);
 const FileOpenOptions FileOpenOptions::TRUNCATE(O_TRUNC);
+const FileOpenOptions FileOpenOptions::NON_BLOCKING(O_NONBLOCK);
 /* const FileOpenOptions FileOpenOptions::ENSURE_DATA_INTEGRITY(O_DSYNC); */
 const FileOpenOptions FileOpenOptions::ENSURE_FILE_INTEGRITY(O_SYNC);
 
@@ -27,6 +27,12 @@ namespace pistis {
       /** @brief Truncate the file after opening */
       static const FileOpenOptions TRUNCATE;
 
+      /** @brief Open in non-blocking mode, where File::tryRead() and
+       *         File::tryWrite() return File::WOULD_BLOCK instead of
+       *         waiting for data or space
+       */
+      static const FileOpenOptions NON_BLOCKING;
+
       /** @brief Ensure data integrity by flushing data and any metadata
        *         needed to read that data back to the underlying hardware
        *         before any write operation returns.
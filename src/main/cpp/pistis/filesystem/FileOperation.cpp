@@ -0,0 +1,22 @@
+#include "FileOperation.hpp"
+
+using namespace pistis::filesystem;
+
+namespace {
+  static const std::string NAMES[]{
+    "OPEN", "READ", "WRITE", "SEEK", "TRUNCATE", "CLOSE"
+  };
+}
+
+const FileOperation FileOperation::OPEN(0);
+const FileOperation FileOperation::READ(1);
+const FileOperation FileOperation::WRITE(2);
+const FileOperation FileOperation::SEEK(3);
+const FileOperation FileOperation::TRUNCATE(4);
+const FileOperation FileOperation::CLOSE(5);
+
+const std::string& FileOperation::name() const { return NAMES[ordinal_]; }
+
+FileOperation FileOperation::fromOrdinal(int ordinal) {
+  return FileOperation(ordinal);
+}
@@ -0,0 +1,61 @@
+#ifndef __PISTIS__FILESYSTEM__FILEOPERATION_HPP__
+#define __PISTIS__FILESYSTEM__FILEOPERATION_HPP__
+
+#include <ostream>
+#include <string>
+
+namespace pistis {
+  namespace filesystem {
+
+    /** @brief Operations on a File that can be timed and traced */
+    class FileOperation {
+    public:
+      /** @brief File::open() */
+      static const FileOperation OPEN;
+
+      /** @brief A read() system call */
+      static const FileOperation READ;
+
+      /** @brief A write() system call */
+      static const FileOperation WRITE;
+
+      /** @brief File::seek() */
+      static const FileOperation SEEK;
+
+      /** @brief File::truncate() */
+      static const FileOperation TRUNCATE;
+
+      /** @brief File::close() */
+      static const FileOperation CLOSE;
+
+      /** @brief Number of distinct operations */
+      static const int COUNT = 6;
+
+    public:
+      int ordinal() const { return ordinal_; }
+      const std::string& name() const;
+
+      bool operator==(FileOperation other) const {
+	return ordinal_ == other.ordinal_;
+      }
+
+      bool operator!=(FileOperation other) const {
+	return ordinal_ != other.ordinal_;
+      }
+
+      /** @brief The operation with the given ordinal */
+      static FileOperation fromOrdinal(int ordinal);
+
+    private:
+      int ordinal_;
+
+      FileOperation(int o): ordinal_(o) { }
+    };
+
+    inline std::ostream& operator<<(std::ostream& out, FileOperation op) {
+      return out << op.name();
+    }
+
+  }
+}
+#endif
@@ -0,0 +1,148 @@
+#include "FileStatistics.hpp"
+
+#include <atomic>
+
+using namespace pistis::filesystem;
+
+namespace {
+  struct ProcessTotals {
+    std::atomic<uint64_t> readCalls;
+    std::atomic<uint64_t> writeCalls;
+    std::atomic<uint64_t> bytesRead;
+    std::atomic<uint64_t> bytesWritten;
+    std::atomic<uint64_t> bufferGrowths;
+    std::atomic<uint64_t> bufferShrinks;
+    std::atomic<uint64_t> bytesShifted;
+    std::atomic<uint64_t> bufferClears;
+    std::atomic<uint64_t> bytesDiscarded;
+    std::atomic<uint64_t> maxLineLength;
+    std::atomic<uint64_t> hugePageBuffers;
+    std::atomic<uint64_t> hugePageBytes;
+  };
+
+  static ProcessTotals totals{
+    {0}, {0}, {0}, {0}, {0}, {0}, {0}, {0}, {0}, {0}, {0}, {0}
+  };
+
+  inline void add(std::atomic<uint64_t>& total, uint64_t value) {
+    if (value) {
+      total.fetch_add(value, std::memory_order_relaxed);
+    }
+  }
+
+  inline void updateMax(std::atomic<uint64_t>& total, uint64_t value) {
+    uint64_t current = total.load(std::memory_order_relaxed);
+    while ((value > current) &&
+	   !total.compare_exchange_weak(current, value,
+					std::memory_order_relaxed)) {
+      // compare_exchange_weak() reloaded current; try again
+    }
+  }
+
+  inline uint64_t get(const std::atomic<uint64_t>& total) {
+    return total.load(std::memory_order_relaxed);
+  }
+}
+
+FileStatistics::FileStatistics():
+    readCalls(0), writeCalls(0), bytesRead(0), bytesWritten(0),
+    bufferGrowths(0), bufferShrinks(0), bytesShifted(0), bufferClears(0),
+    bytesDiscarded(0), maxLineLength(0), hugePageBuffers(0),
+    hugePageBytes(0) {
+}
+
+FileStatistics& FileStatistics::operator+=(const FileStatistics& other) {
+  readCalls += other.readCalls;
+  writeCalls += other.writeCalls;
+  bytesRead += other.bytesRead;
+  bytesWritten += other.bytesWritten;
+  bufferGrowths += other.bufferGrowths;
+  bufferShrinks += other.bufferShrinks;
+  bytesShifted += other.bytesShifted;
+  bufferClears += other.bufferClears;
+  bytesDiscarded += other.bytesDiscarded;
+  if (other.maxLineLength > maxLineLength) {
+    maxLineLength = other.maxLineLength;
+  }
+  hugePageBuffers += other.hugePageBuffers;
+  hugePageBytes += other.hugePageBytes;
+  return *this;
+}
+
+bool FileStatistics::operator==(const FileStatistics& other) const {
+  return (readCalls == other.readCalls) &&
+	 (writeCalls == other.writeCalls) &&
+	 (bytesRead == other.bytesRead) &&
+	 (bytesWritten == other.bytesWritten) &&
+	 (bufferGrowths == other.bufferGrowths) &&
+	 (bufferShrinks == other.bufferShrinks) &&
+	 (bytesShifted == other.bytesShifted) &&
+	 (bufferClears == other.bufferClears) &&
+	 (bytesDiscarded == other.bytesDiscarded) &&
+	 (maxLineLength == other.maxLineLength) &&
+	 (hugePageBuffers == other.hugePageBuffers) &&
+	 (hugePageBytes == other.hugePageBytes);
+}
+
+FileStatistics FileStatistics::processTotals() {
+  FileStatistics stats;
+  stats.readCalls = get(totals.readCalls);
+  stats.writeCalls = get(totals.writeCalls);
+  stats.bytesRead = get(totals.bytesRead);
+  stats.bytesWritten = get(totals.bytesWritten);
+  stats.bufferGrowths = get(totals.bufferGrowths);
+  stats.bufferShrinks = get(totals.bufferShrinks);
+  stats.bytesShifted = get(totals.bytesShifted);
+  stats.bufferClears = get(totals.bufferClears);
+  stats.bytesDiscarded = get(totals.bytesDiscarded);
+  stats.maxLineLength = get(totals.maxLineLength);
+  stats.hugePageBuffers = get(totals.hugePageBuffers);
+  stats.hugePageBytes = get(totals.hugePageBytes);
+  return stats;
+}
+
+void FileStatistics::addToProcessTotals(const FileStatistics& stats) {
+  add(totals.readCalls, stats.readCalls);
+  add(totals.writeCalls, stats.writeCalls);
+  add(totals.bytesRead, stats.bytesRead);
+  add(totals.bytesWritten, stats.bytesWritten);
+  add(totals.bufferGrowths, stats.bufferGrowths);
+  add(totals.bufferShrinks, stats.bufferShrinks);
+  add(totals.bytesShifted, stats.bytesShifted);
+  add(totals.bufferClears, stats.bufferClears);
+  add(totals.bytesDiscarded, stats.bytesDiscarded);
+  updateMax(totals.maxLineLength, stats.maxLineLength);
+  add(totals.hugePageBuffers, stats.hugePageBuffers);
+  add(totals.hugePageBytes, stats.hugePageBytes);
+}
+
+void FileStatistics::resetProcessTotals() {
+  totals.readCalls = 0;
+  totals.writeCalls = 0;
+  totals.bytesRead = 0;
+  totals.bytesWritten = 0;
+  totals.bufferGrowths = 0;
+  totals.bufferShrinks = 0;
+  totals.bytesShifted = 0;
+  totals.bufferClears = 0;
+  totals.bytesDiscarded = 0;
+  totals.maxLineLength = 0;
+  totals.hugePageBuffers = 0;
+  totals.hugePageBytes = 0;
+}
+
+std::ostream& pistis::filesystem::operator<<(std::ostream& out,
+					     const FileStatistics& stats) {
+  return out << "{ readCalls: " << stats.readCalls
+	     << ", writeCalls: " << stats.writeCalls
+	     << ", bytesRead: " << stats.bytesRead
+	     << ", bytesWritten: " << stats.bytesWritten
+	     << ", bufferGrowths: " << stats.bufferGrowths
+	     << ", bufferShrinks: " << stats.bufferShrinks
+	     << ", bytesShifted: " << stats.bytesShifted
+	     << ", bufferClears: " << stats.bufferClears
+	     << ", bytesDiscarded: " << stats.bytesDiscarded
+	     << ", maxLineLength: " << stats.maxLineLength
+	     << ", hugePageBuffers: " << stats.hugePageBuffers
+	     << ", hugePageBytes: " << stats.hugePageBytes << " }";
+}
@@ -0,0 +1,102 @@
+#ifndef __PISTIS__FILESYSTEM__FILESTATISTICS_HPP__
+#define __PISTIS__FILESYSTEM__FILESTATISTICS_HPP__
+
+/** @file FileStatistics.hpp
+ *
+ *  Declaration of pistis::filesystem::FileStatistics, counters that
+ *  describe the I/O a File has performed.
+ */
+
+#include <ostream>
+
+#include <stdint.h>
+
+namespace pistis {
+  namespace filesystem {
+
+    /** @brief Counters describing the I/O performed by a File
+     *
+     *  Each File keeps its own counters, which are plain integers and
+     *  cost an add per operation.  When a File is closed, its counters are
+     *  added to a process-wide total that can be read with processTotals().
+     */
+    class FileStatistics {
+    public:
+      /** @brief Number of read() system calls */
+      uint64_t readCalls;
+
+      /** @brief Number of write() system calls */
+      uint64_t writeCalls;
+
+      /** @brief Number of bytes returned by read() system calls */
+      uint64_t bytesRead;
+
+      /** @brief Number of bytes accepted by write() system calls */
+      uint64_t bytesWritten;
+
+      /** @brief Number of times the line buffer grew */
+      uint64_t bufferGrowths;
+
+      /** @brief Number of times an adaptive line buffer shrank */
+      uint64_t bufferShrinks;
+
+      /** @brief Number of bytes moved to the front of the line buffer
+       *         to make room for more data
+       */
+      uint64_t bytesShifted;
+
+      /** @brief Number of times write(), seek() or truncate() discarded
+       *         data in the line buffer
+       */
+      uint64_t bufferClears;
+
+      /** @brief Number of buffered bytes discarded by those clears */
+      uint64_t bytesDiscarded;
+
+      /** @brief Length of the longest line returned by readLine() */
+      uint64_t maxLineLength;
+
+      /** @brief Number of line buffers allocated from memory advised to
+       *         use huge pages
+       */
+      uint64_t hugePageBuffers;
+
+      /** @brief Number of bytes in the current line buffer the kernel
+       *         actually backed with huge pages, measured when
+       *         File::stats() is called
+       */
+      uint64_t hugePageBytes;
+
+    public:
+      FileStatistics();
+
+      /** @brief Add other's counters to this one's.
+       *
+       *  maxLineLength becomes the larger of the two.
+       */
+      FileStatistics& operator+=(const FileStatistics& other);
+
+      FileStatistics operator+(const FileStatistics& other) const {
+	return FileStatistics(*this) += other;
+      }
+
+      bool operator==(const FileStatistics& other) const;
+      bool operator!=(const FileStatistics& other) const {
+	return !(*this == other);
+      }
+
+      /** @brief Statistics summed over every File closed so far */
+      static FileStatistics processTotals();
+
+      /** @brief Add statistics to the process-wide totals */
+      static void addToProcessTotals(const FileStatistics& stats);
+
+      /** @brief Reset the process-wide totals to zero */
+      static void resetProcessTotals();
+    };
+
+    std::ostream& operator<<(std::ostream& out, const FileStatistics& stats);
+  }
+}
+
+#endif
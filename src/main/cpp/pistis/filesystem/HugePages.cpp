@@ -0,0 +1,96 @@
+#include "HugePages.hpp"
+
+#include <pistis/exceptions/IOError.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include <sys/mman.h>
+
+using namespace pistis::filesystem;
+using namespace pistis::exceptions;
+
+namespace {
+  size_t roundUp(size_t n) {
+    return (n + hugepages::HUGE_PAGE_SIZE - 1) &
+	   ~(hugepages::HUGE_PAGE_SIZE - 1);
+  }
+}
+
+uint8_t* hugepages::allocate(size_t n) {
+  const size_t size = roundUp(n);
+
+  // mmap() only promises page alignment, so map an extra huge page and
+  // trim the ends to a huge page boundary
+  const size_t mappedSize = size + HUGE_PAGE_SIZE;
+  void* mapped = ::mmap(nullptr, mappedSize, PROT_READ | PROT_WRITE,
+			MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (mapped == MAP_FAILED) {
+    throw IOError::fromSystemError(
+	"Error allocating " + std::to_string(size) + " bytes: #ERR#",
+	PISTIS_EX_HERE
+    );
+  }
+
+  const uintptr_t start = (uintptr_t)mapped;
+  const uintptr_t aligned = (start + HUGE_PAGE_SIZE - 1) &
+			    ~(uintptr_t)(HUGE_PAGE_SIZE - 1);
+  if (aligned > start) {
+    ::munmap(mapped, aligned - start);
+  }
+  const uintptr_t end = start + mappedSize;
+  if (end > aligned + size) {
+    ::munmap((void*)(aligned + size), end - aligned - size);
+  }
+
+  uint8_t* p = (uint8_t*)aligned;
+  if (advise(p, size)) {
+    for (size_t i = 0; i < size; i += HUGE_PAGE_SIZE) {
+      p[i] = 0;
+    }
+  }
+  return p;
+}
+
+void hugepages::release(uint8_t* p, size_t n) noexcept {
+  if (p) {
+    ::munmap(p, roundUp(n));
+  }
+}
+
+bool hugepages::advise(void* p, size_t n) noexcept {
+#ifdef MADV_HUGEPAGE
+  return !::madvise(p, n, MADV_HUGEPAGE);
+#else
+  return false;
+#endif
+}
+
+size_t hugepages::backedBytes(const void* p, size_t n) {
+  std::ifstream smaps("/proc/self/smaps");
+  const uintptr_t address = (uintptr_t)p;
+  bool inMapping = false;
+  std::string line;
+
+  while (std::getline(smaps, line)) {
+    const size_t dash = line.find('-');
+    if ((dash != std::string::npos) && (dash > 0) &&
+	(line.find(' ') > dash)) {
+      // The header line of a mapping: "start-end perms offset ..."
+      const uintptr_t start = std::stoull(line.substr(0, dash), nullptr, 16);
+      const uintptr_t end = std::stoull(line.substr(dash + 1), nullptr, 16);
+      inMapping = (start <= address) && (address < end);
+    } else if (inMapping && (!line.compare(0, 14, "AnonHugePages:") ||
+			     !line.compare(0, 15, "FilePmdMapped:"))) {
+      std::istringstream fields(line.substr(line.find(':') + 1));
+      size_t kb = 0;
+      fields >> kb;
+      if (kb) {
+	return std::min(kb * 1024, n);
+      }
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,52 @@
+#ifndef __PISTIS__FILESYSTEM__HUGEPAGES_HPP__
+#define __PISTIS__FILESYSTEM__HUGEPAGES_HPP__
+
+/** @file HugePages.hpp
+ *
+ *  Functions for backing large buffers and mappings with transparent
+ *  huge pages.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace pistis {
+  namespace filesystem {
+    namespace hugepages {
+
+      /** @brief Size of a transparent huge page on x86-64 */
+      static const size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+      /** @brief Allocate n bytes, rounded up to a multiple of
+       *         HUGE_PAGE_SIZE, from memory aligned to HUGE_PAGE_SIZE and
+       *         advised to use huge pages.
+       *
+       *  The memory is touched once per huge page, so whatever huge pages
+       *  the kernel can provide are in place when this returns.  Free it
+       *  with release().  Throws IOError if the memory can't be mapped.
+       */
+      uint8_t* allocate(size_t n);
+
+      /** @brief Free memory returned by allocate(n) */
+      void release(uint8_t* p, size_t n) noexcept;
+
+      /** @brief Ask the kernel to back [p, p + n) with huge pages.
+       *
+       *  Returns false if the kernel doesn't support huge pages for this
+       *  memory.  The kernel may still decline to use them.
+       */
+      bool advise(void* p, size_t n) noexcept;
+
+      /** @brief Number of bytes in [p, p + n) backed by huge pages.
+       *
+       *  Read from /proc/self/smaps, which reports this per mapping, so
+       *  the result is exact only when [p, p + n) is a whole mapping.
+       *  Returns 0 if the information isn't available.
+       */
+      size_t backedBytes(const void* p, size_t n);
+
+    }
+  }
+}
+
+#endif
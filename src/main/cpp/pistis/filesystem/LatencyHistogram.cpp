@@ -0,0 +1,90 @@
+#include "LatencyHistogram.hpp"
+
+using namespace pistis::filesystem;
+
+LatencyHistogram::LatencyHistogram():
+    count_(0), total_(0), max_(0) {
+  for (int i = 0; i < NUM_BUCKETS; ++i) {
+    buckets_[i].store(0, std::memory_order_relaxed);
+  }
+}
+
+double LatencyHistogram::mean() const {
+  const uint64_t n = count();
+  return n ? (double)total() / (double)n : 0.0;
+}
+
+uint64_t LatencyHistogram::percentile(double p) const {
+  const uint64_t n = count();
+  if (!n) {
+    return 0;
+  }
+
+  uint64_t target = (uint64_t)(p * n + 0.5);
+  if (target < 1) {
+    target = 1;
+  } else if (target > n) {
+    target = n;
+  }
+
+  uint64_t seen = 0;
+  for (int i = 0; i < NUM_BUCKETS; ++i) {
+    seen += bucketCount(i);
+    if (seen >= target) {
+      uint64_t upper = bucketUpperBound(i);
+      uint64_t largest = max();
+      return (upper < largest) ? upper : largest;
+    }
+  }
+  return max();
+}
+
+void LatencyHistogram::record(uint64_t value) {
+  buckets_[bucketFor(value)].fetch_add(1, std::memory_order_relaxed);
+  count_.fetch_add(1, std::memory_order_relaxed);
+  total_.fetch_add(value, std::memory_order_relaxed);
+
+  uint64_t current = max_.load(std::memory_order_relaxed);
+  while ((value > current) &&
+	 !max_.compare_exchange_weak(current, value,
+				     std::memory_order_relaxed)) {
+    // compare_exchange_weak() reloaded current; try again
+  }
+}
+
+void LatencyHistogram::reset() {
+  for (int i = 0; i < NUM_BUCKETS; ++i) {
+    buckets_[i].store(0, std::memory_order_relaxed);
+  }
+  count_.store(0, std::memory_order_relaxed);
+  total_.store(0, std::memory_order_relaxed);
+  max_.store(0, std::memory_order_relaxed);
+}
+
+int LatencyHistogram::bucketFor(uint64_t value) {
+  if (value < SUB_BUCKETS) {
+    return (int)value;
+  }
+
+  // Values in [2^e, 2^(e+1)) are split into SUB_BUCKETS buckets using the
+  // SUB_BUCKET_BITS bits that follow the leading one.
+  const int exponent = 63 - __builtin_clzll(value);
+  const int subBucket =
+      (int)((value >> (exponent - SUB_BUCKET_BITS)) & (SUB_BUCKETS - 1));
+  return (exponent - SUB_BUCKET_BITS + 1) * SUB_BUCKETS + subBucket;
+}
+
+uint64_t LatencyHistogram::bucketLowerBound(int bucket) {
+  if (bucket < SUB_BUCKETS) {
+    return bucket;
+  }
+
+  const int exponent = bucket / SUB_BUCKETS + SUB_BUCKET_BITS - 1;
+  const uint64_t subBucket = bucket % SUB_BUCKETS;
+  return (SUB_BUCKETS + subBucket) << (exponent - SUB_BUCKET_BITS);
+}
+
+uint64_t LatencyHistogram::bucketUpperBound(int bucket) {
+  return ((bucket + 1) < NUM_BUCKETS) ? bucketLowerBound(bucket + 1) - 1
+				      : UINT64_MAX;
+}
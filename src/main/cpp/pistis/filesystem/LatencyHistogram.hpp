@@ -0,0 +1,95 @@
+#ifndef __PISTIS__FILESYSTEM__LATENCYHISTOGRAM_HPP__
+#define __PISTIS__FILESYSTEM__LATENCYHISTOGRAM_HPP__
+
+/** @file LatencyHistogram.hpp
+ *
+ *  Declaration of pistis::filesystem::LatencyHistogram, a histogram of
+ *  latencies with logarithmically-sized buckets.
+ */
+
+#include <atomic>
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace pistis {
+  namespace filesystem {
+
+    /** @brief A histogram of latencies, in nanoseconds, with log-linear
+     *         buckets in the style of HdrHistogram.
+     *
+     *  Each power of two is divided into SUB_BUCKETS equal-width buckets,
+     *  so every recorded value is known to within 1/SUB_BUCKETS of its
+     *  true value, from one nanosecond up to 2^64 nanoseconds.  Recording
+     *  a value is a few relaxed atomic adds, so one histogram may be
+     *  shared by many threads.
+     */
+    class LatencyHistogram {
+    public:
+      static const int SUB_BUCKET_BITS = 4;
+      static const int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+      static const int NUM_BUCKETS = (64 - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+    public:
+      LatencyHistogram();
+      LatencyHistogram(const LatencyHistogram&) = delete;
+
+      /** @brief Number of values recorded */
+      uint64_t count() const {
+	return count_.load(std::memory_order_relaxed);
+      }
+
+      /** @brief Sum of all values recorded */
+      uint64_t total() const {
+	return total_.load(std::memory_order_relaxed);
+      }
+
+      /** @brief Largest value recorded */
+      uint64_t max() const { return max_.load(std::memory_order_relaxed); }
+
+      /** @brief Mean of all values recorded, or zero if there are none */
+      double mean() const;
+
+      /** @brief Number of values recorded in the given bucket */
+      uint64_t bucketCount(int bucket) const {
+	return buckets_[bucket].load(std::memory_order_relaxed);
+      }
+
+      /** @brief Estimate the value below which the given fraction of the
+       *         recorded values fall.
+       *
+       *  @param p  Fraction between 0 and 1, e.g. 0.99 for the 99th
+       *            percentile
+       *  @returns  The upper bound of the bucket containing the percentile,
+       *            or zero if no values have been recorded
+       */
+      uint64_t percentile(double p) const;
+
+      /** @brief Record one value */
+      void record(uint64_t value);
+
+      /** @brief Clear all recorded values */
+      void reset();
+
+      LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+      /** @brief Index of the bucket that holds the given value */
+      static int bucketFor(uint64_t value);
+
+      /** @brief Smallest value that falls into the given bucket */
+      static uint64_t bucketLowerBound(int bucket);
+
+      /** @brief Largest value that falls into the given bucket */
+      static uint64_t bucketUpperBound(int bucket);
+
+    private:
+      std::atomic<uint64_t> buckets_[NUM_BUCKETS];
+      std::atomic<uint64_t> count_;
+      std::atomic<uint64_t> total_;
+      std::atomic<uint64_t> max_;
+    };
+
+  }
+}
+
+#endif
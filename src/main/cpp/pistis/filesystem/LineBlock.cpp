@@ -0,0 +1,48 @@
+#include "LineBlock.hpp"
+
+using namespace pistis::filesystem;
+
+namespace {
+  static const uint64_t MAX_NARROW_OFFSET = UINT32_MAX;
+}
+
+LineBlock::LineBlock():
+    text_(), offsets_(1, 0), wideOffsets_() {
+}
+
+size_t LineBlock::memoryUsage() const {
+  return text_.capacity() + offsets_.capacity() * sizeof(uint32_t) +
+	 wideOffsets_.capacity() * sizeof(uint64_t);
+}
+
+void LineBlock::append(const char* text, size_t n) {
+  if (offsets_.empty() && wideOffsets_.empty()) {
+    // Moved from, so restore the offset of the first line
+    offsets_.push_back(0);
+  }
+  text_.insert(text_.end(), text, text + n);
+
+  const uint64_t end = text_.size();
+  if (wideOffsets_.empty() && (end > MAX_NARROW_OFFSET)) {
+    wideOffsets_.reserve(offsets_.size() + 1);
+    wideOffsets_.assign(offsets_.begin(), offsets_.end());
+    offsets_ = std::vector<uint32_t>();
+  }
+  if (wideOffsets_.empty()) {
+    offsets_.push_back((uint32_t)end);
+  } else {
+    wideOffsets_.push_back(end);
+  }
+}
+
+void LineBlock::shrinkToFit() {
+  text_.shrink_to_fit();
+  offsets_.shrink_to_fit();
+  wideOffsets_.shrink_to_fit();
+}
+
+void LineBlock::clear() {
+  text_.clear();
+  offsets_.assign(1, 0);
+  wideOffsets_.clear();
+}
@@ -0,0 +1,148 @@
+#ifndef __PISTIS__FILESYSTEM__LINEBLOCK_HPP__
+#define __PISTIS__FILESYSTEM__LINEBLOCK_HPP__
+
+/** @file LineBlock.hpp
+ *
+ *  Declaration of pistis::filesystem::LineBlock, a compact array of lines
+ *  stored back to back in one buffer.
+ */
+
+#include <iterator>
+#include <string_view>
+#include <vector>
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace pistis {
+  namespace filesystem {
+
+    /** @brief An array of lines stored in one contiguous buffer.
+     *
+     *  A std::vector<std::string> spends a heap allocation and about 32
+     *  bytes of overhead on every line.  A LineBlock stores the text of
+     *  all its lines back to back, plus the offset of each line, which
+     *  takes 4 bytes per line until the text passes 4 GB and 8 bytes
+     *  after that.  Lines are accessed as std::string_views into the
+     *  buffer, which stay valid until the block is changed or destroyed.
+     *
+     *  File::readLinesCompact() returns a LineBlock.  Like
+     *  File::readLine(), its lines include their trailing newline.
+     */
+    class LineBlock {
+    public:
+      class const_iterator {
+      public:
+	typedef std::random_access_iterator_tag iterator_category;
+	typedef std::string_view value_type;
+	typedef ptrdiff_t difference_type;
+	typedef const std::string_view* pointer;
+	typedef std::string_view reference;
+
+      public:
+	const_iterator(): block_(nullptr), i_(0) { }
+	const_iterator(const LineBlock* block, size_t i):
+	    block_(block), i_(i) {
+	}
+
+	std::string_view operator*() const { return (*block_)[i_]; }
+	std::string_view operator[](difference_type n) const {
+	  return (*block_)[i_ + n];
+	}
+
+	const_iterator& operator++() { ++i_; return *this; }
+	const_iterator operator++(int) { return const_iterator(block_, i_++); }
+	const_iterator& operator--() { --i_; return *this; }
+	const_iterator operator--(int) { return const_iterator(block_, i_--); }
+	const_iterator& operator+=(difference_type n) { i_ += n; return *this; }
+	const_iterator& operator-=(difference_type n) { i_ -= n; return *this; }
+
+	const_iterator operator+(difference_type n) const {
+	  return const_iterator(block_, i_ + n);
+	}
+	const_iterator operator-(difference_type n) const {
+	  return const_iterator(block_, i_ - n);
+	}
+	difference_type operator-(const_iterator other) const {
+	  return (difference_type)i_ - (difference_type)other.i_;
+	}
+
+	bool operator==(const_iterator other) const { return i_ == other.i_; }
+	bool operator!=(const_iterator other) const { return i_ != other.i_; }
+	bool operator<(const_iterator other) const { return i_ < other.i_; }
+	bool operator<=(const_iterator other) const { return i_ <= other.i_; }
+	bool operator>(const_iterator other) const { return i_ > other.i_; }
+	bool operator>=(const_iterator other) const { return i_ >= other.i_; }
+
+      private:
+	const LineBlock* block_;
+	size_t i_;
+      };
+
+      typedef const_iterator iterator;
+
+    public:
+      LineBlock();
+      LineBlock(const LineBlock&) = default;
+      LineBlock(LineBlock&&) = default;
+
+      /** @brief Number of lines */
+      size_t size() const {
+	// A block that has been moved from has no offsets at all
+	const size_t n = wideOffsets_.empty() ? offsets_.size()
+					      : wideOffsets_.size();
+	return n ? n - 1 : 0;
+      }
+
+      bool empty() const { return !size(); }
+
+      /** @brief Total length of all the lines */
+      size_t textSize() const { return text_.size(); }
+
+      /** @brief Bytes of memory held by the block, including unused
+       *         capacity
+       */
+      size_t memoryUsage() const;
+
+      /** @brief Line i.  Valid until the block is changed. */
+      std::string_view operator[](size_t i) const {
+	return std::string_view(text_.data() + start_(i),
+				start_(i + 1) - start_(i));
+      }
+
+      const_iterator begin() const { return const_iterator(this, 0); }
+      const_iterator end() const { return const_iterator(this, size()); }
+
+      /** @brief Add a line to the end of the block */
+      void append(const char* text, size_t n);
+      void append(std::string_view line) { append(line.data(), line.size()); }
+
+      /** @brief Make room for n more bytes of text without reallocating */
+      void reserveText(size_t n) { text_.reserve(text_.size() + n); }
+
+      /** @brief Release unused capacity */
+      void shrinkToFit();
+
+      void clear();
+
+      LineBlock& operator=(const LineBlock&) = default;
+      LineBlock& operator=(LineBlock&&) = default;
+
+    private:
+      std::vector<char> text_;
+
+      // Line i occupies text_[offsets[i], offsets[i + 1]).  The offsets are
+      // kept in offsets_ until the text grows past 4 GB, and then moved to
+      // wideOffsets_.
+      std::vector<uint32_t> offsets_;
+      std::vector<uint64_t> wideOffsets_;
+
+      size_t start_(size_t i) const {
+	return wideOffsets_.empty() ? offsets_[i] : wideOffsets_[i];
+      }
+    };
+
+  }
+}
+
+#endif
@@ -0,0 +1,207 @@
+#include "LineIndex.hpp"
+#include "File.hpp"
+#include "Path.hpp"
+
+#include <pistis/exceptions/IOError.hpp>
+
+#include <algorithm>
+#include <memory>
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+using namespace pistis::exceptions;
+using namespace pistis::filesystem;
+
+namespace {
+  static const char MAGIC[8] = { 'P', 'L', 'I', 'D', 'X', '0', '0', '1' };
+  static const size_t HEADER_SIZE = 48;
+  static const size_t SCAN_SIZE = 64 * 1024;
+
+  inline void putU64LE(std::vector<uint8_t>& out, uint64_t v) {
+    for (int i = 0; i < 8; ++i, v >>= 8) {
+      out.push_back((uint8_t)v);
+    }
+  }
+
+  inline uint64_t getU64LE(const uint8_t* p) {
+    uint64_t v = 0;
+    for (int i = 7; i >= 0; --i) {
+      v = (v << 8) | p[i];
+    }
+    return v;
+  }
+
+  uint64_t sizeOf(const File& file) {
+    struct stat statistics;
+    if (::fstat(file.fd(), &statistics) < 0) {
+      throw IOError::fromSystemError("Error reading size of " + file.name() +
+				     ": #ERR#", PISTIS_EX_HERE);
+    }
+    return statistics.st_size;
+  }
+
+  std::vector<uint8_t> readAll(const std::string& fileName) {
+    File file = File::open(fileName, FileCreationMode::OPEN_ONLY,
+			   FileAccessMode::READ_ONLY);
+    std::vector<uint8_t> data(sizeOf(file));
+    size_t n = 0;
+    while (n < data.size()) {
+      size_t nRead = file.read(data.data() + n, data.size() - n);
+      if (!nRead) {
+	break;
+      }
+      n += nRead;
+    }
+    data.resize(n);
+    return data;
+  }
+
+  void writeAll(File& file, const std::vector<uint8_t>& data) {
+    const uint8_t* p = data.data();
+    size_t n = data.size();
+    while (n) {
+      size_t nWritten = file.write(p, n);
+      p += nWritten;
+      n -= nWritten;
+    }
+  }
+}
+
+LineIndex::LineIndex(size_t interval):
+    interval_(interval ? interval : 1), lineCount_(0), lastLineStart_(0),
+    indexedSize_(0), offsets_(1, 0) {
+}
+
+uint64_t LineIndex::nearestOffset(uint64_t n, uint64_t& line) const {
+  const uint64_t k = std::min<uint64_t>(n / interval_, offsets_.size() - 1);
+  line = k * interval_;
+  return offsets_[k];
+}
+
+bool LineIndex::update(File& file) {
+  const uint64_t size = sizeOf(file);
+  bool changed = false;
+
+  if (size < indexedSize_) {
+    reset_();
+    changed = true;
+  }
+  if (size == indexedSize_) {
+    return changed;
+  }
+
+  std::unique_ptr<uint8_t[]> buffer(new uint8_t[SCAN_SIZE]);
+  size_t nRead;
+
+  file.seek(FileOrigin::START, indexedSize_);
+  while ((nRead = file.read(buffer.get(), SCAN_SIZE)) != 0) {
+    const uint8_t* const start = buffer.get();
+    const uint8_t* const end = start + nRead;
+    const uint8_t* p = start;
+    while ((p = (const uint8_t*)::memchr(p, '\n', end - p)) != nullptr) {
+      ++p;
+      ++lineCount_;
+      lastLineStart_ = indexedSize_ + (p - start);
+      if (!(lineCount_ % interval_)) {
+	offsets_.push_back(lastLineStart_);
+      }
+    }
+    indexedSize_ += nRead;
+  }
+  return true;
+}
+
+void LineIndex::save(const std::string& fileName) const {
+  const std::string tmpName = fileName + ".tmp";
+  std::vector<uint8_t> data(MAGIC, MAGIC + sizeof(MAGIC));
+
+  data.reserve(HEADER_SIZE + offsets_.size() * 8);
+  putU64LE(data, interval_);
+  putU64LE(data, lineCount_);
+  putU64LE(data, lastLineStart_);
+  putU64LE(data, indexedSize_);
+  putU64LE(data, offsets_.size());
+  for (uint64_t offset : offsets_) {
+    putU64LE(data, offset);
+  }
+
+  {
+    File file = File::open(tmpName, FileAccessMode::WRITE_ONLY,
+			   FileOpenOptions::TRUNCATE);
+    writeAll(file, data);
+  }
+  if (::rename(tmpName.c_str(), fileName.c_str()) < 0) {
+    throw IOError::fromSystemError("Error renaming " + tmpName + " to " +
+				   fileName + ": #ERR#", PISTIS_EX_HERE);
+  }
+}
+
+LineIndex LineIndex::build(File& file, size_t interval) {
+  LineIndex index(interval);
+  index.update(file);
+  return index;
+}
+
+LineIndex LineIndex::load(const std::string& fileName) {
+  const std::vector<uint8_t> data = readAll(fileName);
+  if ((data.size() < HEADER_SIZE) ||
+      ::memcmp(data.data(), MAGIC, sizeof(MAGIC))) {
+    throw IOError(fileName + " is not a line index", PISTIS_EX_HERE);
+  }
+
+  LineIndex index(getU64LE(&data[8]));
+  const uint64_t numOffsets = getU64LE(&data[40]);
+  index.lineCount_ = getU64LE(&data[16]);
+  index.lastLineStart_ = getU64LE(&data[24]);
+  index.indexedSize_ = getU64LE(&data[32]);
+  // Check numOffsets against the file size before multiplying, so a
+  // corrupt count cannot wrap around
+  if ((index.interval_ != getU64LE(&data[8])) || !numOffsets ||
+      (numOffsets > (data.size() - HEADER_SIZE) / 8) ||
+      (data.size() != HEADER_SIZE + numOffsets * 8) ||
+      (numOffsets != (index.lineCount_ / index.interval_) + 1)) {
+    throw IOError("Line index " + fileName + " is corrupt", PISTIS_EX_HERE);
+  }
+
+  index.offsets_.clear();
+  index.offsets_.reserve(numOffsets);
+  for (size_t i = HEADER_SIZE; i < data.size(); i += 8) {
+    index.offsets_.push_back(getU64LE(&data[i]));
+  }
+  return index;
+}
+
+LineIndex LineIndex::forFile(const std::string& fileName, size_t interval) {
+  const std::string indexName = indexFileFor(fileName);
+  File file = File::open(fileName, FileCreationMode::OPEN_ONLY,
+			 FileAccessMode::READ_ONLY);
+  LineIndex index(interval);
+  bool loaded = false;
+
+  if (path::exists(indexName)) {
+    try {
+      index = load(indexName);
+      loaded = index.interval() == interval;
+    } catch(const IOError&) {
+      // Fall through and rebuild the index
+    }
+    if (!loaded) {
+      index = LineIndex(interval);
+    }
+  }
+
+  if (index.update(file) || !loaded) {
+    index.save(indexName);
+  }
+  return index;
+}
+
+void LineIndex::reset_() {
+  lineCount_ = 0;
+  lastLineStart_ = 0;
+  indexedSize_ = 0;
+  offsets_.assign(1, 0);
+}
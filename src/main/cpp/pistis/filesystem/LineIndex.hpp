@@ -0,0 +1,115 @@
+#ifndef __PISTIS__FILESYSTEM__LINEINDEX_HPP__
+#define __PISTIS__FILESYSTEM__LINEINDEX_HPP__
+
+/** @file LineIndex.hpp
+ *
+ *  Declaration of pistis::filesystem::LineIndex, a sparse index of the
+ *  byte offsets of the lines in a text file.
+ */
+
+#include <string>
+#include <vector>
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace pistis {
+  namespace filesystem {
+
+    class File;
+
+    /** @brief A sparse index of line offsets in a text file.
+     *
+     *  The index records the byte offset of every interval()-th line, so
+     *  File::lineAt() and File::eachLineInRange() can seek to the nearest
+     *  indexed line and read forward at most interval() - 1 lines instead
+     *  of scanning from the start of the file.  Lines are numbered from
+     *  zero, and a final line without a trailing newline counts as a line.
+     *
+     *  The index is kept in a sidecar file next to the text file (see
+     *  indexFileFor()).  It assumes the text file is only ever appended
+     *  to: update() scans just the bytes added since the index was last
+     *  updated, and the index is rebuilt from scratch if the file has
+     *  shrunk.
+     */
+    class LineIndex {
+    public:
+      static const size_t DEFAULT_INTERVAL = 1024;
+
+    public:
+      LineIndex(size_t interval = DEFAULT_INTERVAL);
+
+      /** @brief Number of lines between indexed offsets */
+      size_t interval() const { return interval_; }
+
+      /** @brief Number of lines in the indexed part of the file */
+      uint64_t lineCount() const {
+	return lineCount_ + (indexedSize_ > lastLineStart_ ? 1 : 0);
+      }
+
+      /** @brief Number of bytes of the file the index covers */
+      uint64_t indexedSize() const { return indexedSize_; }
+
+      /** @brief Find the indexed line at or before line n.
+       *
+       *  Returns the byte offset of that line and stores its number in
+       *  line.
+       */
+      uint64_t nearestOffset(uint64_t n, uint64_t& line) const;
+
+      /** @brief Add the lines appended to file since the index was last
+       *         updated.
+       *
+       *  If the file is now shorter than indexedSize(), it has been
+       *  rewritten and the index is rebuilt from the start.  Returns
+       *  true if the index changed.  The file's position is left
+       *  unspecified.
+       */
+      bool update(File& file);
+
+      /** @brief Write the index to the named file.
+       *
+       *  The index is written to a temporary file that is then renamed
+       *  over fileName, so readers never see a partially-written index.
+       */
+      void save(const std::string& fileName) const;
+
+      /** @brief Index the whole of file */
+      static LineIndex build(File& file, size_t interval = DEFAULT_INTERVAL);
+
+      /** @brief Read an index written by save().
+       *
+       *  Throws IOError if the file cannot be read or is not a line index.
+       */
+      static LineIndex load(const std::string& fileName);
+
+      /** @brief Load the sidecar index for the named text file, bring it
+       *         up to date and save it if it changed.
+       *
+       *  Builds a new index if there is no sidecar, if it can't be read,
+       *  or if it was built with a different interval.
+       */
+      static LineIndex forFile(const std::string& fileName,
+			       size_t interval = DEFAULT_INTERVAL);
+
+      /** @brief Name of the sidecar file that holds the index for the
+       *         named text file.
+       */
+      static std::string indexFileFor(const std::string& fileName) {
+	return fileName + ".lidx";
+      }
+
+    private:
+      size_t interval_;
+      uint64_t lineCount_;       // Number of newlines seen
+      uint64_t lastLineStart_;   // Offset just past the last newline
+      uint64_t indexedSize_;
+      std::vector<uint64_t> offsets_;  // Offset of line k * interval_
+
+      void reset_();
+    };
+
+  }
+}
+
+#endif
@@ -0,0 +1,29 @@
+#ifndef __PISTIS__FILESYSTEM__LINESPAN_HPP__
+#define __PISTIS__FILESYSTEM__LINESPAN_HPP__
+
+/** @file LineSpan.hpp
+ *
+ *  Declaration of pistis::filesystem::LineSpan, the location of one line
+ *  in a block of text.
+ */
+
+#include <stddef.h>
+
+namespace pistis {
+  namespace filesystem {
+
+    /** @brief Where a line starts in a block of text, and how long it is.
+     *
+     *  The offset is relative to the start of the block, so an array of
+     *  spans describes many lines without copying them.  The length
+     *  includes the line's trailing newline, if it has one.
+     */
+    struct LineSpan {
+      size_t offset;
+      size_t length;
+    };
+
+  }
+}
+
+#endif
@@ -0,0 +1,153 @@
+#include "MappedWriter.hpp"
+#include "HugePages.hpp"
+
+#include <pistis/exceptions/IOError.hpp>
+
+#include <algorithm>
+#include <sstream>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+using namespace pistis::exceptions;
+using namespace pistis::filesystem;
+
+namespace {
+  size_t roundToPageSize(size_t n) {
+    static const size_t PAGE_SIZE = (size_t)::sysconf(_SC_PAGESIZE);
+    return ((n + PAGE_SIZE - 1) / PAGE_SIZE) * PAGE_SIZE;
+  }
+}
+
+const size_t MappedWriter::DEFAULT_INITIAL_CAPACITY;
+
+MappedWriter::MappedWriter(File&& file, size_t initialCapacity):
+    file_(std::move(file)), data_(nullptr), size_(0), capacity_(0),
+    initialCapacity_(roundToPageSize(std::max<size_t>(initialCapacity, 1))),
+    hugePages_(false) {
+  file_.truncate(0);
+}
+
+MappedWriter::MappedWriter(MappedWriter&& other):
+    file_(std::move(other.file_)), data_(other.data_), size_(other.size_),
+    capacity_(other.capacity_), initialCapacity_(other.initialCapacity_),
+    hugePages_(other.hugePages_) {
+  other.data_ = nullptr;
+  other.size_ = 0;
+  other.capacity_ = 0;
+}
+
+MappedWriter::~MappedWriter() {
+  try {
+    close();
+  } catch(...) {
+    // Call close() explicitly to see errors
+  }
+}
+
+size_t MappedWriter::hugePageBytes() const {
+  return data_ ? hugepages::backedBytes(data_, capacity_) : 0;
+}
+
+void MappedWriter::write(const void* data, size_t n) {
+  if (n) {
+    ::memcpy(reserve(n), data, n);
+    commit(n);
+  }
+}
+
+void MappedWriter::sync() {
+  if (data_ && size_ && (::msync(data_, size_, MS_SYNC) < 0)) {
+    throw IOError::fromSystemError("Error syncing " + name() + ": #ERR#",
+				   PISTIS_EX_HERE);
+  }
+}
+
+void MappedWriter::close() {
+  if (file_.fd() >= 0) {
+    unmap_();
+    file_.truncate(size_);
+    file_.close();
+  }
+}
+
+MappedWriter& MappedWriter::operator=(MappedWriter&& other) {
+  if (this != &other) {
+    close();
+    file_ = std::move(other.file_);
+    data_ = other.data_;
+    size_ = other.size_;
+    capacity_ = other.capacity_;
+    initialCapacity_ = other.initialCapacity_;
+    hugePages_ = other.hugePages_;
+    other.data_ = nullptr;
+    other.size_ = 0;
+    other.capacity_ = 0;
+  }
+  return *this;
+}
+
+MappedWriter MappedWriter::open(const std::string& name,
+				size_t initialCapacity,
+				FilePermissions permissions) {
+  return MappedWriter(File::open(name, FileCreationMode::CREATE_OR_OPEN,
+				 FileAccessMode::READ_WRITE,
+				 FileOpenOptions::TRUNCATE, permissions),
+		      initialCapacity);
+}
+
+void MappedWriter::commitTooLarge_(size_t n) const {
+  std::ostringstream msg;
+  msg << "Cannot commit " << n << " bytes to " << name() << ": only "
+      << (capacity_ - size_) << " bytes were reserved";
+  throw IOError(msg.str(), PISTIS_EX_HERE);
+}
+
+void MappedWriter::grow_(size_t needed) {
+  const size_t newCapacity = roundToPageSize(
+      std::max(std::max(capacity_ * 2, initialCapacity_), needed)
+  );
+  void* p;
+
+  extendFile_(newCapacity);
+  if (data_) {
+    p = ::mremap(data_, capacity_, newCapacity, MREMAP_MAYMOVE);
+  } else {
+    p = ::mmap(nullptr, newCapacity, PROT_READ | PROT_WRITE, MAP_SHARED,
+	       file_.fd(), 0);
+  }
+  if (p == MAP_FAILED) {
+    throw IOError::fromSystemError("Error mapping " + name() + ": #ERR#",
+				   PISTIS_EX_HERE);
+  }
+  data_ = (uint8_t*)p;
+  capacity_ = newCapacity;
+  if (hugePages_ && (capacity_ >= hugepages::HUGE_PAGE_SIZE)) {
+    hugepages::advise(data_, capacity_);
+  }
+}
+
+void MappedWriter::extendFile_(size_t newCapacity) {
+  // Allocating the blocks up front means running out of space shows up
+  // here as an error instead of later as a SIGBUS when the mapping is
+  // written.
+  int result = ::fallocate(file_.fd(), 0, capacity_, newCapacity - capacity_);
+  if ((result < 0) && ((errno == EOPNOTSUPP) || (errno == ENOSYS))) {
+    result = ::ftruncate(file_.fd(), newCapacity);
+  }
+  if (result < 0) {
+    throw IOError::fromSystemError("Error extending " + name() + ": #ERR#",
+				   PISTIS_EX_HERE);
+  }
+}
+
+void MappedWriter::unmap_() noexcept {
+  if (data_) {
+    ::munmap(data_, capacity_);
+    data_ = nullptr;
+    capacity_ = 0;
+  }
+}
@@ -0,0 +1,141 @@
+#ifndef __PISTIS__FILESYSTEM__MAPPEDWRITER_HPP__
+#define __PISTIS__FILESYSTEM__MAPPEDWRITER_HPP__
+
+/** @file MappedWriter.hpp
+ *
+ *  Declaration of pistis::filesystem::MappedWriter, which writes a file
+ *  through a memory mapping that grows as needed.
+ */
+
+#include <pistis/filesystem/File.hpp>
+
+#include <string>
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace pistis {
+  namespace filesystem {
+
+    /** @brief Writes a file by storing directly into a shared memory
+     *         mapping of it.
+     *
+     *  Callers reserve() space, fill it in place and commit() the bytes
+     *  they wrote, so serializers can build their output in the mapping
+     *  instead of in a separate buffer that is then copied with
+     *  File::write().  When a reservation doesn't fit, the file is
+     *  extended with fallocate() (or ftruncate() on filesystems that
+     *  don't support it) and the mapping grown with mremap(), at least
+     *  doubling its capacity each time.  Growing may move the mapping, so
+     *  pointers returned by reserve() and data() are valid only until the
+     *  next call to reserve() or write().
+     *
+     *  close() unmaps the file and truncates it to size(), the number of
+     *  bytes committed.  The destructor calls close() but ignores errors,
+     *  so call close() explicitly to find out whether the data was
+     *  written.
+     */
+    class MappedWriter {
+    public:
+      static const size_t DEFAULT_INITIAL_CAPACITY = 1024 * 1024;
+
+    public:
+      /** @brief Write to file, replacing its contents.
+       *
+       *  The file must be open for reading and writing.
+       */
+      MappedWriter(File&& file,
+		   size_t initialCapacity = DEFAULT_INITIAL_CAPACITY);
+      MappedWriter(const MappedWriter&) = delete;
+      MappedWriter(MappedWriter&& other);
+      ~MappedWriter();
+
+      const std::string& name() const { return file_.name(); }
+
+      /** @brief Number of bytes committed */
+      size_t size() const { return size_; }
+
+      /** @brief Number of bytes the mapping can hold before it grows */
+      size_t capacity() const { return capacity_; }
+
+      /** @brief True if mappings of HUGE_PAGE_SIZE or more are advised
+       *         to use transparent huge pages
+       */
+      bool hugePages() const { return hugePages_; }
+
+      /** @brief Advise mappings of HUGE_PAGE_SIZE or more to use
+       *         transparent huge pages.
+       *
+       *  Takes effect the next time the mapping grows.  Huge pages for
+       *  shared file mappings depend on the filesystem (tmpfs mounted
+       *  with huge=advise supports them, for instance), so use
+       *  hugePageBytes() to see whether the kernel provided any.
+       */
+      void setHugePages(bool enable) { hugePages_ = enable; }
+
+      /** @brief Number of bytes of the mapping backed by huge pages */
+      size_t hugePageBytes() const;
+
+      /** @brief Start of the mapping.  Null until the first reserve(). */
+      uint8_t* data() const { return data_; }
+
+      /** @brief Make room for n more bytes and return where they start.
+       *
+       *  The bytes are not part of the file until they are committed.
+       */
+      uint8_t* reserve(size_t n) {
+	if (capacity_ - size_ < n) {
+	  grow_(size_ + n);
+	}
+	return data_ + size_;
+      }
+
+      /** @brief Add n bytes written at the address returned by the
+       *         last call to reserve() to the file.
+       *
+       *  @throws IOError if n is more than the mapping has room for
+       */
+      void commit(size_t n) {
+	if (n > capacity_ - size_) {
+	  commitTooLarge_(n);
+	}
+	size_ += n;
+      }
+
+      /** @brief Copy n bytes into the file */
+      void write(const void* data, size_t n);
+
+      /** @brief Write committed data to the device with msync() */
+      void sync();
+
+      /** @brief Unmap the file, truncate it to size() and close it */
+      void close();
+
+      MappedWriter& operator=(const MappedWriter&) = delete;
+      MappedWriter& operator=(MappedWriter&& other);
+
+      /** @brief Create or replace the named file and write to it */
+      static MappedWriter open(
+	  const std::string& name,
+	  size_t initialCapacity = DEFAULT_INITIAL_CAPACITY,
+	  FilePermissions permissions = FilePermissions::ALL_RW
+      );
+
+    private:
+      File file_;
+      uint8_t* data_;
+      size_t size_;
+      size_t capacity_;
+      size_t initialCapacity_;
+      bool hugePages_;
+
+      void commitTooLarge_(size_t n) const;
+      void grow_(size_t needed);
+      void extendFile_(size_t newCapacity);
+      void unmap_() noexcept;
+    };
+
+  }
+}
+
+#endif
@@ -0,0 +1,102 @@
+#include "MergeReader.hpp"
+
+#include <algorithm>
+
+using namespace pistis::filesystem;
+
+const size_t MergeReader::DEFAULT_BUFFER_BUDGET;
+const size_t MergeReader::MIN_BUFFER_SIZE;
+const size_t MergeReader::MAX_BUFFER_SIZE;
+
+MergeReader::MergeReader(const std::vector<std::string>& fileNames,
+			 Comparator compare, size_t bufferBudget):
+    files_(), compare_(compare), lines_(), exhausted_(), tree_(),
+    started_(false) {
+  const size_t bufferSize = bufferSizeFor(fileNames.size(), bufferBudget);
+  files_.reserve(fileNames.size());
+  for (const std::string& name : fileNames) {
+    files_.push_back(File::open(name, FileCreationMode::OPEN_ONLY,
+				FileAccessMode::READ_ONLY,
+				FileOpenOptions::NONE, FilePermissions::ALL_RW,
+				bufferSize));
+  }
+  initialize_();
+}
+
+MergeReader::MergeReader(std::vector<File>&& files, Comparator compare):
+    files_(std::move(files)), compare_(compare), lines_(), exhausted_(),
+    tree_(), started_(false) {
+  initialize_();
+}
+
+bool MergeReader::next() {
+  if (files_.empty()) {
+    return false;
+  }
+  if (started_) {
+    const size_t winner = tree_[0];
+    read_(winner);
+    adjust_(winner);
+  } else {
+    started_ = true;
+  }
+  return !exhausted_[tree_[0]];
+}
+
+size_t MergeReader::bufferSizeFor(size_t n, size_t bufferBudget) {
+  const size_t share = bufferBudget / std::max<size_t>(n, 1);
+  return std::max(MIN_BUFFER_SIZE, std::min(share, MAX_BUFFER_SIZE));
+}
+
+void MergeReader::initialize_() {
+  const size_t n = files_.size();
+
+  lines_.resize(n);
+  exhausted_.assign(n, false);
+  for (size_t i = 0; i < n; ++i) {
+    read_(i);
+  }
+
+  // Start with every internal node holding the sentinel n, which
+  // precedes every file.  Each leaf added displaces one sentinel, so once
+  // all the leaves have been added the tree holds only real files.
+  tree_.assign(std::max<size_t>(n, 1), n);
+  for (size_t i = n; i > 0; --i) {
+    adjust_(i - 1);
+  }
+}
+
+void MergeReader::read_(size_t i) {
+  exhausted_[i] = !files_[i].readLine(lines_[i]);
+}
+
+void MergeReader::adjust_(size_t i) {
+  // Play file i's new line against the losers on the path from its leaf
+  // to the root.  The winner of each match moves up.
+  for (size_t node = (i + files_.size()) / 2; node > 0; node /= 2) {
+    if (precedes_(tree_[node], i)) {
+      std::swap(tree_[node], i);
+    }
+  }
+  tree_[0] = i;
+}
+
+bool MergeReader::precedes_(size_t i, size_t j) const {
+  const size_t n = files_.size();
+  if (i == n) {
+    return true;
+  } else if (j == n) {
+    return false;
+  } else if (exhausted_[i]) {
+    return false;
+  } else if (exhausted_[j]) {
+    return true;
+  } else if (compare_(lines_[i], lines_[j])) {
+    return true;
+  } else if (compare_(lines_[j], lines_[i])) {
+    return false;
+  } else {
+    // Equal lines come out in file order
+    return i < j;
+  }
+}
@@ -0,0 +1,120 @@
+#ifndef __PISTIS__FILESYSTEM__MERGEREADER_HPP__
+#define __PISTIS__FILESYSTEM__MERGEREADER_HPP__
+
+/** @file MergeReader.hpp
+ *
+ *  Declaration of pistis::filesystem::MergeReader, which merges the lines
+ *  of several sorted files into one sorted stream.
+ */
+
+#include <pistis/filesystem/File.hpp>
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <stddef.h>
+
+namespace pistis {
+  namespace filesystem {
+
+    /** @brief Reads the lines of several sorted files in merged order.
+     *
+     *  The merge uses a loser tree, so producing each line costs about
+     *  log2(N) comparisons for N files.  Each file's current line is
+     *  read into a string that is reused for the next line, so the merge
+     *  doesn't allocate memory for every line.  Lines that compare equal
+     *  are produced in the order of the files they came from, which
+     *  makes the merge stable.
+     *
+     *  Like File::readLine(), lines include their trailing newline, and
+     *  the last line of a file may not have one.
+     */
+    class MergeReader {
+    public:
+      typedef std::function<bool (const std::string&, const std::string&)>
+	  Comparator;
+
+      static const size_t DEFAULT_BUFFER_BUDGET = 64 * 1024 * 1024;
+      static const size_t MIN_BUFFER_SIZE = 4096;
+      static const size_t MAX_BUFFER_SIZE = 4 * 1024 * 1024;
+
+    public:
+      /** @brief Merge the named files.
+       *
+       *  The files share bufferBudget bytes of read buffer equally (see
+       *  bufferSizeFor()).
+       */
+      MergeReader(const std::vector<std::string>& fileNames,
+		  Comparator compare = std::less<std::string>(),
+		  size_t bufferBudget = DEFAULT_BUFFER_BUDGET);
+
+      /** @brief Merge files that are already open.  Their buffer sizes
+       *         are left as they are.
+       */
+      MergeReader(std::vector<File>&& files,
+		  Comparator compare = std::less<std::string>());
+
+      MergeReader(const MergeReader&) = delete;
+      MergeReader(MergeReader&&) = default;
+
+      /** @brief Number of files being merged */
+      size_t fileCount() const { return files_.size(); }
+
+      /** @brief Advance to the next line in merged order.
+       *
+       *  Returns false when every file is exhausted.
+       */
+      bool next();
+
+      /** @brief The current line.
+       *
+       *  Valid after next() returns true, and only until it is called
+       *  again.
+       */
+      const std::string& line() const { return lines_[tree_[0]]; }
+
+      /** @brief Index of the file the current line came from */
+      size_t source() const { return tree_[0]; }
+
+      /** @brief Call f with each remaining line in merged order */
+      template <typename Function>
+      void eachLine(Function f) {
+	while (next()) {
+	  f(line());
+	}
+      }
+
+      MergeReader& operator=(const MergeReader&) = delete;
+      MergeReader& operator=(MergeReader&&) = default;
+
+      /** @brief Size of the read buffer each of n files gets from a
+       *         budget of bufferBudget bytes.
+       *
+       *  The share is clamped to [MIN_BUFFER_SIZE, MAX_BUFFER_SIZE],
+       *  since smaller buffers mean one read per few lines and larger
+       *  ones don't read any faster.
+       */
+      static size_t bufferSizeFor(size_t n, size_t bufferBudget);
+
+    private:
+      std::vector<File> files_;
+      Comparator compare_;
+      std::vector<std::string> lines_;
+      std::vector<bool> exhausted_;
+
+      // tree_[0] is the index of the file with the smallest current line,
+      // and tree_[1..N-1] are the losers at each internal node
+      std::vector<size_t> tree_;
+      bool started_;
+
+      void initialize_();
+      void read_(size_t i);
+      void adjust_(size_t i);
+      bool precedes_(size_t i, size_t j) const;
+    };
+
+  }
+}
+
+#endif
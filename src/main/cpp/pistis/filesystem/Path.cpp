@@ -4,6 +4,7 @@
  */
 
 #include "Path.hpp"
+#include "File.hpp"
 #include <pistis/exceptions/IOError.hpp>
 #include <sstream>
 #include <ctype.h>
@@ -36,6 +37,17 @@ namespace {
     }    
   }
 
+  // Add a component to the end of a relative path, as join() would.  It
+  // can't be the root, and an empty component adds nothing.
+  void appendComponent(std::string& path, std::string_view component) {
+    if (!component.empty()) {
+      if (!path.empty()) {
+	path.push_back('/');
+      }
+      path.append(component);
+    }
+  }
+
   void readStatistics(const std::string& path, struct stat& statistics) {
     if (stat(path.c_str(), &statistics) < 0) {
       throw IOError::fromSystemError("Call to stat(\"" + path +
@@ -44,6 +56,20 @@ namespace {
     }
   }
 
+  // Returns false if path doesn't exist
+  bool readStatisticsIfExists(const std::string& path,
+			      struct stat& statistics) {
+    if (!stat(path.c_str(), &statistics)) {
+      return true;
+    } else if ((errno == ENOENT) || (errno == ENOTDIR)) {
+      return false;
+    } else {
+      throw IOError::fromSystemError("Call to stat(\"" + path +
+				     "\") failed: #ERR#", errno,
+				     PISTIS_EX_HERE);
+    }
+  }
+
   bool checkFileType(const std::string& path, mode_t fileType) {
     struct stat info;
     if (!stat(path.c_str(), &info)) {
@@ -129,12 +155,12 @@ namespace pistis {
   namespace filesystem {
     namespace path {
 
-      std::string baseName(const std::string& path) {
+      std::string_view baseName(std::string_view path) {
 	size_t i = path.rfind('/');
-	if (i == std::string::npos) {
+	if (i == std::string_view::npos) {
 	  return path;
 	} else if ((i + 1) == path.size()) {
-	  return std::string();
+	  return std::string_view();
 	} else {
 	  return path.substr(i + 1);
 	}
@@ -142,27 +168,21 @@ namespace pistis {
 
       std::string commonPrefix(const std::string& firstPath,
 			       const std::string& secondPath) {
-	size_t shortLength = std::min(firstPath.size(), secondPath.size());
-
-	if (!shortLength || (firstPath[0] != secondPath[0])) {
-	  return std::string();
-	} else {
-	  size_t i = 1;
-	  size_t j = 1;
-	  size_t sameUntil = (firstPath[0] == '/') ? 1 : 0;
-
-	  while ((i != shortLength) && (firstPath[i] == secondPath[i])) {
-	    if ((firstPath[i] == '/') && (firstPath[i - 1] != '/')) {
-	      sameUntil = i;
-	    }
-	    ++i;
-	  }
+	const ComponentIterator end;
+	ComponentIterator i(firstPath);
+	ComponentIterator j(secondPath);
+	size_t prefixLength = 0;
+
+	while ((i != end) && (j != end) && (*i == *j)) {
+	  prefixLength = (i->data() - firstPath.data()) + i->size();
+	  ++i;
+	  ++j;
+	}
 
-	  if (i == firstPath.size()) {
-	    return firstPath;  // Prefix covers entire first path
-	  }
-	  return firstPath.substr(0, sameUntil);
+	if (i == end) {
+	  return firstPath;  // Prefix covers entire first path
 	}
+	return firstPath.substr(0, prefixLength);
       }
     
       std::string currentDirectory() {
@@ -178,11 +198,11 @@ namespace pistis {
 	return result;
       }
     
-      std::string directoryName(const std::string& path) {
-	static const std::string ROOT_DIRECTORY("/");
+      std::string_view directoryName(std::string_view path) {
+	static const std::string_view ROOT_DIRECTORY("/");
 	size_t i = path.rfind('/');
-	if (i == std::string::npos) {
-	  return std::string();
+	if (i == std::string_view::npos) {
+	  return std::string_view();
 	} else if (i) {
 	  // Forward slash in the middle of the path.
 	  // There could be multiple forward slashes here.  Move i to the last
@@ -192,8 +212,8 @@ namespace pistis {
 	  // slashes, and so we should return a single forward slash
 	  // representing the root directory.
 	  i = path.find_last_not_of('/', i - 1);
-	  return (i == std::string::npos) ? ROOT_DIRECTORY
-	                                  : path.substr(0, i + 1);
+	  return (i == std::string_view::npos) ? ROOT_DIRECTORY
+					       : path.substr(0, i + 1);
 	} else {
 	  // Single forward slash at the start of the path => directory is
 	  // the root directory
@@ -321,7 +341,7 @@ namespace pistis {
 	return expansion.str();
       }
     
-      std::string extension(const std::string& path) {
+      std::string_view extension(std::string_view path) {
 	size_t i = path.size();
 	while ((i > 1) && (path[i - 1] != '/')) {
 	  --i;
@@ -330,7 +350,7 @@ namespace pistis {
 	    return path.substr(i);
 	  }
 	}
-	return std::string();
+	return std::string_view();
       }
     
       uint64_t fileSize(const std::string& path) {
@@ -391,6 +411,11 @@ namespace pistis {
 	}
       }
 
+      uint64_t lineCount(const std::string& path) {
+	return File::open(path, FileCreationMode::OPEN_ONLY,
+			  FileAccessMode::READ_ONLY).countLines();
+      }
+
       uint64_t lastAccessTime(const std::string& path) {
 	struct stat statistics;
 	readStatistics(path, statistics);
@@ -418,55 +443,85 @@ namespace pistis {
 
       std::string relativePath(const std::string& path,
 			       const std::string& base) {
-	static const std::string THIS_DIR = ".";
-	static const std::string PARENT_DIR = "..";
+	static const std::string_view THIS_DIR(".");
+	static const std::string_view PARENT_DIR("..");
       
 	if (isAbsolute(path) != isAbsolute(base)) {
 	  return relativePath(absolutePath(path), absolutePath(base));
 	} else {
-	  std::vector<std::string> pathComponents = split(path);
-	  std::vector<std::string> baseComponents = split(base);
-	  uint32_t i = 0;
-       
-	  while ((i != pathComponents.size()) && (i != baseComponents.size()) &&
-		 (pathComponents[i] == baseComponents[i])) {
+	  const ComponentIterator end;
+	  ComponentIterator i(path);
+	  ComponentIterator j(base);
+
+	  while ((i != end) && (j != end) && (*i == *j)) {
 	    ++i;
+	    ++j;
 	  }
 
-	  if ((i == baseComponents.size()) && (i == pathComponents.size())) {
-	    return THIS_DIR;
+	  if ((i == end) && (j == end)) {
+	    return std::string(THIS_DIR);
 	  } else {
-	    std::vector<std::string> newComponents;
-	    for (uint32_t j = i; j != baseComponents.size(); ++j) {
-	      newComponents.push_back(PARENT_DIR);
+	    std::string relative;
+	    for (; j != end; ++j) {
+	      appendComponent(relative, PARENT_DIR);
 	    }
-	    while (i != pathComponents.size()) {
-	      newComponents.push_back(pathComponents[i]);
-	      ++i;
+	    for (; i != end; ++i) {
+	      appendComponent(relative, *i);
 	    }
-	    return joinSequence(newComponents.begin(), newComponents.end());
+	    return relative;
 	  }
 	}
       }
-    
-      std::tuple<std::string, std::string> splitFile(const std::string& path) {
-	static const std::string ROOT_DIR("/");
+
+      bool sameContent(const std::string& path1, const std::string& path2) {
+	struct stat s1;
+	struct stat s2;
+
+	if (!readStatisticsIfExists(path1, s1) ||
+	    !readStatisticsIfExists(path2, s2)) {
+	  return false;
+	} else if ((s1.st_dev == s2.st_dev) && (s1.st_ino == s2.st_ino)) {
+	  return true;
+	} else if (!S_ISREG(s1.st_mode) || !S_ISREG(s2.st_mode) ||
+		   (s1.st_size != s2.st_size)) {
+	  return false;
+	}
+
+	try {
+	  File file1 = File::open(path1, FileCreationMode::OPEN_ONLY,
+				  FileAccessMode::READ_ONLY);
+	  File file2 = File::open(path2, FileCreationMode::OPEN_ONLY,
+				  FileAccessMode::READ_ONLY);
+	  return file1.firstDifference(file2) == File::NO_DIFFERENCE;
+	} catch(const IOError&) {
+	  // One of the files was removed after it was examined
+	  if (!exists(path1) || !exists(path2)) {
+	    return false;
+	  }
+	  throw;
+	}
+      }
+
+      std::tuple<std::string_view, std::string_view> splitFile(
+	  std::string_view path
+      ) {
+	static const std::string_view ROOT_DIR("/");
 	size_t i = path.rfind('/');
-	if (i == std::string::npos) {
-	  return std::make_tuple(std::string(), path);
+	if (i == std::string_view::npos) {
+	  return std::make_tuple(std::string_view(), path);
 	} else if (!i) {
 	  return std::make_tuple(ROOT_DIR, path.substr(1));
 	} else {
 	  size_t j = path.find_last_not_of('/', i - 1);
-	  if (j == std::string::npos) {
+	  if (j == std::string_view::npos) {
 	    return std::make_tuple(ROOT_DIR, path.substr(i + 1));
 	  }
 	  return std::make_tuple(path.substr(0, j + 1), path.substr(i + 1));
 	}
       }
 
-      std::tuple<std::string, std::string> splitExtension(
-	  const std::string& path
+      std::tuple<std::string_view, std::string_view> splitExtension(
+	  std::string_view path
       ) {
 	size_t i = path.size();
 	while ((i > 1) && (path[i - 1] != '/')) {
@@ -476,7 +531,7 @@ namespace pistis {
 	    return std::make_tuple(path.substr(0, i), path.substr(i));
 	  }
 	}
-	return std::make_tuple(path, std::string());
+	return std::make_tuple(path, std::string_view());
       }
 
     }
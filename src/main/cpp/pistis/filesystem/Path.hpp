@@ -9,7 +9,10 @@
 #ifndef __PISTIS__FILESYSTEM__PATH_HPP__
 #define __PISTIS__FILESYSTEM__PATH_HPP__
 
+#include <pistis/filesystem/PathComponents.hpp>
+
 #include <string>
+#include <string_view>
 #include <tuple>
 #include <utility>
 #include <vector>
@@ -51,11 +54,27 @@ namespace pistis {
 	}
       }
     
-      std::string absolutePath(const std::string& path) {
+      inline std::string absolutePath(const std::string& path) {
 	return isAbsolute(path) ? path : join(currentDirectory(), path);
       }
     
-      std::string baseName(const std::string& path);
+      /** @brief The part of path after the last '/'.
+       *
+       *  baseName(), directoryName(), extension(), splitFile() and
+       *  splitExtension() each have an overload that takes and returns
+       *  std::string_views.  The views it returns point into path, or at
+       *  a static "/" for the root directory, so they allocate nothing.
+       *  The std::string overloads copy those views.
+       */
+      std::string_view baseName(std::string_view path);
+
+      inline std::string baseName(const std::string& path) {
+	return std::string(baseName(std::string_view(path)));
+      }
+
+      inline std::string baseName(const char* path) {
+	return std::string(baseName(std::string_view(path)));
+      }
       
       std::string commonPrefix(const std::string& firstPath,
 			       const std::string& secondPath);
@@ -83,12 +102,29 @@ namespace pistis {
 	}
       }
 
-      std::string directoryName(const std::string& path);
+      std::string_view directoryName(std::string_view path);
+
+      inline std::string directoryName(const std::string& path) {
+	return std::string(directoryName(std::string_view(path)));
+      }
+
+      inline std::string directoryName(const char* path) {
+	return std::string(directoryName(std::string_view(path)));
+      }
 
       bool exists(const std::string& path);
       std::string expandUser(const std::string& path);
       std::string expandVars(const std::string& path);
-      std::string extension(const std::string& path);
+
+      std::string_view extension(std::string_view path);
+
+      inline std::string extension(const std::string& path) {
+	return std::string(extension(std::string_view(path)));
+      }
+
+      inline std::string extension(const char* path) {
+	return std::string(extension(std::string_view(path)));
+      }
 
       uint64_t fileSize(const std::string& path);
 
@@ -97,6 +133,11 @@ namespace pistis {
       bool isSymbolicLink(const std::string& path);
       bool isSameFile(const std::string& path1, const std::string& path2);
 
+      /** @brief Number of lines in a file, counted as
+       *         File::countLines() counts them.
+       */
+      uint64_t lineCount(const std::string& path);
+
       uint64_t lastAccessTime(const std::string& path);
       uint64_t lastModifiedTime(const std::string& path);
     
@@ -108,50 +149,35 @@ namespace pistis {
       inline std::string relativePath(const std::string& path) {
 	return relativePath(path, currentDirectory());
       }
+
+      /** @brief Whether two files hold the same data.
+       *
+       *  The content counterpart to isSameFile().  Files of different
+       *  sizes are never read, and a file always has the same content as
+       *  itself.  Otherwise both are read and compared with
+       *  File::firstDifference().  Returns false if either file doesn't
+       *  exist, or if they are different files and either is not a
+       *  regular file.
+       */
+      bool sameContent(const std::string& path1, const std::string& path2);
     
+      /** @brief Call f(component) with each component of path as a
+       *         std::string_view into path.
+       *
+       *  The components are the ones split() returns, but nothing is
+       *  copied or allocated.  See ComponentIterator.
+       */
       template <typename Function>
-      void splitAndCall(const std::string& path, Function f) {
-	static const std::string EMPTY_STRING;
-	static const std::string BACKSLASH("/");
-
-	if (path.empty()) {
-	  return;
-	}
-
-	size_t i = 0;
-
-	if (path[0] == '/') {
-	  // Send the backslash that represents the root and skip backslashes
-	  // at the start of the string
-	  f(std::string("/"));
-	  i = path.find_first_not_of('/');
-
-	  // Check this here, so we're guaranteed to enter the loop below
-	  // at least once, and we don't need a flag to track whether
-	  // any path elements besides the root were emitted.
-	  if (i == std::string::npos) {
-	    return;
-	  }
-	}
-
-	while (i != std::string::npos) {
-	  // At this point, path[i] != '/', so we have at least one separator
-	  size_t start = i;
-	  i = path.find('/', i);
-	  if (i == std::string::npos) {
-	    f(path.substr(start));
-	  } else {
-	    f(path.substr(start, i - start));
-	    i = path.find_first_not_of('/', i);
-	  }
+      void splitViewsAndCall(std::string_view path, Function f) {
+	for (std::string_view component : components(path)) {
+	  f(component);
 	}
+      }
 
-	// If the path ends with '/', send the empty string as the last
-	// component.  The logic prior to the while loop ensures the while
-	// loop executes at least once, and at least one component besides
-	// the root was sent to f.
-	if (path.back() == '/') {
-	  f(std::string());
+      template <typename Function>
+      void splitAndCall(const std::string& path, Function f) {
+	for (std::string_view component : components(path)) {
+	  f(std::string(component));
 	}
       }
     
@@ -171,11 +197,42 @@ namespace pistis {
 	return output;
       }
 
-      std::tuple<std::string, std::string> splitFile(const std::string& path);
-      std::tuple<std::string, std::string> splitExtension(
+      std::tuple<std::string_view, std::string_view> splitFile(
+	  std::string_view path
+      );
+
+      inline std::tuple<std::string, std::string> splitFile(
 	  const std::string& path
+      ) {
+	auto [directory, file] = splitFile(std::string_view(path));
+	return std::make_tuple(std::string(directory), std::string(file));
+      }
+
+      inline std::tuple<std::string, std::string> splitFile(
+	  const char* path
+      ) {
+	auto [directory, file] = splitFile(std::string_view(path));
+	return std::make_tuple(std::string(directory), std::string(file));
+      }
+
+      std::tuple<std::string_view, std::string_view> splitExtension(
+	  std::string_view path
       );
 
+      inline std::tuple<std::string, std::string> splitExtension(
+	  const std::string& path
+      ) {
+	auto [root, extension] = splitExtension(std::string_view(path));
+	return std::make_tuple(std::string(root), std::string(extension));
+      }
+
+      inline std::tuple<std::string, std::string> splitExtension(
+	  const char* path
+      ) {
+	auto [root, extension] = splitExtension(std::string_view(path));
+	return std::make_tuple(std::string(root), std::string(extension));
+      }
+
     }
   }
 }
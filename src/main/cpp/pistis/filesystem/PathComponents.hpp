@@ -0,0 +1,145 @@
+#ifndef __PISTIS__FILESYSTEM__PATHCOMPONENTS_HPP__
+#define __PISTIS__FILESYSTEM__PATHCOMPONENTS_HPP__
+
+/** @file PathComponents.hpp
+ *
+ *  Declaration of pistis::filesystem::path::ComponentIterator and
+ *  pistis::filesystem::path::Components, which split a path into its
+ *  components without copying them.
+ */
+
+#include <iterator>
+#include <string_view>
+
+#include <stddef.h>
+
+namespace pistis {
+  namespace filesystem {
+    namespace path {
+
+      /** @brief Forward iterator over the components of a path.
+       *
+       *  Yields the same components as path::split(), in the same order,
+       *  but as std::string_views into the path, so nothing is
+       *  allocated.  The root of an absolute path is a view of its first
+       *  '/', and a path that ends in '/' ends with an empty view at the
+       *  end of the path.  The views are valid as long as the path is.
+       */
+      class ComponentIterator {
+      public:
+	typedef std::forward_iterator_tag iterator_category;
+	typedef std::string_view value_type;
+	typedef ptrdiff_t difference_type;
+	typedef const std::string_view* pointer;
+	typedef const std::string_view& reference;
+
+      public:
+	/** @brief The end of any path */
+	ComponentIterator(): path_(), component_(), next_(END_), done_(true) { }
+
+	/** @brief The first component of path */
+	explicit ComponentIterator(std::string_view path):
+	    path_(path), component_(), next_(0), done_(path.empty()) {
+	  if (done_) {
+	    return;
+	  } else if (path[0] == '/') {
+	    // The root, followed by the first character after the leading
+	    // slashes, if any
+	    component_ = path.substr(0, 1);
+	    const size_t i = path.find_first_not_of('/');
+	    next_ = (i == std::string_view::npos) ? END_ : i;
+	  } else {
+	    advance_();
+	  }
+	}
+
+	reference operator*() const { return component_; }
+	pointer operator->() const { return &component_; }
+
+	ComponentIterator& operator++() {
+	  advance_();
+	  return *this;
+	}
+
+	ComponentIterator operator++(int) {
+	  ComponentIterator tmp(*this);
+	  advance_();
+	  return tmp;
+	}
+
+	bool operator==(const ComponentIterator& other) const {
+	  return (done_ == other.done_) &&
+		 (done_ || ((component_.data() == other.component_.data()) &&
+			    (next_ == other.next_)));
+	}
+
+	bool operator!=(const ComponentIterator& other) const {
+	  return !(*this == other);
+	}
+
+      private:
+	static const size_t END_ = std::string_view::npos;
+
+	std::string_view path_;
+	std::string_view component_;
+
+	// Where the next component starts, path_.size() if the only one
+	// left is the empty component after a trailing '/', or END_ if
+	// component_ is the last one
+	size_t next_;
+	bool done_;
+
+	void advance_() {
+	  if (next_ == END_) {
+	    component_ = std::string_view();
+	    done_ = true;
+	  } else if (next_ == path_.size()) {
+	    component_ = path_.substr(next_);
+	    next_ = END_;
+	  } else {
+	    // path_[next_] != '/', so the component isn't empty
+	    const size_t start = next_;
+	    const size_t i = path_.find('/', start);
+	    if (i == std::string_view::npos) {
+	      component_ = path_.substr(start);
+	      next_ = END_;
+	    } else {
+	      component_ = path_.substr(start, i - start);
+	      const size_t j = path_.find_first_not_of('/', i);
+	      next_ = (j == std::string_view::npos) ? path_.size() : j;
+	    }
+	  }
+	}
+      };
+
+      /** @brief The components of a path, as a range for ComponentIterator
+       */
+      class Components {
+      public:
+	typedef ComponentIterator iterator;
+	typedef ComponentIterator const_iterator;
+
+      public:
+	explicit Components(std::string_view path): path_(path) { }
+
+	ComponentIterator begin() const { return ComponentIterator(path_); }
+	ComponentIterator end() const { return ComponentIterator(); }
+
+      private:
+	std::string_view path_;
+      };
+
+      /** @brief Iterate over the components of path without copying them
+       *
+       *  For example, components("/usr//lib/") yields "/", "usr", "lib"
+       *  and "".
+       */
+      inline Components components(std::string_view path) {
+	return Components(path);
+      }
+
+    }
+  }
+}
+
+#endif
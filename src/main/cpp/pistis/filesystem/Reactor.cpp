@@ -0,0 +1,180 @@
+#include "Reactor.hpp"
+
+#include <pistis/exceptions/IOError.hpp>
+
+#include <errno.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+using namespace pistis::filesystem;
+using namespace pistis::exceptions;
+
+const uint32_t Reactor::READABLE;
+const uint32_t Reactor::WRITABLE;
+const uint32_t Reactor::HANG_UP;
+const uint32_t Reactor::ERROR;
+
+namespace {
+  static const size_t MAX_EVENTS = 256;
+
+  // Registrations are numbered from 1, so id 0 marks the wake descriptor
+  static const uint64_t WAKE_ID = 0;
+
+  uint32_t toEpollEvents(uint32_t events) {
+    uint32_t result = 0;
+    if (events & Reactor::READABLE) {
+      result |= EPOLLIN | EPOLLRDHUP;
+    }
+    if (events & Reactor::WRITABLE) {
+      result |= EPOLLOUT;
+    }
+    return result;
+  }
+
+  uint32_t fromEpollEvents(uint32_t events) {
+    uint32_t result = 0;
+    if (events & (EPOLLIN | EPOLLPRI)) {
+      result |= Reactor::READABLE;
+    }
+    if (events & EPOLLOUT) {
+      result |= Reactor::WRITABLE;
+    }
+    if (events & (EPOLLHUP | EPOLLRDHUP)) {
+      result |= Reactor::HANG_UP;
+    }
+    if (events & EPOLLERR) {
+      result |= Reactor::ERROR;
+    }
+    return result;
+  }
+}
+
+Reactor::Reactor():
+    epollFd_(-1), wakeFd_(-1), stopped_(false), ids_(), handlers_(),
+    nextId_(1) {
+  epollFd_ = ::epoll_create1(EPOLL_CLOEXEC);
+  if (epollFd_ < 0) {
+    throw IOError::fromSystemError("Error creating epoll instance: #ERR#",
+				   PISTIS_EX_HERE);
+  }
+  wakeFd_ = ::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+  if (wakeFd_ < 0) {
+    ::close(epollFd_);
+    throw IOError::fromSystemError("Error creating eventfd: #ERR#",
+				   PISTIS_EX_HERE);
+  }
+
+  struct epoll_event event;
+  event.events = EPOLLIN;
+  event.data.u64 = WAKE_ID;
+  if (::epoll_ctl(epollFd_, EPOLL_CTL_ADD, wakeFd_, &event) < 0) {
+    ::close(wakeFd_);
+    ::close(epollFd_);
+    throw IOError::fromSystemError("Error watching eventfd: #ERR#",
+				   PISTIS_EX_HERE);
+  }
+}
+
+Reactor::~Reactor() {
+  ::close(wakeFd_);
+  ::close(epollFd_);
+}
+
+void Reactor::add(int fd, uint32_t events, Handler handler) {
+  if (ids_.count(fd)) {
+    throw IOError("Error adding descriptor " + std::to_string(fd) +
+		  " to reactor: it is already being watched",
+		  PISTIS_EX_HERE);
+  }
+
+  const uint64_t id = nextId_++;
+  control_(EPOLL_CTL_ADD, fd, events, id, "adding");
+  ids_[fd] = id;
+  handlers_[id] = std::make_shared<Handler>(std::move(handler));
+}
+
+void Reactor::modify(int fd, uint32_t events) {
+  auto i = ids_.find(fd);
+  if (i == ids_.end()) {
+    throw IOError("Error modifying descriptor " + std::to_string(fd) +
+		  " in reactor: it is not being watched", PISTIS_EX_HERE);
+  }
+  control_(EPOLL_CTL_MOD, fd, events, i->second, "modifying");
+}
+
+void Reactor::remove(int fd) {
+  auto i = ids_.find(fd);
+  if (i != ids_.end()) {
+    // If fd was closed already, epoll has dropped it on its own
+    ::epoll_ctl(epollFd_, EPOLL_CTL_DEL, fd, nullptr);
+    handlers_.erase(i->second);
+    ids_.erase(i);
+  }
+}
+
+size_t Reactor::runOnce(int timeout) {
+  struct epoll_event events[MAX_EVENTS];
+  int n;
+
+  do {
+    n = ::epoll_wait(epollFd_, events, MAX_EVENTS, timeout);
+  } while ((n < 0) && (errno == EINTR));
+  if (n < 0) {
+    throw IOError::fromSystemError("Error waiting for events: #ERR#",
+				   PISTIS_EX_HERE);
+  }
+
+  size_t nCalled = 0;
+  for (int i = 0; i < n; ++i) {
+    if (events[i].data.u64 == WAKE_ID) {
+      clearWake_();
+      continue;
+    }
+
+    auto j = handlers_.find(events[i].data.u64);
+    if (j != handlers_.end()) {
+      // Hold a reference, since the handler may remove itself
+      std::shared_ptr<Handler> handler = j->second;
+      (*handler)(fromEpollEvents(events[i].events));
+      ++nCalled;
+    }
+  }
+  return nCalled;
+}
+
+void Reactor::run() {
+  while (!stopped_ && !handlers_.empty()) {
+    runOnce();
+  }
+  stopped_ = false;
+}
+
+void Reactor::stop() {
+  stopped_ = true;
+  const uint64_t one = 1;
+  // Can only fail if the counter is about to overflow, in which case
+  // epoll_wait() will return anyway
+  ssize_t nWritten = ::write(wakeFd_, &one, sizeof(one));
+  (void)nWritten;
+}
+
+void Reactor::control_(int op, int fd, uint32_t events, uint64_t id,
+		       const char* action) {
+  struct epoll_event event;
+  event.events = toEpollEvents(events);
+  event.data.u64 = id;
+  if (::epoll_ctl(epollFd_, op, fd, &event) < 0) {
+    throw IOError::fromSystemError(
+	std::string("Error ") + action + " descriptor " + std::to_string(fd) +
+	    " in reactor: #ERR#",
+	PISTIS_EX_HERE
+    );
+  }
+}
+
+void Reactor::clearWake_() {
+  uint64_t count;
+  ssize_t nRead = ::read(wakeFd_, &count, sizeof(count));
+  (void)nRead;
+}
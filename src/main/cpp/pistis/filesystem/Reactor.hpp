@@ -0,0 +1,132 @@
+#ifndef __PISTIS__FILESYSTEM__REACTOR_HPP__
+#define __PISTIS__FILESYSTEM__REACTOR_HPP__
+
+/** @file Reactor.hpp
+ *
+ *  Declaration of pistis::filesystem::Reactor, which waits for many
+ *  descriptors to become ready on one thread.
+ */
+
+#include <pistis/filesystem/File.hpp>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace pistis {
+  namespace filesystem {
+
+    /** @brief Calls a handler whenever one of its descriptors is ready
+     *         for I/O.
+     *
+     *  A Reactor wraps an epoll instance, so one thread can serve many
+     *  pipes, FIFOs and sockets.  Put each File in non-blocking mode
+     *  before adding it, and have its handler call tryRead() or
+     *  tryWrite() until they return File::WOULD_BLOCK.  Descriptors are
+     *  level-triggered, so a handler that stops early is called again
+     *  on the next pass.
+     *
+     *  Handlers run on the thread that calls runOnce() or run(), and
+     *  may add, modify or remove any descriptor, including their own.
+     *  A descriptor removed by an earlier handler in the same pass is
+     *  not reported.  Only stop() may be called from other threads.
+     */
+    class Reactor {
+    public:
+      /** @brief The descriptor has data to read, or is at its end */
+      static const uint32_t READABLE = 0x01;
+
+      /** @brief The descriptor has room to write */
+      static const uint32_t WRITABLE = 0x02;
+
+      /** @brief The other end of the pipe or socket was closed.  Always
+       *         reported, even if not requested.
+       */
+      static const uint32_t HANG_UP = 0x04;
+
+      /** @brief An error is pending on the descriptor.  Always reported,
+       *         even if not requested.
+       */
+      static const uint32_t ERROR = 0x08;
+
+      /** @brief Called with the events that occurred */
+      typedef std::function<void (uint32_t)> Handler;
+
+    public:
+      Reactor();
+      Reactor(const Reactor&) = delete;
+      ~Reactor();
+
+      /** @brief Number of descriptors being watched */
+      size_t size() const { return handlers_.size(); }
+
+      /** @brief Call handler when fd has any of the given events.
+       *
+       *  Throws IOError if fd is already being watched.
+       */
+      void add(int fd, uint32_t events, Handler handler);
+      void add(const File& file, uint32_t events, Handler handler) {
+	add(file.fd(), events, std::move(handler));
+      }
+
+      /** @brief Change the events fd is watched for */
+      void modify(int fd, uint32_t events);
+      void modify(const File& file, uint32_t events) {
+	modify(file.fd(), events);
+      }
+
+      /** @brief Stop watching fd.  Does nothing if it isn't watched.
+       *
+       *  Call this before closing fd.
+       */
+      void remove(int fd);
+      void remove(const File& file) { remove(file.fd()); }
+
+      /** @brief Wait up to timeout milliseconds for descriptors to become
+       *         ready, and call their handlers.
+       *
+       *  A negative timeout waits indefinitely.  Returns the number of
+       *  handlers called, which is 0 if the wait timed out or stop()
+       *  was called.
+       */
+      size_t runOnce(int timeout = -1);
+
+      /** @brief Call handlers until stop() is called or no descriptors
+       *         are left.
+       */
+      void run();
+
+      /** @brief Make run() return after the handlers of its current pass.
+       *
+       *  Safe to call from any thread, including from a handler.  If
+       *  run() isn't running, the next call to it returns at once.
+       */
+      void stop();
+
+      Reactor& operator=(const Reactor&) = delete;
+
+    private:
+      int epollFd_;
+      int wakeFd_;
+      std::atomic<bool> stopped_;
+
+      // Each registration gets a new id, which is what epoll reports.
+      // That way an event for a descriptor that was removed, or removed
+      // and added again, in the same pass can be recognized and dropped.
+      std::unordered_map<int, uint64_t> ids_;
+      std::unordered_map<uint64_t, std::shared_ptr<Handler>> handlers_;
+      uint64_t nextId_;
+
+      void control_(int op, int fd, uint32_t events, uint64_t id,
+		    const char* action);
+      void clearWake_();
+    };
+
+  }
+}
+
+#endif
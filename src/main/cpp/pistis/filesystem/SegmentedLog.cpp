@@ -0,0 +1,555 @@
+#include "SegmentedLog.hpp"
+#include "Path.hpp"
+
+#include <pistis/exceptions/IOError.hpp>
+
+#include <algorithm>
+#include <sstream>
+
+#include <dirent.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#ifdef __SSE4_2__
+#include <nmmintrin.h>
+#endif
+
+using namespace pistis::filesystem;
+using namespace pistis::exceptions;
+
+namespace {
+  static const size_t HEADER_SIZE = 8;
+  static const size_t INDEX_ENTRY_SIZE = 16;
+  static const size_t MIN_READ_SIZE = 64 * 1024;
+  static const char LOG_EXTENSION[] = ".log";
+  static const char INDEX_EXTENSION[] = ".index";
+  static const size_t SEGMENT_NAME_DIGITS = 20;
+
+  inline void putU32LE(std::vector<uint8_t>& out, uint32_t v) {
+    for (int i = 0; i < 4; ++i, v >>= 8) {
+      out.push_back((uint8_t)v);
+    }
+  }
+
+  inline void putU64LE(std::vector<uint8_t>& out, uint64_t v) {
+    for (int i = 0; i < 8; ++i, v >>= 8) {
+      out.push_back((uint8_t)v);
+    }
+  }
+
+  inline uint32_t getU32LE(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) |
+	   ((uint32_t)p[3] << 24);
+  }
+
+  inline uint64_t getU64LE(const uint8_t* p) {
+    return (uint64_t)getU32LE(p) | ((uint64_t)getU32LE(p + 4) << 32);
+  }
+
+  // Lookup tables for slicing-by-8 CRC-32C (Castagnoli polynomial)
+  struct Crc32cTables {
+    uint32_t t[8][256];
+
+    Crc32cTables() {
+      for (uint32_t i = 0; i < 256; ++i) {
+	uint32_t crc = i;
+	for (int j = 0; j < 8; ++j) {
+	  crc = (crc & 1) ? ((crc >> 1) ^ 0x82F63B78) : (crc >> 1);
+	}
+	t[0][i] = crc;
+      }
+      for (uint32_t i = 0; i < 256; ++i) {
+	for (int k = 1; k < 8; ++k) {
+	  t[k][i] = (t[k - 1][i] >> 8) ^ t[0][t[k - 1][i] & 0xFF];
+	}
+      }
+    }
+  };
+
+  uint32_t crc32c(const uint8_t* p, size_t n) {
+#ifdef __SSE4_2__
+    uint64_t crc = 0xFFFFFFFF;
+    while (n >= 8) {
+      uint64_t v;
+      ::memcpy(&v, p, 8);
+      crc = _mm_crc32_u64(crc, v);
+      p += 8;
+      n -= 8;
+    }
+    uint32_t c = (uint32_t)crc;
+    while (n--) {
+      c = _mm_crc32_u8(c, *p++);
+    }
+    return ~c;
+#else
+    static const Crc32cTables TABLES;
+    const uint32_t (*t)[256] = TABLES.t;
+    uint32_t crc = 0xFFFFFFFF;
+
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    while (n >= 8) {
+      uint32_t lo, hi;
+      ::memcpy(&lo, p, 4);
+      ::memcpy(&hi, p + 4, 4);
+      lo ^= crc;
+      crc = t[7][lo & 0xFF] ^ t[6][(lo >> 8) & 0xFF] ^
+	    t[5][(lo >> 16) & 0xFF] ^ t[4][lo >> 24] ^
+	    t[3][hi & 0xFF] ^ t[2][(hi >> 8) & 0xFF] ^
+	    t[1][(hi >> 16) & 0xFF] ^ t[0][hi >> 24];
+      p += 8;
+      n -= 8;
+    }
+#endif
+    while (n--) {
+      crc = t[0][(crc ^ *p++) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+#endif
+  }
+
+  std::string segmentFileName(uint64_t baseRecord, const char* extension) {
+    char name[SEGMENT_NAME_DIGITS + 16];
+    snprintf(name, sizeof(name), "%020llu%s", (unsigned long long)baseRecord,
+	     extension);
+    return std::string(name);
+  }
+
+  bool parseSegmentFileName(const char* name, uint64_t& baseRecord) {
+    const size_t extLength = sizeof(LOG_EXTENSION) - 1;
+    if ((::strlen(name) != (SEGMENT_NAME_DIGITS + extLength)) ||
+	::strcmp(name + SEGMENT_NAME_DIGITS, LOG_EXTENSION)) {
+      return false;
+    }
+    for (size_t i = 0; i < SEGMENT_NAME_DIGITS; ++i) {
+      if ((name[i] < '0') || (name[i] > '9')) {
+	return false;
+      }
+    }
+    baseRecord = ::strtoull(name, nullptr, 10);
+    return true;
+  }
+
+  std::vector<uint64_t> listSegments(const std::string& directory) {
+    std::vector<uint64_t> segments;
+    DIR* dir = ::opendir(directory.c_str());
+    if (!dir) {
+      throw IOError::fromSystemError("Error listing " + directory + ": #ERR#",
+				     PISTIS_EX_HERE);
+    }
+
+    struct dirent* entry;
+    uint64_t baseRecord;
+    while ((entry = ::readdir(dir)) != nullptr) {
+      if (parseSegmentFileName(entry->d_name, baseRecord)) {
+	segments.push_back(baseRecord);
+      }
+    }
+    ::closedir(dir);
+
+    std::sort(segments.begin(), segments.end());
+    return segments;
+  }
+
+  void writeFully(File& file, const uint8_t* data, size_t n) {
+    while (n) {
+      size_t nWritten = file.write(data, n);
+      data += nWritten;
+      n -= nWritten;
+    }
+  }
+
+  std::vector<uint8_t> readIndexFile(const std::string& name) {
+    std::vector<uint8_t> data;
+    if (path::exists(name)) {
+      File file = File::open(name, FileCreationMode::OPEN_ONLY,
+			     FileAccessMode::READ_ONLY);
+      data.resize(path::fileSize(name));
+
+      size_t n = 0;
+      while (n < data.size()) {
+	size_t nRead = file.read(data.data() + n, data.size() - n);
+	if (!nRead) {
+	  break;
+	}
+	n += nRead;
+      }
+      data.resize(n - (n % INDEX_ENTRY_SIZE));
+    }
+    return data;
+  }
+
+  std::string recordErrorMessage(const std::string& directory,
+				 uint64_t record, const std::string& problem) {
+    std::ostringstream msg;
+    msg << "Record " << record << " in log " << directory << " " << problem;
+    return msg.str();
+  }
+}
+
+SegmentedLog::Reader::Reader(const SegmentedLog* log, size_t segment,
+			     uint64_t position, uint64_t record):
+    log_(log), segment_(0), record_(record), position_(position),
+    file_(-1), buffer_(MIN_READ_SIZE), start_(0), end_(0), data_(nullptr),
+    size_(0) {
+  openSegment_(segment, position, record);
+}
+
+bool SegmentedLog::Reader::next() {
+  Status status = readRecord_(true);
+  if (status == CORRUPT) {
+    throw IOError(recordErrorMessage(log_->directory_, record_,
+				     "is corrupt"),
+		  PISTIS_EX_HERE);
+  }
+  return status == RECORD;
+}
+
+SegmentedLog::Reader::Status SegmentedLog::Reader::readRecord_(
+    bool verify
+) {
+  while (!fill_(HEADER_SIZE)) {
+    if ((segment_ + 1) >= log_->segments_.size()) {
+      return (start_ == end_) ? END : TORN;
+    } else if (start_ != end_) {
+      return CORRUPT;
+    }
+    openSegment_(segment_ + 1, 0, log_->segments_[segment_ + 1].baseRecord);
+  }
+
+  const bool last = (segment_ + 1) == log_->segments_.size();
+  const uint32_t length = getU32LE(buffer_.data() + start_);
+  const uint32_t checksum = getU32LE(buffer_.data() + start_ + 4);
+  const size_t recordSize = HEADER_SIZE + length;
+
+  // Don't trust a length that would run past the end of the segment, since
+  // fill_() would allocate a buffer large enough to hold it.
+  if ((recordSize > buffer_.size()) &&
+      ((position_ + recordSize) > fileSize_())) {
+    return last ? TORN : CORRUPT;
+  }
+  if (!fill_(recordSize)) {
+    return last ? TORN : CORRUPT;
+  }
+
+  const uint8_t* payload = buffer_.data() + start_ + HEADER_SIZE;
+  if (verify && (crc32c(payload, length) != checksum)) {
+    return CORRUPT;
+  }
+
+  data_ = payload;
+  size_ = length;
+  start_ += recordSize;
+  position_ += recordSize;
+  ++record_;
+  return RECORD;
+}
+
+void SegmentedLog::Reader::openSegment_(size_t segment, uint64_t position,
+					uint64_t record) {
+  file_ = File::open(log_->segments_[segment].logName,
+		     FileCreationMode::OPEN_ONLY, FileAccessMode::READ_ONLY);
+  if (position) {
+    file_.seek(FileOrigin::START, position);
+  }
+  segment_ = segment;
+  position_ = position;
+  record_ = record;
+  start_ = 0;
+  end_ = 0;
+}
+
+bool SegmentedLog::Reader::fill_(size_t n) {
+  if ((end_ - start_) >= n) {
+    return true;
+  }
+
+  if (start_) {
+    ::memmove(buffer_.data(), buffer_.data() + start_, end_ - start_);
+    end_ -= start_;
+    start_ = 0;
+  }
+  if (n > buffer_.size()) {
+    buffer_.resize(n);
+  }
+
+  while (end_ < n) {
+    size_t nRead = file_.read(buffer_.data() + end_, buffer_.size() - end_);
+    if (!nRead) {
+      return false;
+    }
+    end_ += nRead;
+  }
+  return true;
+}
+
+uint64_t SegmentedLog::Reader::fileSize_() const {
+  struct stat statistics;
+  if (::fstat(file_.fd(), &statistics) < 0) {
+    throw IOError::fromSystemError("Error reading size of " + file_.name() +
+				   ": #ERR#", PISTIS_EX_HERE);
+  }
+  return statistics.st_size;
+}
+
+SegmentedLog::SegmentedLog(const std::string& directory,
+			   const SegmentedLogOptions& options):
+    directory_(directory), options_(options), segments_(), log_(-1),
+    index_(-1), nextRecord_(0), lastIndexed_(0), batch_(), pendingIndex_() {
+  if (!path::exists(directory_) && (::mkdir(directory_.c_str(), 0777) < 0)) {
+    throw IOError::fromSystemError("Error creating " + directory_ +
+				   ": #ERR#", PISTIS_EX_HERE);
+  }
+
+  for (uint64_t baseRecord : listSegments(directory_)) {
+    Segment segment = createSegment_(baseRecord);
+    std::vector<uint8_t> index = readIndexFile(segment.indexName);
+
+    segment.size = path::fileSize(segment.logName);
+    for (size_t i = 0; i < index.size(); i += INDEX_ENTRY_SIZE) {
+      segment.index.push_back(
+	  IndexEntry{ getU64LE(&index[i]), getU64LE(&index[i + 8]) }
+      );
+    }
+    segments_.push_back(std::move(segment));
+  }
+
+  if (segments_.empty()) {
+    segments_.push_back(createSegment_(0));
+  } else {
+    recover_(segments_.back());
+  }
+  openActive_();
+}
+
+uint64_t SegmentedLog::size() const {
+  uint64_t total = 0;
+  for (const Segment& segment : segments_) {
+    total += segment.size;
+  }
+  return total;
+}
+
+uint64_t SegmentedLog::append(const void* data, size_t n) {
+  const uint64_t record = nextRecord_;
+  checkRecordSize_(n);
+  encode_(data, n);
+  flushBatch_();
+  return record;
+}
+
+void SegmentedLog::sync() {
+  flushBatch_();
+  if ((::fdatasync(log_.fd()) < 0) || (::fdatasync(index_.fd()) < 0)) {
+    throw IOError::fromSystemError("Error syncing log " + directory_ +
+				   ": #ERR#", PISTIS_EX_HERE);
+  }
+}
+
+SegmentedLog::Reader SegmentedLog::readFrom(uint64_t record) const {
+  if ((record < firstRecord()) || (record > nextRecord_)) {
+    throw IOError(recordErrorMessage(directory_, record, "does not exist"),
+		  PISTIS_EX_HERE);
+  }
+
+  const size_t s = findSegment_(record);
+  const Segment& segment = segments_[s];
+  auto i = std::upper_bound(
+      segment.index.begin(), segment.index.end(), record,
+      [](uint64_t r, const IndexEntry& e) { return r < e.record; }
+  );
+  Reader reader = (i == segment.index.begin())
+      ? Reader(this, s, 0, segment.baseRecord)
+      : Reader(this, s, (i - 1)->position, (i - 1)->record);
+
+  // Records before the requested one are skipped without verifying their
+  // checksums
+  while (reader.record_ < record) {
+    if (reader.readRecord_(false) != Reader::RECORD) {
+      throw IOError(recordErrorMessage(directory_, record, "is missing"),
+		    PISTIS_EX_HERE);
+    }
+  }
+  return reader;
+}
+
+std::string SegmentedLog::read(uint64_t record) const {
+  Reader reader = readFrom(record);
+  if (!reader.next()) {
+    throw IOError(recordErrorMessage(directory_, record, "does not exist"),
+		  PISTIS_EX_HERE);
+  }
+  return std::string((const char*)reader.data(),
+		     (const char*)reader.data() + reader.size());
+}
+
+size_t SegmentedLog::applyRetention() {
+  const uint64_t now = ::time(nullptr);
+  uint64_t total = size();
+  size_t nDeleted = 0;
+
+  while (segments_.size() > 1) {
+    const Segment& oldest = segments_.front();
+    const bool tooBig = options_.maxTotalSize &&
+			(total > options_.maxTotalSize);
+    bool tooOld = false;
+    if (options_.maxSegmentAge) {
+      // A modification time in the future (clock skew, or a file server
+      // with a different clock) counts as brand new
+      const uint64_t modified = path::lastModifiedTime(oldest.logName);
+      tooOld = (modified < now) &&
+	       ((now - modified) > options_.maxSegmentAge);
+    }
+
+    if (!tooBig && !tooOld) {
+      break;
+    }
+
+    File::unlink(oldest.logName);
+    if (path::exists(oldest.indexName)) {
+      File::unlink(oldest.indexName);
+    }
+    total -= oldest.size;
+    segments_.erase(segments_.begin());
+    ++nDeleted;
+  }
+  return nDeleted;
+}
+
+void SegmentedLog::close() {
+  flushBatch_();
+  log_.close();
+  index_.close();
+}
+
+void SegmentedLog::checkRecordSize_(uint64_t n) const {
+  if (n > MAX_RECORD_SIZE) {
+    std::ostringstream msg;
+    msg << "Cannot append a record of " << n << " bytes to log "
+	<< directory_ << ": records are limited to " << MAX_RECORD_SIZE
+	<< " bytes";
+    throw IOError(msg.str(), PISTIS_EX_HERE);
+  }
+}
+
+void SegmentedLog::encode_(const void* data, size_t n) {
+  const uint64_t recordSize = HEADER_SIZE + n;
+  uint64_t position = segments_.back().size + batch_.size();
+
+  if (position && ((position + recordSize) > options_.maxSegmentSize)) {
+    flushBatch_();
+    roll_();
+    position = 0;
+  }
+
+  if ((position - lastIndexed_) >= options_.indexInterval) {
+    pendingIndex_.push_back(IndexEntry{ nextRecord_, position });
+    lastIndexed_ = position;
+  }
+
+  const uint8_t* p = (const uint8_t*)data;
+  putU32LE(batch_, (uint32_t)n);
+  putU32LE(batch_, crc32c(p, n));
+  batch_.insert(batch_.end(), p, p + n);
+  ++nextRecord_;
+}
+
+void SegmentedLog::flushBatch_() {
+  if (batch_.empty()) {
+    return;
+  }
+
+  Segment& active = segments_.back();
+  writeFully(log_, batch_.data(), batch_.size());
+  active.size += batch_.size();
+  batch_.clear();
+
+  if (!pendingIndex_.empty()) {
+    std::vector<uint8_t> entries;
+    entries.reserve(pendingIndex_.size() * INDEX_ENTRY_SIZE);
+    for (const IndexEntry& entry : pendingIndex_) {
+      putU64LE(entries, entry.record);
+      putU64LE(entries, entry.position);
+    }
+    writeFully(index_, entries.data(), entries.size());
+    active.index.insert(active.index.end(), pendingIndex_.begin(),
+			pendingIndex_.end());
+    pendingIndex_.clear();
+  }
+}
+
+void SegmentedLog::recover_(Segment& segment) {
+  const size_t s = segments_.size() - 1;
+  Reader reader = segment.index.empty()
+      ? Reader(this, s, 0, segment.baseRecord)
+      : Reader(this, s, segment.index.back().position,
+	       segment.index.back().record);
+
+  while (reader.readRecord_(true) == Reader::RECORD) {
+    // Scan to the first invalid or incomplete record
+  }
+  nextRecord_ = reader.record_;
+
+  if (reader.position_ < segment.size) {
+    File log = File::open(segment.logName, FileCreationMode::OPEN_ONLY,
+			  FileAccessMode::WRITE_ONLY);
+    log.truncate(reader.position_);
+    segment.size = reader.position_;
+  }
+
+  // Drop index entries that refer to truncated records, and any partial
+  // entry at the end of the index file.
+  while (!segment.index.empty() &&
+	 (segment.index.back().position >= segment.size)) {
+    segment.index.pop_back();
+  }
+  if (path::exists(segment.indexName) &&
+      (path::fileSize(segment.indexName) !=
+       (segment.index.size() * INDEX_ENTRY_SIZE))) {
+    File index = File::open(segment.indexName, FileCreationMode::OPEN_ONLY,
+			    FileAccessMode::WRITE_ONLY);
+    index.truncate(segment.index.size() * INDEX_ENTRY_SIZE);
+  }
+  lastIndexed_ = segment.index.empty() ? 0 : segment.index.back().position;
+}
+
+void SegmentedLog::openActive_() {
+  const Segment& active = segments_.back();
+  log_ = File::open(active.logName, FileAccessMode::WRITE_ONLY,
+		    FileOpenOptions::APPEND);
+  index_ = File::open(active.indexName, FileAccessMode::WRITE_ONLY,
+		      FileOpenOptions::APPEND);
+}
+
+void SegmentedLog::roll_() {
+  log_.close();
+  index_.close();
+  segments_.push_back(createSegment_(nextRecord_));
+  lastIndexed_ = 0;
+  openActive_();
+  applyRetention();
+}
+
+SegmentedLog::Segment SegmentedLog::createSegment_(uint64_t baseRecord) const {
+  Segment segment;
+  segment.baseRecord = baseRecord;
+  segment.size = 0;
+  segment.logName = path::join(directory_,
+			       segmentFileName(baseRecord, LOG_EXTENSION));
+  segment.indexName = path::join(directory_,
+				 segmentFileName(baseRecord, INDEX_EXTENSION));
+  return segment;
+}
+
+size_t SegmentedLog::findSegment_(uint64_t record) const {
+  auto i = std::upper_bound(
+      segments_.begin(), segments_.end(), record,
+      [](uint64_t r, const Segment& s) { return r < s.baseRecord; }
+  );
+  return (i - segments_.begin()) - 1;
+}
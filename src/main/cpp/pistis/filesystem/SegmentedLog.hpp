@@ -0,0 +1,254 @@
+#ifndef __PISTIS__FILESYSTEM__SEGMENTEDLOG_HPP__
+#define __PISTIS__FILESYSTEM__SEGMENTEDLOG_HPP__
+
+/** @file SegmentedLog.hpp
+ *
+ *  Declaration of pistis::filesystem::SegmentedLog, an append-only log of
+ *  records stored in a directory of fixed-size segment files.
+ */
+
+#include <pistis/filesystem/File.hpp>
+
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+
+namespace pistis {
+  namespace filesystem {
+
+    /** @brief Options that control how a SegmentedLog stores its records */
+    struct SegmentedLogOptions {
+      /** @brief Size at which the active segment is closed and a new
+       *         segment started.
+       */
+      uint64_t maxSegmentSize = 64 * 1024 * 1024;
+
+      /** @brief Minimum number of bytes between entries in a segment's
+       *         offset index.
+       */
+      uint64_t indexInterval = 4096;
+
+      /** @brief Oldest segments are deleted once the log grows beyond this
+       *         many bytes.  Zero means no limit.
+       */
+      uint64_t maxTotalSize = 0;
+
+      /** @brief Segments last modified more than this many seconds ago
+       *         are deleted.  Zero means no limit.
+       */
+      uint64_t maxSegmentAge = 0;
+    };
+
+    /** @brief An append-only log of length-prefixed, checksummed records.
+     *
+     *  Records are numbered consecutively from zero and stored in segment
+     *  files named after the number of the first record they contain.
+     *  Each segment has a sparse offset index, so reading from record N
+     *  is one seek plus a scan of at most SegmentedLogOptions::indexInterval
+     *  bytes.  On disk, each record is a four-byte little-endian length,
+     *  followed by a four-byte CRC-32C of the payload and the payload
+     *  itself.  A torn record at the end of the log (left by a crash in
+     *  the middle of a write) is truncated when the log is opened.
+     *
+     *  A SegmentedLog cannot be copied or moved, because the Readers it
+     *  creates refer back to it.
+     */
+    class SegmentedLog {
+    private:
+      struct IndexEntry {
+	uint64_t record;
+	uint64_t position;
+      };
+
+      struct Segment {
+	uint64_t baseRecord;
+	uint64_t size;
+	std::string logName;
+	std::string indexName;
+	std::vector<IndexEntry> index;
+      };
+
+    public:
+      /** @brief Largest record the four-byte length prefix can describe */
+      static const uint64_t MAX_RECORD_SIZE = 0xFFFFFFFF;
+
+      /** @brief Reads records from a SegmentedLog in order.
+       *
+       *  The reader holds its own descriptor on the segment it is reading,
+       *  so it sees records appended after it was created.  Appending to
+       *  or applying retention to the log may invalidate the reader.  The
+       *  reader refers to the log it came from, so it must not outlive
+       *  that log.
+       */
+      class Reader {
+      public:
+	Reader(const Reader&) = delete;
+	Reader(Reader&&) = default;
+
+	/** @brief Number of the record returned by the last call to next() */
+	uint64_t recordNumber() const { return record_ - 1; }
+
+	/** @brief Payload of the record returned by the last call to next() */
+	const uint8_t* data() const { return data_; }
+
+	/** @brief Size of the record returned by the last call to next() */
+	size_t size() const { return size_; }
+
+	/** @brief Advance to the next record.
+	 *
+	 *  @returns  True if a record was read, false at the end of the log
+	 *  @throws IOError if the record is corrupt or cannot be read
+	 */
+	bool next();
+
+	Reader& operator=(const Reader&) = delete;
+	Reader& operator=(Reader&&) = default;
+
+      private:
+	enum Status { RECORD, END, TORN, CORRUPT };
+
+	const SegmentedLog* log_;
+	size_t segment_;
+	uint64_t record_;
+	uint64_t position_;
+	File file_;
+	std::vector<uint8_t> buffer_;
+	size_t start_;
+	size_t end_;
+	const uint8_t* data_;
+	size_t size_;
+
+	Reader(const SegmentedLog* log, size_t segment, uint64_t position,
+	       uint64_t record);
+
+	Status readRecord_(bool verify);
+	void openSegment_(size_t segment, uint64_t position, uint64_t record);
+	bool fill_(size_t n);
+	uint64_t fileSize_() const;
+
+	friend class SegmentedLog;
+      };
+
+    public:
+      /** @brief Open the log in the given directory, creating the
+       *         directory if it does not exist.
+       */
+      SegmentedLog(const std::string& directory,
+		   const SegmentedLogOptions& options = SegmentedLogOptions());
+      SegmentedLog(const SegmentedLog&) = delete;
+      SegmentedLog(SegmentedLog&&) = delete;
+
+      const std::string& directory() const { return directory_; }
+      const SegmentedLogOptions& options() const { return options_; }
+
+      /** @brief Number of the oldest record still in the log */
+      uint64_t firstRecord() const { return segments_.front().baseRecord; }
+
+      /** @brief Number the next appended record will receive */
+      uint64_t nextRecord() const { return nextRecord_; }
+
+      /** @brief Number of segment files in the log */
+      size_t numSegments() const { return segments_.size(); }
+
+      /** @brief Total size of all segment files, in bytes */
+      uint64_t size() const;
+
+      /** @brief Append one record to the log
+       *
+       *  @returns  The record's number
+       *  @throws IOError if the record is larger than MAX_RECORD_SIZE
+       */
+      uint64_t append(const void* data, size_t n);
+
+      uint64_t append(const std::string& record) {
+	return append(record.data(), record.size());
+      }
+
+      /** @brief Append a sequence of records with as few writes as possible
+       *
+       *  Each record in [begin, end) must have data() and size() methods,
+       *  like std::string.  The records are encoded into one buffer and
+       *  written with a single write per segment.  The sizes of all the
+       *  records are checked before any of them are written.
+       *
+       *  @returns  The number of the first record appended
+       *  @throws IOError if any record is larger than MAX_RECORD_SIZE
+       */
+      template <typename ForwardIterator>
+      uint64_t appendBatch(ForwardIterator begin, ForwardIterator end) {
+	const uint64_t first = nextRecord_;
+	for (ForwardIterator i = begin; i != end; ++i) {
+	  checkRecordSize_(i->size());
+	}
+	for (ForwardIterator i = begin; i != end; ++i) {
+	  encode_(i->data(), i->size());
+	}
+	flushBatch_();
+	return first;
+      }
+
+      /** @brief Flush the active segment and its index to disk */
+      void sync();
+
+      /** @brief Create a Reader positioned at the given record */
+      Reader readFrom(uint64_t record) const;
+
+      /** @brief Read a single record */
+      std::string read(uint64_t record) const;
+
+      /** @brief Call f(recordNumber, data, size) for every record from
+       *         the given record to the end of the log.
+       *
+       *  @returns  The number of the record after the last one passed to f
+       */
+      template <typename Function>
+      uint64_t eachRecord(uint64_t start, Function f) const {
+	Reader reader = readFrom(start);
+	while (reader.next()) {
+	  f(reader.recordNumber(), reader.data(), reader.size());
+	}
+	return reader.record_;
+      }
+
+      /** @brief Delete the oldest segments according to the retention
+       *         options.
+       *
+       *  The active segment is never deleted.  Called automatically
+       *  whenever a new segment is started.
+       *
+       *  @returns  The number of segments deleted
+       */
+      size_t applyRetention();
+
+      /** @brief Close the active segment */
+      void close();
+
+      SegmentedLog& operator=(const SegmentedLog&) = delete;
+      SegmentedLog& operator=(SegmentedLog&&) = delete;
+
+    private:
+      std::string directory_;
+      SegmentedLogOptions options_;
+      std::vector<Segment> segments_;
+      File log_;
+      File index_;
+      uint64_t nextRecord_;
+      uint64_t lastIndexed_;
+      std::vector<uint8_t> batch_;
+      std::vector<IndexEntry> pendingIndex_;
+
+      void checkRecordSize_(uint64_t n) const;
+      void encode_(const void* data, size_t n);
+      void flushBatch_();
+      void recover_(Segment& segment);
+      void openActive_();
+      void roll_();
+
+      Segment createSegment_(uint64_t baseRecord) const;
+      size_t findSegment_(uint64_t record) const;
+    };
+  }
+}
+
+#endif
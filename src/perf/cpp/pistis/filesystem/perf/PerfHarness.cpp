@@ -0,0 +1,192 @@
+/** @file PerfHarness.cpp
+ *
+ *  Runs the end-to-end scenarios over generated corpora, writes the
+ *  results as JSON and optionally compares them against a baseline
+ *  recorded by an earlier run.  Exits with status 2 if any scenario
+ *  regressed by more than the tolerance.
+ */
+
+#include "Results.hpp"
+#include "Scenarios.hpp"
+#include "Workload.hpp"
+
+#include <pistis/filesystem/Path.hpp>
+#include <pistis/filesystem/TestArtifacts.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+
+#include <errno.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+
+using namespace pistis::filesystem;
+using namespace pistis::filesystem::perf;
+
+namespace {
+  struct Options {
+    double scale;
+    size_t repeat;
+    double tolerance;
+    std::string filter;
+    std::string corpusDir;
+    std::string output;
+    std::string baseline;
+    bool keepCorpora;
+
+    Options():
+	scale(1.0), repeat(3), tolerance(0.1), filter(), corpusDir(),
+	output(), baseline(), keepCorpora(true) {
+    }
+  };
+
+  bool startsWith(const std::string& s, const std::string& prefix,
+		  std::string& value) {
+    if (s.compare(0, prefix.size(), prefix) == 0) {
+      value = s.substr(prefix.size());
+      return true;
+    }
+    return false;
+  }
+
+  bool parseOptions(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; ++i) {
+      const std::string arg(argv[i]);
+      std::string value;
+      if (startsWith(arg, "--scale=", value)) {
+	options.scale = ::atof(value.c_str());
+      } else if (startsWith(arg, "--repeat=", value)) {
+	options.repeat = std::max(::atoi(value.c_str()), 1);
+      } else if (startsWith(arg, "--tolerance=", value)) {
+	options.tolerance = ::atof(value.c_str());
+      } else if (startsWith(arg, "--filter=", value)) {
+	options.filter = value;
+      } else if (startsWith(arg, "--corpus-dir=", value)) {
+	options.corpusDir = value;
+      } else if (startsWith(arg, "--output=", value)) {
+	options.output = value;
+      } else if (startsWith(arg, "--baseline=", value)) {
+	options.baseline = value;
+      } else if (arg == "--remove-corpora") {
+	options.keepCorpora = false;
+      } else {
+	std::cerr << "Usage: " << argv[0]
+		  << " [--scale=N] [--repeat=N] [--tolerance=FRACTION]"
+		  << " [--filter=SUBSTRING] [--corpus-dir=DIR]"
+		  << " [--output=FILE] [--baseline=FILE] [--remove-corpora]"
+		  << std::endl;
+	return false;
+      }
+    }
+    if (options.corpusDir.empty()) {
+      options.corpusDir = testing::getScratchFile("corpora");
+    }
+    return options.scale > 0;
+  }
+
+  // Run the scenario options.repeat times and keep the fastest run, which
+  // is the one least disturbed by other activity on the machine
+  ScenarioResult runScenario(const Scenario& scenario, const Corpus& corpus,
+			     const Options& options) {
+    ScenarioResult best;
+    for (size_t i = 0; i < options.repeat; ++i) {
+      auto start = std::chrono::steady_clock::now();
+      ScenarioResult result = scenario.run(corpus);
+      auto end = std::chrono::steady_clock::now();
+      result.scenario = scenario.name;
+      result.seconds = std::chrono::duration<double>(end - start).count();
+      if (!i || (result.seconds < best.seconds)) {
+	best = result;
+      }
+    }
+    return best;
+  }
+
+  void printResult(const ScenarioResult& result) {
+    std::cout << std::left << std::setw(16) << result.scenario << std::right
+	      << std::fixed << std::setprecision(3) << std::setw(10)
+	      << result.seconds << " s" << std::setprecision(1)
+	      << std::setw(12) << (result.bytesPerSecond() / 1e6) << " MB/s"
+	      << std::setw(14) << result.operationsPerSecond() << " ops/s"
+	      << std::endl;
+  }
+
+  // Returns true if any scenario regressed.  Scenarios missing from the
+  // current run only count when all scenarios were supposed to run.
+  bool reportComparisons(const std::vector<Comparison>& comparisons,
+			 const Options& options) {
+    bool regressed = false;
+    std::cout << std::endl << "Comparison with baseline (tolerance "
+	      << std::setprecision(1) << (options.tolerance * 100) << "%)"
+	      << std::endl;
+    for (const Comparison& c : comparisons) {
+      std::cout << std::left << std::setw(16) << c.scenario << std::right
+		<< std::setw(8) << std::showpos << std::setprecision(1)
+		<< (c.change() * 100) << std::noshowpos << "%  "
+		<< statusName(c.status) << std::endl;
+      regressed = regressed || (c.status == Comparison::REGRESSION) ||
+		      ((c.status == Comparison::MISSING) &&
+		       options.filter.empty());
+    }
+    return regressed;
+  }
+}
+
+int main(int argc, char** argv) {
+  Options options;
+  if (!parseOptions(argc, argv, options)) {
+    return 1;
+  }
+
+#ifndef __OPTIMIZE__
+  std::cout << "WARNING: The harness was compiled without optimization.  "
+	    << "Rebuild with CONFIGURATION=RELEASE." << std::endl;
+#endif
+
+  try {
+    std::vector<ScenarioResult> results;
+    std::vector<std::string> corpusRoots;
+
+    if ((::mkdir(options.corpusDir.c_str(), 0777) < 0) &&
+	(errno != EEXIST)) {
+      std::cerr << "Cannot create " << options.corpusDir << std::endl;
+      return 1;
+    }
+
+    for (const Scenario& scenario : standardScenarios(options.scale)) {
+      if (scenario.name.find(options.filter) == std::string::npos) {
+	continue;
+      }
+      Corpus corpus = generateCorpus(scenario.corpus, options.corpusDir);
+      if (std::find(corpusRoots.begin(), corpusRoots.end(), corpus.root) ==
+	      corpusRoots.end()) {
+	corpusRoots.push_back(corpus.root);
+      }
+      results.push_back(runScenario(scenario, corpus, options));
+      printResult(results.back());
+    }
+
+    if (!options.output.empty()) {
+      writeResults(options.output, results);
+    }
+    if (!options.keepCorpora) {
+      for (const std::string& root : corpusRoots) {
+	removeTree(root);
+      }
+    }
+    if (!options.baseline.empty()) {
+      std::vector<ScenarioResult> baseline = readResults(options.baseline);
+      if (reportComparisons(compareResults(baseline, results,
+					   options.tolerance),
+			    options)) {
+	return 2;
+      }
+    }
+  } catch (const std::exception& e) {
+    std::cerr << "Performance run failed: " << e.what() << std::endl;
+    return 1;
+  }
+  return 0;
+}
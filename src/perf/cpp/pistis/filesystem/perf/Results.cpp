@@ -0,0 +1,270 @@
+#include "Results.hpp"
+
+#include <pistis/filesystem/File.hpp>
+#include <pistis/exceptions/IOError.hpp>
+
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <sstream>
+
+#include <ctype.h>
+#include <stdlib.h>
+
+using namespace pistis::exceptions;
+using namespace pistis::filesystem;
+using namespace pistis::filesystem::perf;
+
+namespace {
+  std::string quote(const std::string& s) {
+    std::string result("\"");
+    for (char c : s) {
+      if ((c == '"') || (c == '\\')) {
+	result.push_back('\\');
+      }
+      result.push_back(c);
+    }
+    result.push_back('"');
+    return result;
+  }
+
+  // Just enough of a JSON parser to read back the documents
+  // writeResults() produces: an object whose "results" member is an array
+  // of flat objects with string and number values.  Other members are
+  // skipped.
+  class JsonReader {
+  public:
+    JsonReader(const std::string& fileName, const std::string& text):
+	fileName_(fileName), text_(text), p_(0) {
+    }
+
+    std::vector<ScenarioResult> read() {
+      std::vector<ScenarioResult> results;
+      expect_('{');
+      if (!consume_('}')) {
+	do {
+	  std::string key = readString_();
+	  expect_(':');
+	  if (key == "results") {
+	    readResultArray_(results);
+	  } else {
+	    skipValue_();
+	  }
+	} while (consume_(','));
+	expect_('}');
+      }
+      return results;
+    }
+
+  private:
+    const std::string& fileName_;
+    const std::string& text_;
+    size_t p_;
+
+    void readResultArray_(std::vector<ScenarioResult>& results) {
+      expect_('[');
+      if (consume_(']')) {
+	return;
+      }
+      do {
+	results.push_back(readResult_());
+      } while (consume_(','));
+      expect_(']');
+    }
+
+    ScenarioResult readResult_() {
+      ScenarioResult result;
+      expect_('{');
+      if (!consume_('}')) {
+	do {
+	  std::string key = readString_();
+	  expect_(':');
+	  if (key == "scenario") {
+	    result.scenario = readString_();
+	  } else if (key == "bytes") {
+	    result.bytes = (uint64_t)readNumber_();
+	  } else if (key == "operations") {
+	    result.operations = (uint64_t)readNumber_();
+	  } else if (key == "seconds") {
+	    result.seconds = readNumber_();
+	  } else {
+	    skipValue_();
+	  }
+	} while (consume_(','));
+	expect_('}');
+      }
+      if (result.scenario.empty()) {
+	error_("Result has no scenario name");
+      }
+      return result;
+    }
+
+    std::string readString_() {
+      std::string s;
+      expect_('"');
+      while ((p_ < text_.size()) && (text_[p_] != '"')) {
+	if ((text_[p_] == '\\') && (p_ + 1 < text_.size())) {
+	  ++p_;
+	}
+	s.push_back(text_[p_++]);
+      }
+      expect_('"');
+      return s;
+    }
+
+    double readNumber_() {
+      skipWhitespace_();
+      const char* start = text_.c_str() + p_;
+      char* end = nullptr;
+      double value = ::strtod(start, &end);
+      if (end == start) {
+	error_("Expected a number");
+      }
+      p_ += end - start;
+      return value;
+    }
+
+    void skipValue_() {
+      skipWhitespace_();
+      if (p_ >= text_.size()) {
+	error_("Unexpected end of document");
+      } else if (text_[p_] == '"') {
+	readString_();
+      } else if ((text_[p_] == '{') || (text_[p_] == '[')) {
+	const char close = (text_[p_] == '{') ? '}' : ']';
+	++p_;
+	if (!consume_(close)) {
+	  do {
+	    if (close == '}') {
+	      readString_();
+	      expect_(':');
+	    }
+	    skipValue_();
+	  } while (consume_(','));
+	  expect_(close);
+	}
+      } else if (isalpha(text_[p_])) {
+	while ((p_ < text_.size()) && isalpha(text_[p_])) {
+	  ++p_;
+	}
+      } else {
+	readNumber_();
+      }
+    }
+
+    void skipWhitespace_() {
+      while ((p_ < text_.size()) && isspace(text_[p_])) {
+	++p_;
+      }
+    }
+
+    bool consume_(char c) {
+      skipWhitespace_();
+      if ((p_ < text_.size()) && (text_[p_] == c)) {
+	++p_;
+	return true;
+      }
+      return false;
+    }
+
+    void expect_(char c) {
+      if (!consume_(c)) {
+	error_(std::string("Expected '") + c + "'");
+      }
+    }
+
+    void error_(const std::string& msg) {
+      std::ostringstream out;
+      out << "Cannot read results from " << fileName_ << ": " << msg
+	  << " at offset " << p_;
+      throw IOError(out.str(), PISTIS_EX_HERE);
+    }
+  };
+}
+
+void pistis::filesystem::perf::writeResults(
+    std::ostream& out, const std::vector<ScenarioResult>& results
+) {
+  out << "{\n  \"results\": [";
+  for (auto i = results.begin(); i != results.end(); ++i) {
+    out << (i == results.begin() ? "\n" : ",\n")
+	<< "    { \"scenario\": " << quote(i->scenario)
+	<< ", \"bytes\": " << i->bytes
+	<< ", \"operations\": " << i->operations
+	<< std::setprecision(6) << std::fixed
+	<< ", \"seconds\": " << i->seconds
+	<< std::setprecision(1)
+	<< ", \"bytesPerSecond\": " << i->bytesPerSecond()
+	<< ", \"operationsPerSecond\": " << i->operationsPerSecond()
+	<< " }";
+  }
+  out << "\n  ]\n}\n";
+}
+
+void pistis::filesystem::perf::writeResults(
+    const std::string& fileName, const std::vector<ScenarioResult>& results
+) {
+  std::ofstream out(fileName);
+  writeResults(out, results);
+  if (!out) {
+    throw IOError("Cannot write results to " + fileName, PISTIS_EX_HERE);
+  }
+}
+
+std::vector<ScenarioResult> pistis::filesystem::perf::readResults(
+    const std::string& fileName
+) {
+  File file = File::open(fileName, FileCreationMode::OPEN_ONLY,
+			 FileAccessMode::READ_ONLY);
+  std::string text;
+  char buffer[4096];
+  size_t n;
+  while ((n = file.read(buffer, sizeof(buffer))) != 0) {
+    text.append(buffer, n);
+  }
+  return JsonReader(fileName, text).read();
+}
+
+std::vector<Comparison> pistis::filesystem::perf::compareResults(
+    const std::vector<ScenarioResult>& baseline,
+    const std::vector<ScenarioResult>& current,
+    double tolerance
+) {
+  std::map<std::string, const ScenarioResult*> currentByName;
+  std::vector<Comparison> comparisons;
+
+  for (const ScenarioResult& r : current) {
+    currentByName[r.scenario] = &r;
+  }
+  for (const ScenarioResult& b : baseline) {
+    auto i = currentByName.find(b.scenario);
+    Comparison c;
+    c.scenario = b.scenario;
+    c.baseline = b.throughput();
+    if (i == currentByName.end()) {
+      c.current = 0.0;
+      c.status = Comparison::MISSING;
+    } else {
+      c.current = i->second->throughput();
+      if (c.current < c.baseline * (1.0 - tolerance)) {
+	c.status = Comparison::REGRESSION;
+      } else if (c.current > c.baseline * (1.0 + tolerance)) {
+	c.status = Comparison::IMPROVEMENT;
+      } else {
+	c.status = Comparison::OK;
+      }
+    }
+    comparisons.push_back(c);
+  }
+  return comparisons;
+}
+
+const char* pistis::filesystem::perf::statusName(Comparison::Status status) {
+  switch (status) {
+    case Comparison::OK: return "ok";
+    case Comparison::IMPROVEMENT: return "improvement";
+    case Comparison::REGRESSION: return "REGRESSION";
+    case Comparison::MISSING: return "MISSING";
+  }
+  return "unknown";
+}
@@ -0,0 +1,102 @@
+#ifndef __PISTIS__FILESYSTEM__PERF__RESULTS_HPP__
+#define __PISTIS__FILESYSTEM__PERF__RESULTS_HPP__
+
+/** @file Results.hpp
+ *
+ *  Scenario results, their JSON representation, and comparison against
+ *  a stored baseline.
+ */
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+
+namespace pistis {
+  namespace filesystem {
+    namespace perf {
+
+      /** @brief The outcome of one run of a scenario */
+      struct ScenarioResult {
+	std::string scenario;
+	uint64_t bytes;
+	uint64_t operations;
+	double seconds;
+
+	ScenarioResult(): scenario(), bytes(0), operations(0), seconds(0) { }
+	ScenarioResult(const std::string& scenario, uint64_t bytes,
+		       uint64_t operations, double seconds):
+	    scenario(scenario), bytes(bytes), operations(operations),
+	    seconds(seconds) {
+	}
+
+	double bytesPerSecond() const {
+	  return seconds > 0 ? bytes / seconds : 0.0;
+	}
+
+	double operationsPerSecond() const {
+	  return seconds > 0 ? operations / seconds : 0.0;
+	}
+
+	/** @brief The rate compared against the baseline.
+	 *
+	 *  Bytes per second for scenarios that report a byte count, and
+	 *  operations per second for those that don't.
+	 */
+	double throughput() const {
+	  return bytes ? bytesPerSecond() : operationsPerSecond();
+	}
+      };
+
+      /** @brief Write results as a JSON document */
+      void writeResults(std::ostream& out,
+			const std::vector<ScenarioResult>& results);
+
+      /** @brief Write results to the named file as a JSON document */
+      void writeResults(const std::string& fileName,
+			const std::vector<ScenarioResult>& results);
+
+      /** @brief Read results written by writeResults().
+       *
+       *  Throws IOError if the file can't be read or isn't in the format
+       *  writeResults() produces.
+       */
+      std::vector<ScenarioResult> readResults(const std::string& fileName);
+
+      /** @brief How a scenario's throughput compares to its baseline */
+      struct Comparison {
+	enum Status { OK, IMPROVEMENT, REGRESSION, MISSING };
+
+	std::string scenario;
+	double baseline;
+	double current;
+	Status status;
+
+	/** @brief Relative change from the baseline, e.g. -0.1 for 10%
+	 *         slower
+	 */
+	double change() const {
+	  return baseline > 0 ? (current - baseline) / baseline : 0.0;
+	}
+      };
+
+      /** @brief Compare current results against a baseline.
+       *
+       *  A scenario regresses when its throughput falls more than
+       *  tolerance (a fraction of the baseline, e.g. 0.1 for 10%) below
+       *  the baseline, and improves when it rises more than tolerance
+       *  above it.  Scenarios in the baseline that have no current result
+       *  are reported as MISSING.
+       */
+      std::vector<Comparison> compareResults(
+	  const std::vector<ScenarioResult>& baseline,
+	  const std::vector<ScenarioResult>& current,
+	  double tolerance
+      );
+
+      const char* statusName(Comparison::Status status);
+    }
+  }
+}
+#endif
@@ -0,0 +1,131 @@
+#include "Scenarios.hpp"
+
+#include <pistis/filesystem/File.hpp>
+#include <pistis/filesystem/Path.hpp>
+
+#include <algorithm>
+#include <memory>
+#include <random>
+
+using namespace pistis::filesystem;
+using namespace pistis::filesystem::perf;
+
+namespace {
+  static const size_t RANDOM_READ_SIZE = 4096;
+  static const size_t RANDOM_READ_COUNT = 20000;
+  static const size_t SCAN_CHUNK_SIZE = 65536;
+
+  File openForReading(const std::string& name) {
+    return File::open(name, FileCreationMode::OPEN_ONLY,
+		      FileAccessMode::READ_ONLY);
+  }
+
+  uint64_t scaled(uint64_t n, double scale) {
+    return std::max<uint64_t>((uint64_t)(n * scale), 1);
+  }
+
+  // Read every line of every file
+  ScenarioResult fullScan(const Corpus& corpus) {
+    ScenarioResult result;
+    for (const std::string& name : corpus.files) {
+      File file = openForReading(name);
+      file.eachLine([&result](const std::string& line) {
+	  result.bytes += line.size();
+	  ++result.operations;
+      });
+    }
+    return result;
+  }
+
+  // Read every file in large chunks
+  ScenarioResult chunkScan(const Corpus& corpus) {
+    std::unique_ptr<uint8_t[]> buffer(new uint8_t[SCAN_CHUNK_SIZE]);
+    ScenarioResult result;
+    for (const std::string& name : corpus.files) {
+      File file = openForReading(name);
+      file.eachChunk(SCAN_CHUNK_SIZE, buffer.get(),
+		     [&result](uint8_t*, size_t n) {
+	  result.bytes += n;
+	  ++result.operations;
+      });
+    }
+    return result;
+  }
+
+  // Seek to random offsets and read a page at each one
+  ScenarioResult randomReads(const Corpus& corpus) {
+    std::vector<File> files;
+    std::vector<uint64_t> sizes;
+    std::mt19937_64 random(7);
+    uint8_t buffer[RANDOM_READ_SIZE];
+    ScenarioResult result;
+
+    for (const std::string& name : corpus.files) {
+      files.push_back(openForReading(name));
+      sizes.push_back(path::fileSize(name));
+    }
+    std::uniform_int_distribution<size_t> fileIndex(0, files.size() - 1);
+    for (size_t i = 0; i < RANDOM_READ_COUNT; ++i) {
+      const size_t f = fileIndex(random);
+      const uint64_t maxOffset =
+	  sizes[f] > RANDOM_READ_SIZE ? sizes[f] - RANDOM_READ_SIZE : 0;
+      std::uniform_int_distribution<uint64_t> offset(0, maxOffset);
+      files[f].seek(FileOrigin::START, offset(random));
+      result.bytes += files[f].read(buffer, sizeof(buffer));
+      ++result.operations;
+    }
+    return result;
+  }
+
+  // Open, read and close each of many small files
+  ScenarioResult smallFiles(const Corpus& corpus) {
+    ScenarioResult result;
+    for (const std::string& name : corpus.files) {
+      File file = openForReading(name);
+      for (const std::string& line : file.readLines()) {
+	result.bytes += line.size();
+      }
+      ++result.operations;
+    }
+    return result;
+  }
+
+  // Resolve and read every file in a deep directory tree, exercising the
+  // path functions as well as open()
+  ScenarioResult deepTree(const Corpus& corpus) {
+    ScenarioResult result;
+    for (const std::string& name : corpus.files) {
+      const std::string relative = path::relativePath(name, corpus.root);
+      const std::string resolved =
+	  path::normalizePath(path::join(corpus.root, relative));
+      if (path::isFile(resolved)) {
+	File file = openForReading(resolved);
+	file.eachLine([&result](const std::string& line) {
+	    result.bytes += line.size();
+	});
+	++result.operations;
+      }
+    }
+    return result;
+  }
+}
+
+std::vector<Scenario> pistis::filesystem::perf::standardScenarios(
+    double scale
+) {
+  CorpusSpec large("large", 4, scaled(32 * 1024 * 1024, scale));
+  CorpusSpec small("small", scaled(4096, scale), 4096);
+  CorpusSpec deep("deep", scaled(1024, scale), 1024);
+
+  small.filesPerDirectory = 512;
+  deep.directoryDepth = 8;
+  deep.filesPerDirectory = 4;
+
+  return std::vector<Scenario>{
+    Scenario{ "fullScan", large, fullScan },
+    Scenario{ "chunkScan", large, chunkScan },
+    Scenario{ "randomReads", large, randomReads },
+    Scenario{ "smallFiles", small, smallFiles },
+    Scenario{ "deepTree", deep, deepTree }
+  };
+}
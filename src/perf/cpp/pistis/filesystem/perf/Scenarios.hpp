@@ -0,0 +1,41 @@
+#ifndef __PISTIS__FILESYSTEM__PERF__SCENARIOS_HPP__
+#define __PISTIS__FILESYSTEM__PERF__SCENARIOS_HPP__
+
+/** @file Scenarios.hpp
+ *
+ *  End-to-end scenarios run by the throughput regression harness.
+ */
+
+#include "Results.hpp"
+#include "Workload.hpp"
+
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace pistis {
+  namespace filesystem {
+    namespace perf {
+
+      /** @brief An end-to-end workload over a generated corpus.
+       *
+       *  The run function performs the workload once and returns the
+       *  number of bytes and operations it processed.  The harness times
+       *  it and fills in ScenarioResult::seconds.
+       */
+      struct Scenario {
+	std::string name;
+	CorpusSpec corpus;
+	std::function<ScenarioResult (const Corpus&)> run;
+      };
+
+      /** @brief The standard set of scenarios.
+       *
+       *  scale multiplies the size of every corpus.  At scale 1 the
+       *  largest corpus is 128 MB; at scale 32 it is 4 GB.
+       */
+      std::vector<Scenario> standardScenarios(double scale);
+    }
+  }
+}
+#endif
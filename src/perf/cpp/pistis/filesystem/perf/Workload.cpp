@@ -0,0 +1,184 @@
+#include "Workload.hpp"
+
+#include <pistis/filesystem/File.hpp>
+#include <pistis/filesystem/Path.hpp>
+#include <pistis/exceptions/IOError.hpp>
+
+#include <algorithm>
+#include <random>
+#include <sstream>
+
+#include <errno.h>
+#include <ftw.h>
+#include <stdio.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+using namespace pistis::exceptions;
+using namespace pistis::filesystem;
+using namespace pistis::filesystem::perf;
+
+namespace {
+  static const char MANIFEST_NAME[] = ".corpus";
+  static const size_t WRITE_CHUNK_SIZE = 1024 * 1024;
+  static const size_t DIRECTORY_FANOUT = 8;
+
+  void makeDirectory(const std::string& dir) {
+    if ((::mkdir(dir.c_str(), 0777) < 0) && (errno != EEXIST)) {
+      throw IOError::fromSystemError("Cannot create directory " + dir +
+				     " (#ERR#)", PISTIS_EX_HERE);
+    }
+  }
+
+  // Returns the directory holding file n, relative to the corpus root.
+  // Leaf directories are numbered consecutively, and all but the last
+  // path component are chosen so the tree fans out DIRECTORY_FANOUT ways
+  // at each level.
+  std::string directoryFor(const CorpusSpec& spec, size_t n) {
+    size_t leaf = n / spec.filesPerDirectory;
+    std::string dir;
+    for (size_t level = 1; level < spec.directoryDepth; ++level) {
+      dir += "d" + std::to_string(leaf % DIRECTORY_FANOUT) + "/";
+      leaf /= DIRECTORY_FANOUT;
+    }
+    if (spec.directoryDepth) {
+      dir += "d" + std::to_string(leaf) + "/";
+    }
+    return dir;
+  }
+
+  std::string fileNameFor(const CorpusSpec& spec, size_t n) {
+    char name[32];
+    ::snprintf(name, sizeof(name), "file%08zu.txt", n);
+    return directoryFor(spec, n) + name;
+  }
+
+  void createDirectoriesFor(const std::string& root,
+			    const std::string& relativeDir) {
+    size_t i = relativeDir.find('/');
+    while (i != std::string::npos) {
+      makeDirectory(root + "/" + relativeDir.substr(0, i));
+      i = relativeDir.find('/', i + 1);
+    }
+  }
+
+  bool isExistingCorpus(const std::string& manifest,
+			const std::string& description) {
+    if (!path::exists(manifest)) {
+      return false;
+    }
+    File file = File::open(manifest, FileCreationMode::OPEN_ONLY,
+			   FileAccessMode::READ_ONLY);
+    return file.readLine() == description + "\n";
+  }
+
+  void writeAll(File& file, const std::string& data) {
+    const char* p = data.data();
+    size_t n = data.size();
+    while (n) {
+      size_t nWritten = file.write(p, n);
+      p += nWritten;
+      n -= nWritten;
+    }
+  }
+
+  void generateFile(const CorpusSpec& spec, const std::string& fileName,
+		    std::mt19937_64& random) {
+    std::uniform_int_distribution<size_t> shortLength(spec.minLineLength,
+						      spec.maxLineLength);
+    std::uniform_int_distribution<size_t> longLength(spec.maxLineLength,
+						     spec.longLineLength);
+    std::uniform_real_distribution<double> lineKind(0.0, 1.0);
+    std::uniform_int_distribution<int> letter('a', 'z');
+    File file = File::open(fileName, FileAccessMode::WRITE_ONLY,
+			   FileOpenOptions::TRUNCATE);
+    std::string text;
+    uint64_t written = 0;
+
+    text.reserve(WRITE_CHUNK_SIZE + spec.longLineLength + 1);
+    while (written < spec.fileSize) {
+      size_t n = (lineKind(random) < spec.longLineFraction)
+		     ? longLength(random) : shortLength(random);
+      n = std::min<uint64_t>(n, spec.fileSize - written - 1);
+      for (size_t i = 0; i < n; ++i) {
+	text.push_back((i % 8) == 7 ? ' ' : (char)letter(random));
+      }
+      text.push_back('\n');
+      written += n + 1;
+      if (text.size() >= WRITE_CHUNK_SIZE) {
+	writeAll(file, text);
+	text.clear();
+      }
+    }
+    writeAll(file, text);
+  }
+
+  int removeEntry(const char* name, const struct stat*, int,
+		  struct FTW*) {
+    ::remove(name);
+    return 0;
+  }
+}
+
+CorpusSpec::CorpusSpec(const std::string& name, size_t fileCount,
+		       uint64_t fileSize):
+    name(name), fileCount(fileCount), fileSize(fileSize), minLineLength(20),
+    maxLineLength(120), longLineLength(4096), longLineFraction(0.01),
+    directoryDepth(1), filesPerDirectory(256), seed(42) {
+}
+
+std::string CorpusSpec::describe() const {
+  std::ostringstream out;
+  out << "name=" << name << " fileCount=" << fileCount
+      << " fileSize=" << fileSize << " minLineLength=" << minLineLength
+      << " maxLineLength=" << maxLineLength
+      << " longLineLength=" << longLineLength
+      << " longLineFraction=" << longLineFraction
+      << " directoryDepth=" << directoryDepth
+      << " filesPerDirectory=" << filesPerDirectory << " seed=" << seed;
+  return out.str();
+}
+
+Corpus pistis::filesystem::perf::generateCorpus(const CorpusSpec& spec,
+						const std::string& baseDir) {
+  Corpus corpus;
+  const std::string description = spec.describe();
+  const std::string manifest = path::join(baseDir, spec.name, MANIFEST_NAME);
+  const bool reuse = isExistingCorpus(manifest, description);
+
+  corpus.root = path::join(baseDir, spec.name);
+  corpus.totalBytes = 0;
+  if (!reuse) {
+    removeTree(corpus.root);
+    makeDirectory(corpus.root);
+  }
+
+  std::mt19937_64 random(spec.seed);
+  std::string lastDir;
+  for (size_t i = 0; i < spec.fileCount; ++i) {
+    const std::string relativeName = fileNameFor(spec, i);
+    const std::string fileName = path::join(corpus.root, relativeName);
+    if (!reuse) {
+      const std::string dir = directoryFor(spec, i);
+      if (dir != lastDir) {
+	createDirectoriesFor(corpus.root, dir);
+	lastDir = dir;
+      }
+      generateFile(spec, fileName, random);
+    }
+    corpus.files.push_back(fileName);
+    corpus.totalBytes += path::fileSize(fileName);
+  }
+
+  if (!reuse) {
+    // Written last, so an interrupted run is regenerated next time
+    File file = File::open(manifest, FileAccessMode::WRITE_ONLY,
+			   FileOpenOptions::TRUNCATE);
+    writeAll(file, description + "\n");
+  }
+  return corpus;
+}
+
+void pistis::filesystem::perf::removeTree(const std::string& dir) {
+  ::nftw(dir.c_str(), removeEntry, 64, FTW_DEPTH | FTW_PHYS);
+}
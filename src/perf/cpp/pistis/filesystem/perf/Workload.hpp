@@ -0,0 +1,75 @@
+#ifndef __PISTIS__FILESYSTEM__PERF__WORKLOAD_HPP__
+#define __PISTIS__FILESYSTEM__PERF__WORKLOAD_HPP__
+
+/** @file Workload.hpp
+ *
+ *  Generates reproducible corpora of text files for the throughput
+ *  regression harness.
+ */
+
+#include <string>
+#include <vector>
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace pistis {
+  namespace filesystem {
+    namespace perf {
+
+      /** @brief Describes a corpus of generated text files.
+       *
+       *  Lines are drawn from two uniform distributions: "short" lines
+       *  between minLineLength and maxLineLength bytes long, and "long"
+       *  lines between maxLineLength and longLineLength bytes long that
+       *  occur with probability longLineFraction.  Files are spread over
+       *  a tree of directories directoryDepth levels deep, with at most
+       *  filesPerDirectory files in each leaf directory.  The same spec
+       *  always produces the same corpus.
+       */
+      struct CorpusSpec {
+	std::string name;
+	size_t fileCount;
+	uint64_t fileSize;
+	size_t minLineLength;
+	size_t maxLineLength;
+	size_t longLineLength;
+	double longLineFraction;
+	size_t directoryDepth;
+	size_t filesPerDirectory;
+	uint64_t seed;
+
+	CorpusSpec(const std::string& name, size_t fileCount,
+		   uint64_t fileSize);
+
+	/** @brief A one-line description of the spec.
+	 *
+	 *  Written to the corpus directory so an existing corpus is reused
+	 *  only if it was generated from an identical spec.
+	 */
+	std::string describe() const;
+      };
+
+      /** @brief A corpus generated from a CorpusSpec */
+      struct Corpus {
+	std::string root;
+	std::vector<std::string> files;
+	uint64_t totalBytes;
+      };
+
+      /** @brief Generate the corpus described by spec under baseDir.
+       *
+       *  The corpus is written to baseDir/spec.name.  If that directory
+       *  already holds a complete corpus for the same spec, it is reused
+       *  rather than regenerated, so multi-gigabyte corpora are built
+       *  only once.
+       */
+      Corpus generateCorpus(const CorpusSpec& spec,
+			    const std::string& baseDir);
+
+      /** @brief Remove dir and everything in it.  Errors are ignored. */
+      void removeTree(const std::string& dir);
+    }
+  }
+}
+#endif
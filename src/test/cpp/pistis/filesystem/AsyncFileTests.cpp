@@ -0,0 +1,162 @@
+#include <pistis/filesystem/AsyncFile.hpp>
+
+// The coroutine API only exists when building with CXX_STANDARD=c++20
+#if (__cplusplus >= 202002L) && defined(__cpp_impl_coroutine)
+
+#include <pistis/exceptions/IOError.hpp>
+
+#include "TestArtifacts.hpp"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+using namespace pistis::exceptions;
+using namespace pistis::filesystem;
+namespace pt = pistis::filesystem::testing;
+
+namespace {
+  static const std::vector<std::string> TEST_FILE_1_LINES{
+      "The text in this file is used by unit tests to verify the File "
+      "implementation.\n",
+      "This is the second line.\n",
+      "This is the third line.\n"
+  };
+
+  // A pipe whose ends are non-blocking Files
+  struct Pipe {
+    File reader;
+    File writer;
+
+    Pipe(): reader(-1), writer(-1) {
+      int fds[2];
+      if (::pipe(fds) < 0) {
+	throw IOError::fromSystemError("Call to pipe() failed: #ERR#",
+				       PISTIS_EX_HERE);
+      }
+      reader = File(fds[0], "pipe reader");
+      writer = File(fds[1], "pipe writer");
+      reader.setNonBlocking(true);
+      writer.setNonBlocking(true);
+    }
+  };
+
+  Task<void> readAllLines(AsyncExecutor& executor, File& file,
+			  std::vector<std::string>& lines) {
+    std::string line;
+    while (co_await asyncReadLine(executor, file, line)) {
+      lines.push_back(line);
+    }
+  }
+
+  Task<void> writeLines(AsyncExecutor& executor, File& file, int id,
+			int n) {
+    for (int i = 0; i < n; ++i) {
+      const std::string line = std::to_string(id) + ":" + std::to_string(i) +
+			       "\n";
+      size_t offset = 0;
+      while (offset < line.size()) {
+	offset += co_await asyncWrite(executor, file, line.data() + offset,
+				      line.size() - offset);
+      }
+    }
+    file.close();
+  }
+
+  Task<int> add(int x, int y) {
+    co_return x + y;
+  }
+
+  Task<void> throwError() {
+    co_await add(1, 2);
+    throw IOError("Test error", PISTIS_EX_HERE);
+  }
+}
+
+TEST(AsyncFileTests, ReadLinesFromRegularFile) {
+  AsyncExecutor executor;
+  File file = File::open(pt::getResourcePath("test_file_1.txt"),
+			 FileCreationMode::OPEN_ONLY,
+			 FileAccessMode::READ_ONLY);
+  std::vector<std::string> lines;
+
+  executor.spawn(readAllLines(executor, file, lines));
+  executor.run();
+  EXPECT_EQ(TEST_FILE_1_LINES, lines);
+}
+
+TEST(AsyncFileTests, ManyPipesOnOneThread) {
+  static const int NUM_PIPES = 100;
+  static const int NUM_LINES = 50;
+  AsyncExecutor executor;
+  std::vector<Pipe> pipes(NUM_PIPES);
+  std::vector<std::vector<std::string>> received(NUM_PIPES);
+
+  for (int i = 0; i < NUM_PIPES; ++i) {
+    executor.spawn(readAllLines(executor, pipes[i].reader, received[i]));
+    executor.spawn(writeLines(executor, pipes[i].writer, i, NUM_LINES));
+  }
+  executor.run();
+
+  for (int i = 0; i < NUM_PIPES; ++i) {
+    ASSERT_EQ(NUM_LINES, received[i].size());
+    for (int j = 0; j < NUM_LINES; ++j) {
+      EXPECT_EQ(std::to_string(i) + ":" + std::to_string(j) + "\n",
+		received[i][j]);
+    }
+  }
+}
+
+TEST(AsyncFileTests, ReadAndWriteRegularFiles) {
+  const std::string fileName = pt::getScratchFile("async_file_test.txt");
+  static const std::string TEXT("Written and read by coroutines.\n");
+  AsyncExecutor executor(2);
+  std::string text;
+
+  pt::removeFile(fileName);
+  executor.spawn([&]() -> Task<void> {
+    File out = File::open(fileName, FileAccessMode::WRITE_ONLY);
+    EXPECT_EQ(TEXT.size(),
+	      co_await asyncWrite(executor, out, TEXT.data(), TEXT.size()));
+    out.close();
+
+    File in = File::open(fileName, FileCreationMode::OPEN_ONLY,
+			 FileAccessMode::READ_ONLY);
+    char buffer[256];
+    size_t n;
+    while ((n = co_await asyncRead(executor, in, buffer, sizeof(buffer)))) {
+      text.append(buffer, n);
+    }
+  }());
+  executor.run();
+  EXPECT_EQ(TEXT, text);
+  pt::removeFile(fileName);
+}
+
+TEST(AsyncFileTests, TaskReturnsValue) {
+  AsyncExecutor executor;
+  int result = 0;
+
+  executor.spawn([&]() -> Task<void> {
+    result = co_await add(2, 3);
+  }());
+  executor.run();
+  EXPECT_EQ(5, result);
+}
+
+TEST(AsyncFileTests, RunRethrowsTaskError) {
+  AsyncExecutor executor;
+  bool otherTaskRan = false;
+
+  executor.spawn(throwError());
+  executor.spawn([&]() -> Task<void> {
+    otherTaskRan = (co_await add(1, 1)) == 2;
+  }());
+  EXPECT_THROW(executor.run(), IOError);
+  EXPECT_TRUE(otherTaskRan);
+}
+
+#endif
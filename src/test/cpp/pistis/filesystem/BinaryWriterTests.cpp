@@ -0,0 +1,142 @@
+#include <pistis/filesystem/BinaryWriter.hpp>
+#include <pistis/exceptions/IOError.hpp>
+
+#include "TestArtifacts.hpp"
+
+#include <gtest/gtest.h>
+
+#include <limits>
+#include <string>
+#include <vector>
+
+using namespace pistis::exceptions;
+using namespace pistis::filesystem;
+namespace pt = pistis::filesystem::testing;
+
+namespace {
+  static const std::string TEST_FILE("binary_writer_test.dat");
+
+  class BinaryWriterTests : public ::testing::Test {
+  protected:
+    std::string fileName;
+
+    virtual void SetUp() {
+      fileName = pt::getScratchFile(TEST_FILE);
+      pt::removeFile(fileName);
+    }
+
+    virtual void TearDown() {
+      pt::removeFile(fileName);
+    }
+
+    File openForWriting() {
+      return File::open(fileName, FileAccessMode::WRITE_ONLY,
+			FileOpenOptions::TRUNCATE);
+    }
+
+    // Open with a small read buffer, so values straddle buffer boundaries
+    File openForReading() {
+      return File::open(fileName, FileCreationMode::OPEN_ONLY,
+			FileAccessMode::READ_ONLY, FileOpenOptions::NONE,
+			FilePermissions::ALL_RW, 7, 64);
+    }
+  };
+}
+
+TEST_F(BinaryWriterTests, RoundTrip) {
+  static const uint64_t VARINTS[] = {
+    0, 1, 127, 128, 300, 16384, UINT32_MAX, UINT64_MAX
+  };
+  {
+    File file = openForWriting();
+    BinaryWriter writer(file, 16);
+    for (int i = 0; i < 100; ++i) {
+      writer.writeU8((uint8_t)i);
+      writer.writeU16LE((uint16_t)(i * 300));
+      writer.writeU16BE((uint16_t)(i * 301));
+      writer.writeU32LE((uint32_t)i * 70000u);
+      writer.writeU32BE((uint32_t)i * 70001u);
+      writer.writeU64LE((uint64_t)i << 40);
+      writer.writeU64BE((uint64_t)i << 41);
+      writer.writeF32LE(i * 0.5f);
+      writer.writeF64BE(i * -0.25);
+    }
+    for (uint64_t v : VARINTS) {
+      writer.writeVarint(v);
+    }
+    writer.writeSignedVarint(-1);
+    writer.writeSignedVarint(std::numeric_limits<int64_t>::min());
+    writer.flush();
+    EXPECT_EQ(0, writer.buffered());
+  }
+
+  File file = openForReading();
+  for (int i = 0; i < 100; ++i) {
+    ASSERT_EQ((uint8_t)i, file.readU8());
+    ASSERT_EQ((uint16_t)(i * 300), file.readU16LE());
+    ASSERT_EQ((uint16_t)(i * 301), file.readU16BE());
+    ASSERT_EQ((uint32_t)i * 70000u, file.readU32LE());
+    ASSERT_EQ((uint32_t)i * 70001u, file.readU32BE());
+    ASSERT_EQ((uint64_t)i << 40, file.readU64LE());
+    ASSERT_EQ((uint64_t)i << 41, file.readU64BE());
+    ASSERT_EQ(i * 0.5f, file.readF32LE());
+    ASSERT_EQ(i * -0.25, file.readF64BE());
+  }
+  for (uint64_t v : VARINTS) {
+    EXPECT_EQ(v, file.readVarint());
+  }
+  EXPECT_EQ(-1, file.readSignedVarint());
+  EXPECT_EQ(std::numeric_limits<int64_t>::min(), file.readSignedVarint());
+  EXPECT_FALSE(file.ensureBuffered(1));
+  EXPECT_THROW(file.readU8(), IOError);
+}
+
+TEST_F(BinaryWriterTests, ReserveAndBytes) {
+  const std::string big(1000, 'b');
+  {
+    File file = openForWriting();
+    BinaryWriter writer(file, 32);
+
+    // A fixed-size record reserved in one piece
+    uint8_t* record = writer.reserve(12);
+    byteorder::storeLE<uint32_t>(record, 7);
+    byteorder::storeLE<uint64_t>(record + 4, 8);
+    writer.writeBytes("small", 5);
+    writer.writeBytes(big.data(), big.size());
+    writer.writeU8(0xFF);
+  }
+
+  File file = openForReading();
+  ASSERT_TRUE(file.ensureBuffered(12));
+  EXPECT_EQ(7, file.readU32LE());
+  EXPECT_EQ(8, file.readU64LE());
+
+  char small[5];
+  file.readBytes(small, sizeof(small));
+  EXPECT_EQ("small", std::string(small, sizeof(small)));
+
+  std::string text(big.size(), ' ');
+  file.readBytes(&text[0], text.size());
+  EXPECT_EQ(big, text);
+  EXPECT_EQ(0xFF, file.readU8());
+
+  char extra[2];
+  EXPECT_THROW(file.readBytes(extra, sizeof(extra)), IOError);
+}
+
+TEST_F(BinaryWriterTests, TruncatedValues) {
+  {
+    File file = openForWriting();
+    BinaryWriter writer(file);
+    writer.writeU16LE(1);
+    for (int i = 0; i < 11; ++i) {
+      writer.writeU8(0x80);
+    }
+  }
+
+  File file = openForReading();
+  EXPECT_THROW(file.ensureBuffered(65), IOError);
+  EXPECT_EQ(1, file.readU16LE());
+  EXPECT_THROW(file.readVarint(), IOError);  // Longer than 10 bytes
+  EXPECT_THROW(file.readU32LE(), IOError);   // Only one byte left
+}
@@ -0,0 +1,27 @@
+#include <pistis/filesystem/BufferPolicy.hpp>
+#include <gtest/gtest.h>
+#include <sstream>
+
+using namespace pistis::filesystem;
+
+TEST(BufferPolicyTests, Name) {
+  EXPECT_EQ("FIXED", BufferPolicy::FIXED.name());
+  EXPECT_EQ("ADAPTIVE", BufferPolicy::ADAPTIVE.name());
+}
+
+TEST(BufferPolicyTests, DefaultIsFixed) {
+  EXPECT_EQ(BufferPolicy::FIXED, BufferPolicy());
+}
+
+TEST(BufferPolicyTests, EqualityAndInequality) {
+  EXPECT_TRUE(BufferPolicy::FIXED == BufferPolicy::FIXED);
+  EXPECT_TRUE(BufferPolicy::FIXED != BufferPolicy::ADAPTIVE);
+  EXPECT_FALSE(BufferPolicy::FIXED == BufferPolicy::ADAPTIVE);
+  EXPECT_FALSE(BufferPolicy::FIXED != BufferPolicy::FIXED);
+}
+
+TEST(BufferPolicyTests, WriteToStream) {
+  std::ostringstream out;
+  out << BufferPolicy::ADAPTIVE;
+  EXPECT_EQ("ADAPTIVE", out.str());
+}
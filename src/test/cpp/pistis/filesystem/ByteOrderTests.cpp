@@ -0,0 +1,36 @@
+#include <pistis/filesystem/ByteOrder.hpp>
+#include <gtest/gtest.h>
+
+using namespace pistis::filesystem;
+
+TEST(ByteOrderTests, LoadLittleAndBigEndian) {
+  static const uint8_t BYTES[] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+
+  EXPECT_EQ(0x0201, byteorder::loadLE<uint16_t>(BYTES));
+  EXPECT_EQ(0x0102, byteorder::loadBE<uint16_t>(BYTES));
+  EXPECT_EQ(0x04030201u, byteorder::loadLE<uint32_t>(BYTES));
+  EXPECT_EQ(0x01020304u, byteorder::loadBE<uint32_t>(BYTES));
+  EXPECT_EQ(0x0807060504030201ull, byteorder::loadLE<uint64_t>(BYTES));
+  EXPECT_EQ(0x0102030405060708ull, byteorder::loadBE<uint64_t>(BYTES));
+}
+
+TEST(ByteOrderTests, StoreAndLoadFloatingPoint) {
+  uint8_t bytes[8];
+
+  byteorder::storeLE(bytes, 1.0f);
+  EXPECT_EQ(0x3F800000u, byteorder::loadLE<uint32_t>(bytes));
+  EXPECT_EQ(1.0f, byteorder::loadLE<float>(bytes));
+
+  byteorder::storeBE(bytes, -2.5);
+  EXPECT_EQ(0xC0, bytes[0]);
+  EXPECT_EQ(-2.5, byteorder::loadBE<double>(bytes));
+}
+
+TEST(ByteOrderTests, Zigzag) {
+  EXPECT_EQ(0, byteorder::zigzagEncode(0));
+  EXPECT_EQ(1, byteorder::zigzagEncode(-1));
+  EXPECT_EQ(2, byteorder::zigzagEncode(1));
+  EXPECT_EQ(UINT64_MAX, byteorder::zigzagEncode(INT64_MIN));
+  EXPECT_EQ(INT64_MIN, byteorder::zigzagDecode(UINT64_MAX));
+  EXPECT_EQ(-12345, byteorder::zigzagDecode(byteorder::zigzagEncode(-12345)));
+}
@@ -0,0 +1,145 @@
+#include <pistis/filesystem/ByteScanning.hpp>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace pistis::filesystem;
+
+namespace {
+  // Straightforward version of findSeparators() to check it against
+  std::vector<uint32_t> separatorsIn(const std::string& text, char delimiter,
+				     int quote, bool& inQuotes) {
+    std::vector<uint32_t> positions;
+    for (size_t i = 0; i < text.size(); ++i) {
+      if ((quote >= 0) && (text[i] == (char)quote)) {
+	inQuotes = !inQuotes;
+      } else if (!inQuotes && ((text[i] == delimiter) || (text[i] == '\n'))) {
+	positions.push_back((uint32_t)i);
+      }
+    }
+    return positions;
+  }
+
+  std::vector<uint32_t> findSeparators(const std::string& text, char delimiter,
+				       int quote, bool& inQuotes) {
+    std::vector<uint32_t> positions(text.size());
+    positions.resize(
+	scanning::findSeparators((const uint8_t*)text.data(), text.size(),
+				 (uint8_t)delimiter, quote, inQuotes,
+				 positions.data())
+    );
+    return positions;
+  }
+
+  size_t find(const std::string& text, const std::string& pattern) {
+    return scanning::find((const uint8_t*)text.data(), text.size(),
+			  (const uint8_t*)pattern.data(), pattern.size());
+  }
+}
+
+TEST(ByteScanningTests, FindSeparatorsWithoutQuotes) {
+  const std::string text("a\tbb\tccc\n\tdddddddddddddddddddd\teeeeeeeee\n\n");
+  bool inQuotes = false;
+  const std::vector<uint32_t> truth{ 1, 4, 8, 9, 30, 40, 41 };
+
+  EXPECT_EQ(truth, findSeparators(text, '\t', -1, inQuotes));
+  EXPECT_FALSE(inQuotes);
+}
+
+TEST(ByteScanningTests, FindSeparatorsWithQuotes) {
+  // Quoted runs span the 16-byte blocks the scan works in
+  const std::string text("x,\"a,b\",\"c\"\"d,e\nf\",\"long quoted, field\"\n"
+			 "\"unterminated,");
+  bool inQuotes = false;
+  bool truthInQuotes = false;
+
+  EXPECT_EQ(separatorsIn(text, ',', '"', truthInQuotes),
+	    findSeparators(text, ',', '"', inQuotes));
+  EXPECT_TRUE(truthInQuotes);
+  EXPECT_TRUE(inQuotes);
+
+  // Start inside a quoted run
+  inQuotes = true;
+  truthInQuotes = true;
+  EXPECT_EQ(separatorsIn(text, ',', '"', truthInQuotes),
+	    findSeparators(text, ',', '"', inQuotes));
+  EXPECT_EQ(truthInQuotes, inQuotes);
+}
+
+TEST(ByteScanningTests, FindSeparatorsRandomText) {
+  static const char ALPHABET[] = "ab,\"\n\t";
+  std::mt19937 random(17);
+  std::uniform_int_distribution<int> pick(0, sizeof(ALPHABET) - 2);
+
+  for (size_t length = 0; length < 200; ++length) {
+    std::string text(length, ' ');
+    for (char& c : text) {
+      c = ALPHABET[pick(random)];
+    }
+    for (int quote : { -1, (int)'"' }) {
+      bool inQuotes = false;
+      bool truthInQuotes = false;
+      EXPECT_EQ(separatorsIn(text, ',', quote, truthInQuotes),
+		findSeparators(text, ',', quote, inQuotes))
+	  << "for \"" << text << "\"";
+      EXPECT_EQ(truthInQuotes, inQuotes);
+    }
+  }
+}
+
+TEST(ByteScanningTests, Find) {
+  const std::string text("the quick brown fox jumps over the lazy dog, "
+			 "the quick brown cat");
+  EXPECT_EQ(0, find(text, "the"));
+  EXPECT_EQ(16, find(text, "fox"));
+  EXPECT_EQ(text.size() - 3, find(text, "cat"));
+  EXPECT_EQ(4, find(text, "q"));
+  EXPECT_EQ(text.size(), find(text, "cow"));
+  EXPECT_EQ(text.size(), find(text, "the quick brown cow"));
+  EXPECT_EQ(45, find(text, "the quick brown c"));
+  EXPECT_EQ(0, find(text, text));
+  EXPECT_EQ(3, find("abc", "abcd"));
+}
+
+TEST(ByteScanningTests, FindRandomText) {
+  std::mt19937 random(23);
+  std::uniform_int_distribution<int> pick(0, 2);
+
+  for (size_t length = 0; length < 100; ++length) {
+    std::string text(length, ' ');
+    for (char& c : text) {
+      c = (char)('a' + pick(random));
+    }
+    for (const std::string pattern : { "a", "ab", "abc", "cab", "abcab",
+				       "aaaaaaaaaaaaaaaaaa" }) {
+      const size_t truth = text.find(pattern);
+      EXPECT_EQ((truth == std::string::npos) ? text.size() : truth,
+		find(text, pattern))
+	  << "for \"" << pattern << "\" in \"" << text << "\"";
+    }
+  }
+}
+
+TEST(ByteScanningTests, Count) {
+  std::mt19937 random(31);
+  std::uniform_int_distribution<int> pick(0, 3);
+
+  // Long enough for the byte counters to be summed several times
+  for (size_t length : { 0, 1, 15, 16, 17, 100, 255 * 16, 20000 }) {
+    std::string text(length, ' ');
+    for (char& c : text) {
+      c = "ab\n\xff"[pick(random)];
+    }
+    EXPECT_EQ(std::count(text.begin(), text.end(), '\n'),
+	      scanning::count((const uint8_t*)text.data(), text.size(), '\n'));
+  }
+
+  const std::string newlines(10000, '\n');
+  EXPECT_EQ(newlines.size(),
+	    scanning::count((const uint8_t*)newlines.data(), newlines.size(),
+			    '\n'));
+}
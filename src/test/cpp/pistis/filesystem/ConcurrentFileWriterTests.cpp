@@ -0,0 +1,124 @@
+#include <pistis/filesystem/ConcurrentFileWriter.hpp>
+#include <pistis/filesystem/Path.hpp>
+#include <pistis/exceptions/IOError.hpp>
+
+#include "TestArtifacts.hpp"
+
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace pistis::exceptions;
+using namespace pistis::filesystem;
+namespace pt = pistis::filesystem::testing;
+
+namespace {
+  static const std::string TEST_FILE("concurrent_writer_test.txt");
+
+  class ConcurrentFileWriterTests : public ::testing::Test {
+  protected:
+    std::string fileName;
+
+    virtual void SetUp() {
+      fileName = pt::getScratchFile(TEST_FILE);
+      pt::removeFile(fileName);
+    }
+
+    virtual void TearDown() {
+      pt::removeFile(fileName);
+    }
+  };
+}
+
+TEST_F(ConcurrentFileWriterTests, WriteFromManyThreads) {
+  static const int NUM_THREADS = 16;
+  static const int RECORDS_PER_THREAD = 2000;
+  ConcurrentFileWriter writer = ConcurrentFileWriter::open(fileName, 4096);
+  std::vector<std::thread> threads;
+
+  for (int t = 0; t < NUM_THREADS; ++t) {
+    threads.emplace_back([&writer, t]() {
+      for (int i = 0; i < RECORDS_PER_THREAD; ++i) {
+	writer.write(std::to_string(t) + " " + std::to_string(i) + "\n");
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  writer.close();
+  EXPECT_EQ(NUM_THREADS * RECORDS_PER_THREAD, writer.recordsWritten());
+
+  // Every record appears whole, and each thread's records are in order
+  std::vector<int> next(NUM_THREADS, 0);
+  std::istringstream lines(pt::readTextFile(fileName));
+  int t, i;
+  while (lines >> t >> i) {
+    ASSERT_LE(0, t);
+    ASSERT_GT(NUM_THREADS, t);
+    EXPECT_EQ(next[t], i);
+    next[t] = i + 1;
+  }
+  EXPECT_TRUE(lines.eof());
+  for (int n : next) {
+    EXPECT_EQ(RECORDS_PER_THREAD, n);
+  }
+}
+
+TEST_F(ConcurrentFileWriterTests, FlushAndSync) {
+  ConcurrentFileWriter writer = ConcurrentFileWriter::open(fileName);
+
+  writer.write("first\n");
+  writer.flush();
+  EXPECT_EQ("first\n", pt::readTextFile(fileName));
+  EXPECT_EQ(1, writer.recordsWritten());
+
+  writer.write(std::string("second\n"));
+  writer.sync();
+  EXPECT_EQ("first\nsecond\n", pt::readTextFile(fileName));
+  writer.close();
+}
+
+TEST_F(ConcurrentFileWriterTests, RecordsLargerThanBatch) {
+  const std::string big(100, 'b');
+  ConcurrentFileWriter writer = ConcurrentFileWriter::open(fileName, 16);
+
+  writer.write("small\n");
+  writer.write(big);
+  writer.write("small again\n");
+  writer.close();
+  EXPECT_EQ("small\n" + big + "small again\n", pt::readTextFile(fileName));
+}
+
+TEST_F(ConcurrentFileWriterTests, OpenAppends) {
+  {
+    ConcurrentFileWriter writer = ConcurrentFileWriter::open(fileName);
+    writer.write("one\n");
+  }
+  {
+    ConcurrentFileWriter writer = ConcurrentFileWriter::open(fileName);
+    writer.write("two\n");
+  }
+  EXPECT_EQ("one\ntwo\n", pt::readTextFile(fileName));
+}
+
+TEST_F(ConcurrentFileWriterTests, WriteAfterClose) {
+  ConcurrentFileWriter writer = ConcurrentFileWriter::open(fileName);
+  writer.close();
+  EXPECT_THROW(writer.write("late\n"), IOError);
+}
+
+TEST_F(ConcurrentFileWriterTests, ReportsWriteErrors) {
+  File::open(fileName, FileAccessMode::WRITE_ONLY).close();
+  ConcurrentFileWriter writer(File::open(fileName, FileCreationMode::OPEN_ONLY,
+					 FileAccessMode::READ_ONLY));
+
+  writer.write("Can't be written\n");
+  EXPECT_THROW(writer.flush(), IOError);
+  EXPECT_THROW(writer.write("Nor this\n"), IOError);
+  EXPECT_THROW(writer.close(), IOError);
+  EXPECT_EQ(0, writer.recordsWritten());
+}
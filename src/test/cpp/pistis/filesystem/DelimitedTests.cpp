@@ -0,0 +1,165 @@
+#include <pistis/filesystem/Delimited.hpp>
+#include <pistis/filesystem/File.hpp>
+#include <pistis/exceptions/IOError.hpp>
+
+#include "TestArtifacts.hpp"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+using namespace pistis::exceptions;
+using namespace pistis::filesystem;
+namespace pt = pistis::filesystem::testing;
+
+namespace {
+  typedef std::vector<std::vector<std::string>> Rows;
+
+  class DelimitedTests : public ::testing::Test {
+  protected:
+    std::string fileName;
+
+    virtual void SetUp() {
+      fileName = pt::getScratchFile("delimited_test.txt");
+      pt::removeFile(fileName);
+    }
+
+    virtual void TearDown() {
+      pt::removeFile(fileName);
+    }
+
+    File openFile(size_t initialBufferSize = File::INITIAL_BUFFER_SIZE,
+		  size_t maxBufferSize = File::MAX_BUFFER_SIZE) {
+      return File::open(fileName, FileCreationMode::OPEN_ONLY,
+			FileAccessMode::READ_ONLY, FileOpenOptions::NONE,
+			FilePermissions::ALL_RW, initialBufferSize,
+			maxBufferSize);
+    }
+
+    Rows readRows(File& file, const DelimitedFormat& format,
+		  const std::vector<size_t>& columns = { }) {
+      Rows rows;
+      file.eachRow(format, columns, [&rows](const DelimitedRow& row) {
+	  EXPECT_EQ(rows.size(), row.number());
+	  rows.push_back(std::vector<std::string>(row.begin(), row.end()));
+      });
+      return rows;
+    }
+  };
+}
+
+TEST_F(DelimitedTests, ReadTsv) {
+  pt::writeTextFile(fileName,
+		    "name\tcount\tnote\nalpha\t1\t\n\t2\tlast field\n");
+  File file = openFile();
+  const Rows TRUTH{
+    { "name", "count", "note" },
+    { "alpha", "1", "" },
+    { "", "2", "last field" }
+  };
+  EXPECT_EQ(TRUTH, readRows(file, DelimitedFormat::TSV));
+}
+
+TEST_F(DelimitedTests, TsvIgnoresQuotes) {
+  pt::writeTextFile(fileName, "\"a\tb\"\tc\n");
+  File file = openFile();
+  const Rows TRUTH{ { "\"a", "b\"", "c" } };
+  EXPECT_EQ(TRUTH, readRows(file, DelimitedFormat::TSV));
+}
+
+TEST_F(DelimitedTests, ReadCsvWithQuotes) {
+  pt::writeTextFile(fileName,
+		    "id,text\r\n"
+		    "1,\"with, comma\"\r\n"
+		    "2,\"with \"\"quotes\"\"\"\r\n"
+		    "3,\"with\nnewline\"\r\n"
+		    "4,\"\"\r\n");
+  File file = openFile();
+  const Rows TRUTH{
+    { "id", "text" },
+    { "1", "with, comma" },
+    { "2", "with \"quotes\"" },
+    { "3", "with\nnewline" },
+    { "4", "" }
+  };
+  EXPECT_EQ(TRUTH, readRows(file, DelimitedFormat::CSV));
+}
+
+TEST_F(DelimitedTests, LastRowWithoutNewline) {
+  pt::writeTextFile(fileName, "a,b\nc,d");
+  File file = openFile();
+  const Rows TRUTH{ { "a", "b" }, { "c", "d" } };
+  EXPECT_EQ(TRUTH, readRows(file, DelimitedFormat::CSV));
+}
+
+TEST_F(DelimitedTests, EmptyFile) {
+  pt::writeTextFile(fileName, "");
+  File file = openFile();
+  EXPECT_TRUE(readRows(file, DelimitedFormat::CSV).empty());
+}
+
+TEST_F(DelimitedTests, SelectColumns) {
+  pt::writeTextFile(fileName, "a,b,c,d\n1,2,3,4\nx,y\n");
+  File file = openFile();
+  const Rows TRUTH{ { "d", "b" }, { "4", "2" }, { "", "y" } };
+  std::vector<size_t> fieldCounts;
+
+  file.eachRow(DelimitedFormat::CSV, { 3, 1 },
+	       [&fieldCounts](const DelimitedRow& row) {
+    fieldCounts.push_back(row.fieldCount());
+  });
+  EXPECT_EQ((std::vector<size_t>{ 4, 4, 2 }), fieldCounts);
+
+  file = openFile();
+  EXPECT_EQ(TRUTH, readRows(file, DelimitedFormat::CSV, { 3, 1 }));
+}
+
+TEST_F(DelimitedTests, RowsCrossBufferBoundaries) {
+  // Use a small buffer, so rows and quoted fields are split across fills
+  // and the buffer has to grow to hold the long row
+  Rows truth;
+  std::string text;
+  for (int i = 0; i < 500; ++i) {
+    std::vector<std::string> row{
+      std::to_string(i), "field " + std::to_string(i * 7),
+      std::string(i % 37, 'x') + ",\n" + std::to_string(i)
+    };
+    text += row[0] + "," + row[1] + ",\"" + row[2] + "\"\n";
+    truth.push_back(row);
+  }
+  const std::string longField(200, 'z');
+  text += "last," + longField + "\n";
+  truth.push_back({ "last", longField });
+  pt::writeTextFile(fileName, text);
+
+  File file = openFile(16, 1024);
+  EXPECT_EQ(truth, readRows(file, DelimitedFormat::CSV));
+}
+
+TEST_F(DelimitedTests, RowTooLong) {
+  pt::writeTextFile(fileName, std::string(100, 'a') + "\n");
+  File file = openFile(16, 64);
+  EXPECT_THROW(readRows(file, DelimitedFormat::TSV), IOError);
+}
+
+TEST_F(DelimitedTests, RowsAfterReadLine) {
+  pt::writeTextFile(fileName, "header line\na\tb\n");
+  File file = openFile();
+  const Rows TRUTH{ { "a", "b" } };
+
+  EXPECT_EQ("header line\n", file.readLine());
+  EXPECT_EQ(TRUTH, readRows(file, DelimitedFormat::TSV));
+}
+
+TEST(DelimitedFormatTests, Formats) {
+  EXPECT_EQ('\t', DelimitedFormat::TSV.delimiter());
+  EXPECT_FALSE(DelimitedFormat::TSV.quoting());
+  EXPECT_EQ(',', DelimitedFormat::CSV.delimiter());
+  EXPECT_TRUE(DelimitedFormat::CSV.quoting());
+  EXPECT_EQ('"', DelimitedFormat::CSV.quote());
+
+  DelimitedFormat pipes('|', true, '\'');
+  EXPECT_EQ('|', pipes.delimiter());
+  EXPECT_EQ('\'', pipes.quote());
+}
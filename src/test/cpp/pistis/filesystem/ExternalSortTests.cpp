@@ -0,0 +1,206 @@
+#include <pistis/filesystem/ExternalSort.hpp>
+#include <pistis/filesystem/File.hpp>
+#include <pistis/exceptions/IOError.hpp>
+
+#include "TestArtifacts.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <dirent.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+using namespace pistis::exceptions;
+using namespace pistis::filesystem;
+namespace pt = pistis::filesystem::testing;
+
+namespace {
+  static const std::string INPUT_FILE("external_sort_input.txt");
+  static const std::string OUTPUT_FILE("external_sort_output.txt");
+  static const std::string TEMP_DIR("external_sort_tmp");
+
+  std::vector<std::string> randomLines(size_t n) {
+    std::mt19937 random(17);
+    std::uniform_int_distribution<int> length(0, 40);
+    std::uniform_int_distribution<int> letter('a', 'z');
+    std::vector<std::string> lines;
+
+    for (size_t i = 0; i < n; ++i) {
+      std::string line(length(random), ' ');
+      for (char& c : line) {
+	c = (char)letter(random);
+      }
+      lines.push_back(line + "\n");
+    }
+    return lines;
+  }
+
+  std::vector<std::string> readLines(const std::string& fileName) {
+    File file = File::open(fileName, FileCreationMode::OPEN_ONLY,
+			   FileAccessMode::READ_ONLY);
+    return file.readLines();
+  }
+
+  size_t countFiles(const std::string& dirName) {
+    DIR* dir = ::opendir(dirName.c_str());
+    size_t n = 0;
+    if (dir) {
+      struct dirent* entry;
+      while ((entry = ::readdir(dir)) != nullptr) {
+	if (entry->d_name[0] != '.') {
+	  ++n;
+	}
+      }
+      ::closedir(dir);
+    }
+    return n;
+  }
+
+  class ExternalSortTests : public ::testing::Test {
+  protected:
+    std::string inputFile;
+    std::string outputFile;
+    std::string tempDir;
+
+    virtual void SetUp() {
+      inputFile = pt::getScratchFile(INPUT_FILE);
+      outputFile = pt::getScratchFile(OUTPUT_FILE);
+      tempDir = pt::getScratchFile(TEMP_DIR);
+      ::mkdir(tempDir.c_str(), 0777);
+    }
+
+    virtual void TearDown() {
+      pt::removeFile(inputFile);
+      pt::removeFile(outputFile);
+      ::rmdir(tempDir.c_str());
+    }
+
+    ExternalSortOptions smallBudget(size_t threads) const {
+      ExternalSortOptions options;
+      options.memoryBudget = 16 * 1024;
+      options.threads = threads;
+      options.tempDirectory = tempDir;
+      return options;
+    }
+  };
+}
+
+TEST_F(ExternalSortTests, SortInMemory) {
+  std::vector<std::string> lines = randomLines(1000);
+  pt::writeTextFile(inputFile, lines);
+
+  ExternalSortOptions options;
+  options.tempDirectory = tempDir;
+  ExternalSorter::sortFile(inputFile, outputFile, options);
+
+  std::sort(lines.begin(), lines.end());
+  EXPECT_EQ(lines, readLines(outputFile));
+}
+
+TEST_F(ExternalSortTests, SortWithRuns) {
+  std::vector<std::string> lines = randomLines(20000);
+  ExternalSorter sorter(smallBudget(3));
+
+  for (const std::string& line : lines) {
+    sorter.add(line);
+  }
+  EXPECT_GT(sorter.runCount(), 10);
+
+  {
+    File output = File::open(outputFile, FileAccessMode::WRITE_ONLY,
+			     FileOpenOptions::TRUNCATE);
+    sorter.finish(output);
+  }
+  EXPECT_EQ(0, sorter.runCount());
+  EXPECT_EQ(0, countFiles(tempDir));
+
+  std::sort(lines.begin(), lines.end());
+  EXPECT_EQ(lines, readLines(outputFile));
+}
+
+TEST_F(ExternalSortTests, MergeInSeveralPasses) {
+  std::vector<std::string> lines = randomLines(20000);
+  ExternalSortOptions options = smallBudget(2);
+  options.maxMergeWidth = 3;
+
+  pt::writeTextFile(inputFile, lines);
+  ExternalSorter::sortFile(inputFile, outputFile, options);
+  EXPECT_EQ(0, countFiles(tempDir));
+
+  std::sort(lines.begin(), lines.end());
+  EXPECT_EQ(lines, readLines(outputFile));
+}
+
+TEST_F(ExternalSortTests, CustomComparator) {
+  std::vector<std::string> lines = randomLines(5000);
+  auto descending = [](const std::string& x, const std::string& y) {
+    return y < x;
+  };
+
+  pt::writeTextFile(inputFile, lines);
+  ExternalSorter::sortFile(inputFile, outputFile, smallBudget(1),
+			   descending);
+
+  std::sort(lines.begin(), lines.end(), descending);
+  EXPECT_EQ(lines, readLines(outputFile));
+}
+
+TEST_F(ExternalSortTests, LastLineWithoutNewline) {
+  pt::writeTextFile(inputFile, "pear\napple\nfig");
+  ExternalSorter::sortFile(inputFile, outputFile);
+
+  const std::vector<std::string> TRUTH{ "apple\n", "fig\n", "pear\n" };
+  EXPECT_EQ(TRUTH, readLines(outputFile));
+}
+
+TEST_F(ExternalSortTests, ReuseAfterFinish) {
+  ExternalSorter sorter(smallBudget(2));
+  for (int pass = 0; pass < 2; ++pass) {
+    std::vector<std::string> lines = randomLines(3000 * (pass + 1));
+    for (const std::string& line : lines) {
+      sorter.add(line);
+    }
+    {
+      File output = File::open(outputFile, FileAccessMode::WRITE_ONLY,
+			       FileOpenOptions::TRUNCATE);
+      sorter.finish(output);
+    }
+    std::sort(lines.begin(), lines.end());
+    EXPECT_EQ(lines, readLines(outputFile));
+  }
+}
+
+TEST_F(ExternalSortTests, DestructorRemovesRuns) {
+  {
+    ExternalSorter sorter(smallBudget(2));
+    for (const std::string& line : randomLines(5000)) {
+      sorter.add(line);
+    }
+    EXPECT_GT(sorter.runCount(), 0);
+  }
+  EXPECT_EQ(0, countFiles(tempDir));
+}
+
+TEST_F(ExternalSortTests, BadTempDirectory) {
+  ExternalSortOptions options = smallBudget(1);
+  options.tempDirectory = pt::getScratchFile("does_not_exist");
+
+  ExternalSorter sorter(options);
+  EXPECT_THROW(
+      {
+	for (const std::string& line : randomLines(5000)) {
+	  sorter.add(line);
+	}
+	File output = File::open(outputFile, FileAccessMode::WRITE_ONLY,
+				 FileOpenOptions::TRUNCATE);
+	sorter.finish(output);
+      },
+      IOError
+  );
+}
@@ -0,0 +1,87 @@
+#include <pistis/filesystem/FileInstrumentation.hpp>
+#include <pistis/filesystem/File.hpp>
+
+#include "TestArtifacts.hpp"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <tuple>
+#include <vector>
+
+using namespace pistis::filesystem;
+namespace pt = pistis::filesystem::testing;
+
+namespace {
+  typedef std::tuple<FileOperation, std::string, size_t> TraceEvent;
+}
+
+TEST(FileInstrumentationTests, RecordAndTrace) {
+  std::vector<TraceEvent> events;
+  FileInstrumentation::resetHistograms();
+  uint64_t id = FileInstrumentation::addTraceCallback(
+      [&events](FileOperation op, const std::string& name, size_t n,
+		uint64_t) {
+	events.push_back(TraceEvent(op, name, n));
+      }
+  );
+
+  FileInstrumentation::record(FileOperation::READ, "a.txt", 16, 2000);
+  FileInstrumentation::record(FileOperation::WRITE, "b.txt", 32, 3000);
+  EXPECT_TRUE(FileInstrumentation::removeTraceCallback(id));
+  EXPECT_FALSE(FileInstrumentation::removeTraceCallback(id));
+  FileInstrumentation::record(FileOperation::READ, "c.txt", 64, 4000);
+
+  std::vector<TraceEvent> truth{
+    TraceEvent(FileOperation::READ, "a.txt", 16),
+    TraceEvent(FileOperation::WRITE, "b.txt", 32)
+  };
+  EXPECT_EQ(truth, events);
+
+  EXPECT_EQ(2, FileInstrumentation::histogram(FileOperation::READ).count());
+  EXPECT_EQ(4000, FileInstrumentation::histogram(FileOperation::READ).max());
+  EXPECT_EQ(1, FileInstrumentation::histogram(FileOperation::WRITE).count());
+  EXPECT_EQ(0, FileInstrumentation::histogram(FileOperation::SEEK).count());
+
+  FileInstrumentation::resetHistograms();
+  EXPECT_EQ(0, FileInstrumentation::histogram(FileOperation::READ).count());
+}
+
+TEST(FileInstrumentationTests, TimeFileOperations) {
+  const std::string fileName = pt::getResourcePath("test_file_1.txt");
+  std::vector<TraceEvent> events;
+
+  FileInstrumentation::resetHistograms();
+  uint64_t id = FileInstrumentation::addTraceCallback(
+      [&events](FileOperation op, const std::string& name, size_t n,
+		uint64_t) {
+	events.push_back(TraceEvent(op, name, n));
+      }
+  );
+
+  File file = File::open(fileName, FileCreationMode::OPEN_ONLY,
+			 FileAccessMode::READ_ONLY);
+  std::vector<std::string> lines = file.readLines();
+  file.seek(FileOrigin::START, 0);
+  file.close();
+  FileInstrumentation::removeTraceCallback(id);
+
+  if (!FileInstrumentation::compiledIn()) {
+    // File operations are not timed unless the library was built with
+    // INSTRUMENTATION=1
+    EXPECT_TRUE(events.empty());
+    EXPECT_EQ(0, FileInstrumentation::histogram(FileOperation::READ).count());
+  } else {
+    ASSERT_LE(5, events.size());
+    EXPECT_EQ(TraceEvent(FileOperation::OPEN, fileName, 0), events.front());
+    EXPECT_EQ(TraceEvent(FileOperation::CLOSE, fileName, 0), events.back());
+    EXPECT_EQ(FileOperation::READ, std::get<0>(events[1]));
+    EXPECT_LT(0, std::get<2>(events[1]));
+    EXPECT_EQ(1,
+	      FileInstrumentation::histogram(FileOperation::OPEN).count());
+    EXPECT_EQ(1,
+	      FileInstrumentation::histogram(FileOperation::SEEK).count());
+    EXPECT_EQ(events.size() - 3,
+	      FileInstrumentation::histogram(FileOperation::READ).count());
+  }
+}
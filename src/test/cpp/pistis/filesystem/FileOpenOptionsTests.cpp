@@ -13,6 +13,7 @@ TEST(FileOpenOptionsTests, FlagValues) {
   EXPECT_EQ(O_NOATIME, FileOpenOptions::DONT_UPDATE_LAST_ACCESS_TIME.flags());
   EXPECT_EQ(O_NOFOLLOW, FileOpenOptions::DONT_FOLLOW_SYMLINKS.flags());
   EXPECT_EQ(O_TRUNC, FileOpenOptions::TRUNCATE.flags());
+  EXPECT_EQ(O_NONBLOCK, FileOpenOptions::NON_BLOCKING.flags());
   EXPECT_EQ(O_SYNC, FileOpenOptions::ENSURE_FILE_INTEGRITY.flags());
 }
 
@@ -25,6 +26,7 @@ TEST(FileOpenOptionsTests, Name) {
   EXPECT_EQ("DONT_FOLLOW_SYMLINKS",
 	    FileOpenOptions::DONT_FOLLOW_SYMLINKS.name());
   EXPECT_EQ("TRUNCATE", FileOpenOptions::TRUNCATE.name());
+  EXPECT_EQ("NON_BLOCKING", FileOpenOptions::NON_BLOCKING.name());
   EXPECT_EQ("ENSURE_FILE_INTEGRITY",
 	    FileOpenOptions::ENSURE_FILE_INTEGRITY.name());
 }
@@ -71,6 +73,7 @@ TEST(FileOpenOptionsTests, BitwiseNot) {
   FileOpenOptions truth(FileOpenOptions::CLOSE_ON_EXEC |
 			FileOpenOptions::DONT_UPDATE_LAST_ACCESS_TIME |
 			FileOpenOptions::TRUNCATE |
+			FileOpenOptions::NON_BLOCKING |
 			FileOpenOptions::ENSURE_FILE_INTEGRITY);
 
   EXPECT_EQ(truth, ~options);
@@ -0,0 +1,37 @@
+#include <pistis/filesystem/FileOperation.hpp>
+#include <gtest/gtest.h>
+#include <sstream>
+
+using namespace pistis::filesystem;
+
+TEST(FileOperationTests, Ordinal) {
+  EXPECT_EQ(0, FileOperation::OPEN.ordinal());
+  EXPECT_EQ(1, FileOperation::READ.ordinal());
+  EXPECT_EQ(2, FileOperation::WRITE.ordinal());
+  EXPECT_EQ(3, FileOperation::SEEK.ordinal());
+  EXPECT_EQ(4, FileOperation::TRUNCATE.ordinal());
+  EXPECT_EQ(5, FileOperation::CLOSE.ordinal());
+  EXPECT_EQ(FileOperation::SEEK, FileOperation::fromOrdinal(3));
+}
+
+TEST(FileOperationTests, Name) {
+  EXPECT_EQ("OPEN", FileOperation::OPEN.name());
+  EXPECT_EQ("READ", FileOperation::READ.name());
+  EXPECT_EQ("WRITE", FileOperation::WRITE.name());
+  EXPECT_EQ("SEEK", FileOperation::SEEK.name());
+  EXPECT_EQ("TRUNCATE", FileOperation::TRUNCATE.name());
+  EXPECT_EQ("CLOSE", FileOperation::CLOSE.name());
+}
+
+TEST(FileOperationTests, EqualityAndInequality) {
+  EXPECT_TRUE(FileOperation::READ == FileOperation::READ);
+  EXPECT_TRUE(FileOperation::READ != FileOperation::WRITE);
+  EXPECT_FALSE(FileOperation::READ == FileOperation::WRITE);
+  EXPECT_FALSE(FileOperation::READ != FileOperation::READ);
+}
+
+TEST(FileOperationTests, WriteToStream) {
+  std::ostringstream out;
+  out << FileOperation::TRUNCATE;
+  EXPECT_EQ("TRUNCATE", out.str());
+}
@@ -0,0 +1,85 @@
+#include <pistis/filesystem/FileStatistics.hpp>
+#include <gtest/gtest.h>
+#include <sstream>
+
+using namespace pistis::filesystem;
+
+namespace {
+  FileStatistics createStatistics(uint64_t base) {
+    FileStatistics stats;
+    stats.readCalls = base + 1;
+    stats.writeCalls = base + 2;
+    stats.bytesRead = base + 3;
+    stats.bytesWritten = base + 4;
+    stats.bufferGrowths = base + 5;
+    stats.bufferShrinks = base + 6;
+    stats.bytesShifted = base + 7;
+    stats.bufferClears = base + 8;
+    stats.bytesDiscarded = base + 9;
+    stats.maxLineLength = base + 10;
+    stats.hugePageBuffers = base + 11;
+    stats.hugePageBytes = base + 12;
+    return stats;
+  }
+}
+
+TEST(FileStatisticsTests, Construct) {
+  FileStatistics stats;
+  EXPECT_EQ(0, stats.readCalls);
+  EXPECT_EQ(0, stats.writeCalls);
+  EXPECT_EQ(0, stats.bytesRead);
+  EXPECT_EQ(0, stats.bytesWritten);
+  EXPECT_EQ(0, stats.bufferGrowths);
+  EXPECT_EQ(0, stats.bufferShrinks);
+  EXPECT_EQ(0, stats.bytesShifted);
+  EXPECT_EQ(0, stats.bufferClears);
+  EXPECT_EQ(0, stats.bytesDiscarded);
+  EXPECT_EQ(0, stats.maxLineLength);
+  EXPECT_EQ(0, stats.hugePageBuffers);
+  EXPECT_EQ(0, stats.hugePageBytes);
+}
+
+TEST(FileStatisticsTests, Add) {
+  FileStatistics sum = createStatistics(10) + createStatistics(100);
+  EXPECT_EQ(112, sum.readCalls);
+  EXPECT_EQ(114, sum.writeCalls);
+  EXPECT_EQ(116, sum.bytesRead);
+  EXPECT_EQ(118, sum.bytesWritten);
+  EXPECT_EQ(120, sum.bufferGrowths);
+  EXPECT_EQ(122, sum.bufferShrinks);
+  EXPECT_EQ(124, sum.bytesShifted);
+  EXPECT_EQ(126, sum.bufferClears);
+  EXPECT_EQ(128, sum.bytesDiscarded);
+  EXPECT_EQ(110, sum.maxLineLength);
+  EXPECT_EQ(132, sum.hugePageBuffers);
+  EXPECT_EQ(134, sum.hugePageBytes);
+}
+
+TEST(FileStatisticsTests, EqualityAndInequality) {
+  EXPECT_TRUE(createStatistics(10) == createStatistics(10));
+  EXPECT_FALSE(createStatistics(10) == createStatistics(11));
+  EXPECT_TRUE(createStatistics(10) != createStatistics(11));
+  EXPECT_FALSE(createStatistics(10) != createStatistics(10));
+}
+
+TEST(FileStatisticsTests, ProcessTotals) {
+  FileStatistics::resetProcessTotals();
+  EXPECT_EQ(FileStatistics(), FileStatistics::processTotals());
+
+  FileStatistics::addToProcessTotals(createStatistics(10));
+  FileStatistics::addToProcessTotals(createStatistics(100));
+  EXPECT_EQ(createStatistics(10) + createStatistics(100),
+	    FileStatistics::processTotals());
+
+  FileStatistics::resetProcessTotals();
+  EXPECT_EQ(FileStatistics(), FileStatistics::processTotals());
+}
+
+TEST(FileStatisticsTests, WriteToStream) {
+  std::ostringstream out;
+  out << createStatistics(0);
+  EXPECT_EQ("{ readCalls: 1, writeCalls: 2, bytesRead: 3, bytesWritten: 4, "
+	    "bufferGrowths: 5, bufferShrinks: 6, bytesShifted: 7, "
+	    "bufferClears: 8, bytesDiscarded: 9, maxLineLength: 10, "
+	    "hugePageBuffers: 11, hugePageBytes: 12 }", out.str());
+}
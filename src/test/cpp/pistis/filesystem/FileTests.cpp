@@ -9,8 +9,11 @@
 #include <memory>
 #include <sstream>
 
+#include <fcntl.h>
+#include <sys/socket.h>
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <unistd.h>
 
 using namespace pistis::exceptions;
 using namespace pistis::filesystem;
@@ -33,6 +36,87 @@ namespace {
       "This is the third line.\n"
   };
 
+  // Read from fd until the end of the stream
+  static std::string readAll(int fd) {
+    std::string text;
+    char buffer[4096];
+    ssize_t n;
+    while ((n = ::read(fd, buffer, sizeof(buffer))) > 0) {
+      text.append(buffer, n);
+    }
+    return text;
+  }
+
+  // Collect the lines eachLineBatch() returns, and the size of each batch
+  static std::vector<std::string> readLineBatches(
+      File& file, size_t maxLines, std::vector<size_t>& batchSizes
+  ) {
+    std::vector<std::string> lines;
+    file.eachLineBatch(maxLines, [&](const uint8_t* base,
+				     const LineSpan* spans, size_t n) {
+	for (size_t i = 0; i < n; ++i) {
+	  lines.push_back(std::string((const char*)base + spans[i].offset,
+				      spans[i].length));
+	}
+	batchSizes.push_back(n);
+    });
+    return lines;
+  }
+
+  // A pipe whose ends are closed when it goes out of scope
+  struct Pipe {
+    int fds[2];
+
+    Pipe() {
+      if (::pipe(fds) < 0) {
+	throw IOError::fromSystemError("Call to pipe() failed: #ERR#",
+				       PISTIS_EX_HERE);
+      }
+    }
+    ~Pipe() {
+      closeRead();
+      closeWrite();
+    }
+
+    int readFd() const { return fds[0]; }
+    int writeFd() const { return fds[1]; }
+
+    void closeRead() {
+      if (fds[0] >= 0) {
+	::close(fds[0]);
+	fds[0] = -1;
+      }
+    }
+
+    void closeWrite() {
+      if (fds[1] >= 0) {
+	::close(fds[1]);
+	fds[1] = -1;
+      }
+    }
+  };
+
+  // Write text to a scratch file and open it for reading
+  static File openText(const std::string& name, const std::string& text,
+		       size_t initialBufferSize = File::INITIAL_BUFFER_SIZE,
+		       size_t maxBufferSize = File::MAX_BUFFER_SIZE) {
+    pt::writeTextFile(name, text);
+    return File::open(pt::getScratchFile(name), FileCreationMode::OPEN_ONLY,
+		      FileAccessMode::READ_ONLY, FileOpenOptions::NONE,
+		      FilePermissions::ALL_RW, initialBufferSize,
+		      maxBufferSize);
+  }
+
+  static void readAndCheckLines(File& file,
+				const std::vector<std::string>& lines) {
+    std::string line;
+    for (const std::string& expected : lines) {
+      ASSERT_TRUE(file.readLine(line));
+      ASSERT_EQ(expected, line);
+    }
+    EXPECT_FALSE(file.readLine(line));
+  }
+
   static const std::vector<std::string> TEST_FILE_1_LINES{
       "The text in this file is used by unit tests to verify the File "
       "implementation.\n",
@@ -345,6 +429,17 @@ TEST(FileTests, ReadLineFollowedByReadWithBufferEqualToFirstLineLength) {
   EXPECT_EQ("", file.readLine());
 }
 
+TEST(FileTests, SeekFollowedByReadLine) {
+  std::string fileName = pt::getResourcePath("test_file_1.txt");
+  File file = File::open(fileName, FileCreationMode::OPEN_ONLY,
+			 FileAccessMode::READ_ONLY);
+  std::vector<std::string> lines = file.readLines();
+  EXPECT_EQ(TEST_FILE_1_LINES, lines);
+
+  file.seek(FileOrigin::START, TEST_FILE_1_LINES[0].size());
+  EXPECT_EQ(TEST_FILE_1_LINES[1], file.readLine());
+}
+
 TEST(FileTests, EachChunk) {
   const std::string fileName = pt::getResourcePath("test_file_1.txt");
   const size_t CHUNK_SIZE = 20;
@@ -387,3 +482,750 @@ TEST(FileTests, Unlink) {
 
   EXPECT_THROW(File::unlink("no_such_file.txt"), IOError);
 }
+
+TEST(FileTests, Statistics) {
+  std::string fileName = pt::getResourcePath("test_file_1.txt");
+  File file = File::open(fileName, FileCreationMode::OPEN_ONLY,
+			 FileAccessMode::READ_ONLY, FileOpenOptions::NONE,
+			 FilePermissions::ALL_RW, 12, 96);
+  std::vector<std::string> lines = file.readLines();
+  const FileStatistics stats = file.stats();
+
+  ASSERT_EQ(TEST_FILE_1_LINES, lines);
+  EXPECT_EQ(TEST_FILE_1_CONTENT.size(), stats.bytesRead);
+  EXPECT_LT(1, stats.readCalls);
+  EXPECT_EQ(0, stats.writeCalls);
+  EXPECT_EQ(0, stats.bytesWritten);
+  EXPECT_EQ(3, stats.bufferGrowths);  // 12 -> 24 -> 48 -> 96
+  EXPECT_LT(0, stats.bytesShifted);
+  EXPECT_EQ(TEST_FILE_1_LINES[0].size(), stats.maxLineLength);
+
+  file.seek(FileOrigin::START, 0);
+  EXPECT_EQ(0, file.stats().bufferClears);
+  file.readLine();
+  file.seek(FileOrigin::START, 0);
+  EXPECT_EQ(1, file.stats().bufferClears);
+  EXPECT_LT(0, file.stats().bytesDiscarded);
+
+  FileStatistics::resetProcessTotals();
+  const FileStatistics finalStats = file.stats();
+  file.close();
+  EXPECT_EQ(finalStats, FileStatistics::processTotals());
+
+  file.resetStats();
+  EXPECT_EQ(FileStatistics(), file.stats());
+}
+
+TEST(FileTests, SpliceToPipe) {
+  File file = File::open(pt::getResourcePath("test_file_1.txt"),
+			 FileCreationMode::OPEN_ONLY,
+			 FileAccessMode::READ_ONLY);
+  Pipe pipe;
+
+  EXPECT_EQ(TEST_FILE_1_CONTENT.size(), file.spliceTo(pipe.writeFd(), 4096));
+  EXPECT_EQ(TEST_FILE_1_CONTENT.size(), file.stats().bytesRead);
+  pipe.closeWrite();
+  EXPECT_EQ(TEST_FILE_1_CONTENT, readAll(pipe.readFd()));
+}
+
+TEST(FileTests, SpliceToAfterReadLine) {
+  File file = File::open(pt::getResourcePath("test_file_1.txt"),
+			 FileCreationMode::OPEN_ONLY,
+			 FileAccessMode::READ_ONLY);
+  Pipe pipe;
+
+  EXPECT_EQ(TEST_FILE_1_LINES[0], file.readLine());
+
+  // The rest of the file is already in the buffer, so make sure part of it
+  // can be spliced without losing what follows
+  EXPECT_EQ(5, file.spliceTo(pipe.writeFd(), 5));
+  EXPECT_EQ(TEST_FILE_1_LINES[1].substr(5), file.readLine());
+  EXPECT_EQ(TEST_FILE_1_LINES[2].size(),
+	    file.spliceTo(pipe.writeFd(), 4096));
+  pipe.closeWrite();
+  EXPECT_EQ(TEST_FILE_1_LINES[1].substr(0, 5) + TEST_FILE_1_LINES[2],
+	    readAll(pipe.readFd()));
+}
+
+TEST(FileTests, SpliceToFile) {
+  const std::string outputName = pt::getScratchFile("splice_output.txt");
+  pt::removeFile(outputName);
+  {
+    File file = File::open(pt::getResourcePath("test_file_1.txt"),
+			   FileCreationMode::OPEN_ONLY,
+			   FileAccessMode::READ_ONLY);
+    File output = File::open(outputName, FileAccessMode::WRITE_ONLY);
+
+    EXPECT_EQ(20, file.spliceTo(output.fd(), 20));
+    EXPECT_EQ(TEST_FILE_1_CONTENT.size() - 20,
+	      file.spliceTo(output.fd(), 4096));
+    EXPECT_EQ(0, file.spliceTo(output.fd(), 4096));
+  }
+  EXPECT_EQ(TEST_FILE_1_CONTENT, pt::readTextFile(outputName));
+  pt::removeFile(outputName);
+}
+
+TEST(FileTests, SpliceToSocket) {
+  File file = File::open(pt::getResourcePath("test_file_1.txt"),
+			 FileCreationMode::OPEN_ONLY,
+			 FileAccessMode::READ_ONLY);
+  int sockets[2];
+
+  ASSERT_EQ(0, ::socketpair(AF_UNIX, SOCK_STREAM, 0, sockets));
+  EXPECT_EQ(TEST_FILE_1_CONTENT.size(), file.spliceTo(sockets[0], 4096));
+  ::close(sockets[0]);
+  EXPECT_EQ(TEST_FILE_1_CONTENT, readAll(sockets[1]));
+  ::close(sockets[1]);
+}
+
+TEST(FileTests, SpliceFromPipe) {
+  const std::string outputName = pt::getScratchFile("splice_output.txt");
+  static const std::string TEXT("Data that arrived through a pipe.\n");
+  Pipe pipe;
+
+  pt::removeFile(outputName);
+  ASSERT_EQ((ssize_t)TEXT.size(),
+	    ::write(pipe.writeFd(), TEXT.data(), TEXT.size()));
+  pipe.closeWrite();
+  {
+    File output = File::open(outputName, FileAccessMode::WRITE_ONLY);
+    output.write("> ", 2);
+    EXPECT_EQ(TEXT.size(), output.spliceFrom(pipe.readFd(), 4096));
+    EXPECT_EQ(2 + TEXT.size(), output.stats().bytesWritten);
+  }
+  EXPECT_EQ("> " + TEXT, pt::readTextFile(outputName));
+  pt::removeFile(outputName);
+}
+
+TEST(FileTests, SpliceFromFile) {
+  const std::string outputName = pt::getScratchFile("splice_output.txt");
+  pt::removeFile(outputName);
+  {
+    File input = File::open(pt::getResourcePath("test_file_1.txt"),
+			    FileCreationMode::OPEN_ONLY,
+			    FileAccessMode::READ_ONLY);
+    File output = File::open(outputName, FileAccessMode::WRITE_ONLY);
+    EXPECT_EQ(TEST_FILE_1_CONTENT.size(),
+	      output.spliceFrom(input.fd(), 4096));
+  }
+  EXPECT_EQ(TEST_FILE_1_CONTENT, pt::readTextFile(outputName));
+  pt::removeFile(outputName);
+}
+
+TEST(FileTests, TeeTo) {
+  static const std::string TEXT("Read twice.\n");
+  Pipe input;
+  Pipe copy;
+
+  ASSERT_EQ((ssize_t)TEXT.size(),
+	    ::write(input.writeFd(), TEXT.data(), TEXT.size()));
+  input.closeWrite();
+
+  File file(::dup(input.readFd()), "input pipe");
+  EXPECT_EQ(TEXT.size(), file.teeTo(copy.writeFd(), 4096));
+  copy.closeWrite();
+  EXPECT_EQ(TEXT, readAll(copy.readFd()));
+  EXPECT_EQ(TEXT, readAll(input.readFd()));
+}
+
+TEST(FileTests, NonBlockingRead) {
+  Pipe pipe;
+  File reader(::dup(pipe.readFd()), "pipe reader");
+  char buffer[64];
+
+  EXPECT_FALSE(reader.nonBlocking());
+  reader.setNonBlocking(true);
+  EXPECT_TRUE(reader.nonBlocking());
+  EXPECT_EQ(File::WOULD_BLOCK, reader.tryRead(buffer, sizeof(buffer)));
+
+  ASSERT_EQ(6, ::write(pipe.writeFd(), "hello\n", 6));
+  EXPECT_EQ(6, reader.tryRead(buffer, sizeof(buffer)));
+  EXPECT_EQ("hello\n", std::string(buffer, 6));
+  EXPECT_EQ(File::WOULD_BLOCK, reader.tryRead(buffer, sizeof(buffer)));
+
+  // Everything else throws instead of waiting
+  EXPECT_THROW(reader.read(buffer, sizeof(buffer)), IOError);
+  EXPECT_THROW(reader.readLine(), IOError);
+
+  pipe.closeWrite();
+  EXPECT_EQ(0, reader.tryRead(buffer, sizeof(buffer)));
+  EXPECT_EQ(0, reader.read(buffer, sizeof(buffer)));
+}
+
+TEST(FileTests, NonBlockingReadReturnsBufferedData) {
+  Pipe pipe;
+  File reader(::dup(pipe.readFd()), "pipe reader");
+  char buffer[64];
+
+  ASSERT_EQ(10, ::write(pipe.writeFd(), "one\ntwo\nth", 10));
+  EXPECT_EQ("one\n", reader.readLine());
+  reader.setNonBlocking(true);
+  EXPECT_EQ(6, reader.read(buffer, sizeof(buffer)));
+  EXPECT_EQ("two\nth", std::string(buffer, 6));
+  EXPECT_EQ(File::WOULD_BLOCK, reader.tryRead(buffer, sizeof(buffer)));
+}
+
+TEST(FileTests, EachChunkNonBlocking) {
+  Pipe pipe;
+  File reader(::dup(pipe.readFd()), "pipe reader");
+  std::vector<size_t> chunks;
+  auto collect = [&chunks](const uint8_t*, size_t n) { chunks.push_back(n); };
+
+  reader.setNonBlocking(true);
+  EXPECT_THROW(reader.eachChunk(4, collect), IOError);
+  EXPECT_TRUE(chunks.empty());
+
+  // A short read ends eachChunk() before it has to wait
+  ASSERT_EQ(10, ::write(pipe.writeFd(), "0123456789", 10));
+  reader.eachChunk(4, collect);
+  EXPECT_EQ((std::vector<size_t>{ 4, 4, 2 }), chunks);
+
+  // Running out of data exactly at the end of a chunk makes it wait
+  chunks.clear();
+  ASSERT_EQ(8, ::write(pipe.writeFd(), "01234567", 8));
+  EXPECT_THROW(reader.eachChunk(4, collect), IOError);
+  EXPECT_EQ((std::vector<size_t>{ 4, 4 }), chunks);
+}
+
+TEST(FileTests, NonBlockingWrite) {
+  Pipe pipe;
+  File writer(::dup(pipe.writeFd()), "pipe writer");
+  const std::string data(4096, 'x');
+  size_t total = 0;
+  size_t n;
+
+  writer.setNonBlocking(true);
+  while ((n = writer.tryWrite(data.data(), data.size())) !=
+	     File::WOULD_BLOCK) {
+    total += n;
+  }
+  EXPECT_LT(0, total);
+  EXPECT_EQ(total, writer.stats().bytesWritten);
+  EXPECT_THROW(writer.write(data.data(), data.size()), IOError);
+}
+
+TEST(FileTests, OpenNonBlocking) {
+  File file = File::open(pt::getResourcePath("test_file_1.txt"),
+			 FileCreationMode::OPEN_ONLY,
+			 FileAccessMode::READ_ONLY,
+			 FileOpenOptions::NON_BLOCKING);
+  EXPECT_TRUE(file.nonBlocking());
+  EXPECT_EQ(TEST_FILE_1_LINES, file.readLines());
+}
+
+TEST(FileTests, TryReadLine) {
+  Pipe pipe;
+  File reader(::dup(pipe.readFd()), "pipe reader", 8, 64);
+  std::string line;
+
+  reader.setNonBlocking(true);
+  EXPECT_EQ(File::WOULD_BLOCK, reader.tryReadLine(line));
+
+  // Part of a line is kept until the rest arrives, even after the buffer
+  // has to grow to hold it
+  ASSERT_EQ(12, ::write(pipe.writeFd(), "first line, ", 12));
+  EXPECT_EQ(File::WOULD_BLOCK, reader.tryReadLine(line));
+  ASSERT_EQ(13, ::write(pipe.writeFd(), "continued\nsec", 13));
+  EXPECT_EQ(22, reader.tryReadLine(line));
+  EXPECT_EQ("first line, continued\n", line);
+  EXPECT_EQ(File::WOULD_BLOCK, reader.tryReadLine(line));
+
+  ASSERT_EQ(4, ::write(pipe.writeFd(), "ond\n", 4));
+  pipe.closeWrite();
+  EXPECT_EQ(7, reader.tryReadLine(line));
+  EXPECT_EQ("second\n", line);
+  EXPECT_EQ(0, reader.tryReadLine(line));
+  EXPECT_EQ("", line);
+}
+
+TEST(FileTests, TryReadLineWithoutNewlineAtEnd) {
+  Pipe pipe;
+  File reader(::dup(pipe.readFd()), "pipe reader");
+  std::string line;
+
+  ASSERT_EQ(9, ::write(pipe.writeFd(), "one\ntwo\nt", 9));
+  pipe.closeWrite();
+  EXPECT_EQ(4, reader.tryReadLine(line));
+  EXPECT_EQ("one\n", line);
+  EXPECT_EQ(4, reader.tryReadLine(line));
+  EXPECT_EQ("two\n", line);
+  EXPECT_EQ(1, reader.tryReadLine(line));
+  EXPECT_EQ("t", line);
+  EXPECT_EQ(0, reader.tryReadLine(line));
+}
+
+TEST(FileTests, TryReadLineTooLong) {
+  Pipe pipe;
+  File reader(::dup(pipe.readFd()), "pipe reader", 8, 16);
+  std::string line;
+
+  reader.setNonBlocking(true);
+  ASSERT_EQ(20, ::write(pipe.writeFd(), "01234567890123456789", 20));
+  EXPECT_THROW(reader.tryReadLine(line), IOError);
+}
+
+TEST(FileTests, EachLineBatch) {
+  const std::string fileName = pt::getResourcePath("test_file_1.txt");
+  for (size_t maxLines : { 1, 2, 3, 100 }) {
+    File file = File::open(fileName, FileCreationMode::OPEN_ONLY,
+			   FileAccessMode::READ_ONLY);
+    std::vector<size_t> batchSizes;
+
+    EXPECT_EQ(TEST_FILE_1_LINES, readLineBatches(file, maxLines, batchSizes))
+	<< "with maxLines = " << maxLines;
+    for (size_t n : batchSizes) {
+      EXPECT_LE(n, maxLines);
+    }
+    EXPECT_EQ(TEST_FILE_1_LINES[0].size(), file.stats().maxLineLength);
+  }
+
+  // The whole file fits in the buffer, so it arrives in one batch
+  File file = File::open(fileName, FileCreationMode::OPEN_ONLY,
+			 FileAccessMode::READ_ONLY);
+  std::vector<size_t> batchSizes;
+  readLineBatches(file, 100, batchSizes);
+  EXPECT_EQ(std::vector<size_t>{ 3 }, batchSizes);
+}
+
+TEST(FileTests, EachLineBatchWithBufferDoubling) {
+  File file = File::open(pt::getResourcePath("test_file_1.txt"),
+			 FileCreationMode::OPEN_ONLY,
+			 FileAccessMode::READ_ONLY, FileOpenOptions::NONE,
+			 FilePermissions::ALL_RW, 12, 1024);
+  std::vector<size_t> batchSizes;
+  EXPECT_EQ(TEST_FILE_1_LINES, readLineBatches(file, 16, batchSizes));
+}
+
+TEST(FileTests, EachLineBatchWithLinesLongerThanBuffer) {
+  // The first line is longer than the maximum buffer size, so it has to
+  // be copied
+  File file = File::open(pt::getResourcePath("test_file_1.txt"),
+			 FileCreationMode::OPEN_ONLY,
+			 FileAccessMode::READ_ONLY, FileOpenOptions::NONE,
+			 FilePermissions::ALL_RW, 8, 32);
+  std::vector<size_t> batchSizes;
+  EXPECT_EQ(TEST_FILE_1_LINES, readLineBatches(file, 16, batchSizes));
+}
+
+TEST(FileTests, EachLineBatchWithoutNewlineAtEnd) {
+  const std::string fileName = pt::getScratchFile("tmp_file_1.txt");
+  pt::writeTextFile(fileName, TEST_FILE_1_CONTENT.substr(
+      0, TEST_FILE_1_CONTENT.size() - 1
+  ));
+
+  std::vector<std::string> truth(TEST_FILE_1_LINES);
+  truth.back().pop_back();
+
+  File file = File::open(fileName, FileCreationMode::OPEN_ONLY,
+			 FileAccessMode::READ_ONLY);
+  std::vector<size_t> batchSizes;
+  EXPECT_EQ(truth, readLineBatches(file, 100, batchSizes));
+  EXPECT_EQ((std::vector<size_t>{ 2, 1 }), batchSizes);
+
+  file = File::open(fileName, FileAccessMode::WRITE_ONLY,
+		    FileOpenOptions::TRUNCATE);
+  file = File::open(fileName, FileCreationMode::OPEN_ONLY,
+		    FileAccessMode::READ_ONLY);
+  batchSizes.clear();
+  EXPECT_TRUE(readLineBatches(file, 100, batchSizes).empty());
+  EXPECT_TRUE(batchSizes.empty());
+  pt::removeFile(fileName);
+}
+
+TEST(FileTests, ReadLinesCompact) {
+  File file = File::open(pt::getResourcePath("test_file_1.txt"),
+			 FileCreationMode::OPEN_ONLY,
+			 FileAccessMode::READ_ONLY, FileOpenOptions::NONE,
+			 FilePermissions::ALL_RW, 12, 1024);
+  const LineBlock block = file.readLinesCompact();
+
+  ASSERT_EQ(TEST_FILE_1_LINES.size(), block.size());
+  for (size_t i = 0; i < block.size(); ++i) {
+    EXPECT_EQ(TEST_FILE_1_LINES[i], block[i]);
+  }
+
+  // The text buffer was sized from the file, so it holds no extra space
+  EXPECT_EQ(TEST_FILE_1_CONTENT.size() + 4 * (block.size() + 1),
+	    block.memoryUsage());
+}
+
+TEST(FileTests, ReadLinesCompactAfterReadLine) {
+  File file = File::open(pt::getResourcePath("test_file_1.txt"),
+			 FileCreationMode::OPEN_ONLY,
+			 FileAccessMode::READ_ONLY);
+
+  EXPECT_EQ(TEST_FILE_1_LINES[0], file.readLine());
+  const LineBlock block = file.readLinesCompact();
+  ASSERT_EQ(2, block.size());
+  EXPECT_EQ(TEST_FILE_1_LINES[1], block[0]);
+  EXPECT_EQ(TEST_FILE_1_LINES[2], block[1]);
+}
+
+TEST(FileTests, HugePageBuffers) {
+  // One line longer than a huge page forces the buffer past it
+  const std::string line = std::string(3 * File::HUGE_PAGE_SIZE, 'x') + "\n";
+  const std::string fileName = pt::getScratchFile("huge_pages.txt");
+  pt::writeTextFile(fileName, line + TEST_FILE_1_CONTENT);
+
+  File file = File::open(fileName, FileCreationMode::OPEN_ONLY,
+			 FileAccessMode::READ_ONLY);
+  EXPECT_FALSE(file.hugePages());
+  file.setHugePages(true);
+  EXPECT_TRUE(file.hugePages());
+
+  EXPECT_EQ(line, file.readLine());
+  EXPECT_EQ(TEST_FILE_1_LINES[0], file.readLine());
+
+  // The buffer doubled from 1 KB through 2 MB and 4 MB to 8 MB.  Whether
+  // the kernel had huge pages to give the 8 MB buffer depends on the
+  // system.
+  const FileStatistics& stats = file.stats();
+  EXPECT_EQ(3, stats.hugePageBuffers);
+  EXPECT_LE(stats.hugePageBytes, 4 * File::HUGE_PAGE_SIZE);
+
+  file.close();
+  pt::removeFile(fileName);
+}
+
+TEST(FileTests, AdaptiveBufferShrinksAfterLongLine) {
+  std::vector<std::string> lines(1, std::string(1024 * 1024, 'x') + "\n");
+  for (int i = 0; i < 1000; ++i) {
+    lines.push_back("Line " + std::to_string(i) + "\n");
+  }
+  const std::string fileName = pt::getScratchFile("adaptive_buffer.txt");
+  pt::writeTextFile(fileName, lines);
+
+  File fixed = File::open(fileName, FileAccessMode::READ_ONLY);
+  EXPECT_EQ(BufferPolicy::FIXED, fixed.bufferPolicy());
+  readAndCheckLines(fixed, lines);
+  EXPECT_EQ(0, fixed.stats().bufferShrinks);
+  EXPECT_LT(1024 * 1024, fixed.bufferSize());
+
+  File adaptive = File::open(fileName, FileAccessMode::READ_ONLY,
+			     FileOpenOptions::NONE, File::INITIAL_BUFFER_SIZE,
+			     File::MAX_BUFFER_SIZE, BufferPolicy::ADAPTIVE);
+  EXPECT_EQ(BufferPolicy::ADAPTIVE, adaptive.bufferPolicy());
+  readAndCheckLines(adaptive, lines);
+  EXPECT_EQ(1, adaptive.stats().bufferShrinks);
+  EXPECT_EQ(File::INITIAL_BUFFER_SIZE, adaptive.bufferSize());
+
+  // Growing faster than doubling takes fewer steps to reach 1 MB
+  EXPECT_LT(adaptive.stats().bufferGrowths, fixed.stats().bufferGrowths);
+
+  pt::removeFile(fileName);
+}
+
+TEST(FileTests, AdaptiveBufferKeepsSizeForLongLines) {
+  // Every line is long, so they aren't outliers
+  std::vector<std::string> lines;
+  for (int i = 0; i < 600; ++i) {
+    lines.push_back(std::string(4096 + i, 'a' + i % 26) + "\n");
+  }
+  const std::string fileName = pt::getScratchFile("adaptive_buffer.txt");
+  pt::writeTextFile(fileName, lines);
+
+  File file = File::open(fileName, FileCreationMode::OPEN_ONLY,
+			 FileAccessMode::READ_ONLY, FileOpenOptions::NONE,
+			 FilePermissions::ALL_RW, File::INITIAL_BUFFER_SIZE,
+			 File::MAX_BUFFER_SIZE, BufferPolicy::ADAPTIVE);
+  readAndCheckLines(file, lines);
+  EXPECT_EQ(0, file.stats().bufferShrinks);
+  EXPECT_LE(8192, file.bufferSize());
+
+  file.close();
+  pt::removeFile(fileName);
+}
+
+TEST(FileTests, AdaptiveBufferShrinksWhileReadingLineLongerThanMax) {
+  // The first line grows the buffer to its maximum, the short lines then
+  // schedule a shrink, and the last line is longer than the maximum.
+  // Whether the shrink happens while that line is being accumulated
+  // depends on where it starts in the buffer, so try several offsets.
+  for (size_t firstLength : { 2500, 3000, 4000, 5000, 7000 }) {
+    std::vector<std::string> lines(1, std::string(firstLength, 'x') + "\n");
+    for (int i = 0; i < 255; ++i) {
+      lines.push_back("Line " + std::to_string(i) + "\n");
+    }
+    lines.push_back(std::string(20000, 'y') + "\n");
+    const std::string fileName = pt::getScratchFile("adaptive_buffer.txt");
+  pt::writeTextFile(fileName, lines);
+
+    File file = File::open(fileName, FileCreationMode::OPEN_ONLY,
+			   FileAccessMode::READ_ONLY, FileOpenOptions::NONE,
+			   FilePermissions::ALL_RW, 1024, 4096,
+			   BufferPolicy::ADAPTIVE);
+    readAndCheckLines(file, lines);
+    EXPECT_EQ(1, file.stats().bufferShrinks);
+
+    file.close();
+    pt::removeFile(fileName);
+  }
+}
+
+TEST(FileTests, ReadNumbers) {
+  File file = openText("numbers.txt", "  12 -7\n+3\t 4.5e1\r\n-0.25");
+  int64_t i;
+  double d;
+
+  ASSERT_TRUE(file.readInt64(i));
+  EXPECT_EQ(12, i);
+  ASSERT_TRUE(file.readInt64(i));
+  EXPECT_EQ(-7, i);
+  ASSERT_TRUE(file.readInt64(i));
+  EXPECT_EQ(3, i);
+  ASSERT_TRUE(file.readDouble(d));
+  EXPECT_EQ(45.0, d);
+  ASSERT_TRUE(file.readDouble(d));
+  EXPECT_EQ(-0.25, d);
+  EXPECT_FALSE(file.readDouble(d));
+  EXPECT_FALSE(file.readInt64(i));
+  pt::removeFile("numbers.txt");
+}
+
+TEST(FileTests, ReadNumbersAcrossBufferBoundaries) {
+  std::string text;
+  int64_t expected = 0;
+  for (int64_t i = 0; i < 1000; ++i) {
+    text += std::to_string(i * 1234567) + ((i % 7) ? " " : "\n");
+    expected += i * 1234567;
+  }
+  text += "3.14159265358979323846";
+
+  // The buffer starts smaller than a number, so it has to grow
+  File file = openText("numbers.txt", text, 4, 64);
+  int64_t total = 0;
+  int64_t value;
+  for (int i = 0; i < 1000; ++i) {
+    ASSERT_TRUE(file.readInt64(value));
+    total += value;
+  }
+  EXPECT_EQ(expected, total);
+
+  double pi;
+  ASSERT_TRUE(file.readDouble(pi));
+  EXPECT_DOUBLE_EQ(3.14159265358979323846, pi);
+  EXPECT_FALSE(file.readDouble(pi));
+  pt::removeFile("numbers.txt");
+}
+
+TEST(FileTests, EachNumber) {
+  File file = openText("numbers.txt", "1.5 2.5\n3\n");
+  std::vector<double> values;
+  file.eachNumber([&values](double x) { values.push_back(x); });
+  EXPECT_EQ(std::vector<double>({ 1.5, 2.5, 3.0 }), values);
+
+  file = openText("numbers.txt", "10\n20\n30\n");
+  int64_t total = 0;
+  file.eachNumber<int64_t>([&total](int64_t n) { total += n; });
+  EXPECT_EQ(60, total);
+  pt::removeFile("numbers.txt");
+}
+
+TEST(FileTests, ReadInvalidNumbers) {
+  File file = openText("numbers.txt", "12 1.5 abc 99999999999999999999");
+  int64_t i;
+  double d;
+
+  ASSERT_TRUE(file.readInt64(i));
+  EXPECT_THROW(file.readInt64(i), IOError);   // 1.5
+  EXPECT_THROW(file.readDouble(d), IOError);  // abc
+  EXPECT_THROW(file.readInt64(i), IOError);   // Out of range
+  EXPECT_FALSE(file.readInt64(i));
+
+  file = openText("numbers.txt", "123456789012345678", 4, 8);
+  EXPECT_THROW(file.readInt64(i), IOError);
+  pt::removeFile("numbers.txt");
+}
+
+TEST(FileTests, ReadNumberColumns) {
+  File file = openText("numbers.csv",
+		       "name,count,weight\n"
+		       "a,1, 2.5\n"
+		       "\"b\",-2,-4e-1\r\n"
+		       "c,3,1e3\n");
+
+  // Skip the header
+  file.readLine();
+  EXPECT_EQ(std::vector<double>({ 2.5, -0.4, 1000.0 }),
+	    file.readDoubleColumn(DelimitedFormat::CSV, 2));
+  file.seek(FileOrigin::START, 0);
+  file.readLine();
+  EXPECT_EQ(std::vector<int64_t>({ 1, -2, 3 }),
+	    file.readInt64Column(DelimitedFormat::CSV, 1));
+
+  file.seek(FileOrigin::START, 0);
+  EXPECT_THROW(file.readInt64Column(DelimitedFormat::CSV, 1), IOError);
+  file.seek(FileOrigin::START, 0);
+  file.readLine();
+  EXPECT_THROW(file.readInt64Column(DelimitedFormat::CSV, 3), IOError);
+  pt::removeFile("numbers.csv");
+}
+
+TEST(FileTests, FirstDifference) {
+  // Longer than the chunks firstDifference() compares at a time
+  std::string text;
+  for (int i = 0; text.size() < 600 * 1024; ++i) {
+    text += "Line " + std::to_string(i) + "\n";
+  }
+  std::string changed(text);
+  changed[500 * 1024] = '#';
+
+  File original = openText("original.txt", text);
+  File copy = openText("copy.txt", text);
+  EXPECT_EQ(File::NO_DIFFERENCE, original.firstDifference(copy));
+
+  // Offsets count from each file's position, including buffered data
+  original.seek(FileOrigin::START, 0);
+  copy.seek(FileOrigin::START, 0);
+  EXPECT_EQ("Line 0\n", original.readLine());
+  EXPECT_EQ("Line 0\n", copy.readLine());
+  EXPECT_EQ(File::NO_DIFFERENCE, copy.firstDifference(original));
+
+  original.seek(FileOrigin::START, 0);
+  copy.seek(FileOrigin::START, 0);
+  EXPECT_EQ("Line 0\n", original.readLine());
+  EXPECT_EQ(5, copy.firstDifference(original));
+
+  original.seek(FileOrigin::START, 0);
+  File different = openText("changed.txt", changed);
+  EXPECT_EQ(500 * 1024, original.firstDifference(different));
+
+  // A prefix differs at the end of the shorter file
+  original.seek(FileOrigin::START, 0);
+  File prefix = openText("prefix.txt", text.substr(0, 1000));
+  EXPECT_EQ(1000, prefix.firstDifference(original));
+
+  pt::removeFile("original.txt");
+  pt::removeFile("copy.txt");
+  pt::removeFile("changed.txt");
+  pt::removeFile("prefix.txt");
+}
+
+TEST(FileTests, FirstDifferenceWithPipe) {
+  File file = File::open(pt::getResourcePath("test_file_1.txt"),
+			 FileCreationMode::OPEN_ONLY,
+			 FileAccessMode::READ_ONLY);
+  Pipe pipe;
+  File reader(::dup(pipe.readFd()), "pipe reader");
+
+  // The pipe's size is unknown, so it is read to its end
+  ASSERT_EQ(20, ::write(pipe.writeFd(), TEST_FILE_1_CONTENT.data(), 20));
+  ASSERT_EQ(TEST_FILE_1_CONTENT.size() - 20,
+	    ::write(pipe.writeFd(), TEST_FILE_1_CONTENT.data() + 20,
+		    TEST_FILE_1_CONTENT.size() - 20));
+  pipe.closeWrite();
+  EXPECT_EQ(File::NO_DIFFERENCE, reader.firstDifference(file));
+  EXPECT_EQ(TEST_FILE_1_CONTENT.size(), reader.stats().bytesRead);
+}
+
+TEST(FileTests, FindAll) {
+  std::string text;
+  std::vector<uint64_t> truth;
+  for (int i = 0; i < 1000; ++i) {
+    if (i % 7 == 3) {
+      truth.push_back(text.size() + 2);
+      text += "a needle in a haystack\n";
+    } else {
+      text += "only hay " + std::to_string(i) + "\n";
+    }
+  }
+
+  // A small buffer puts many matches across its refills
+  for (size_t bufferSize : { (size_t)16, File::INITIAL_BUFFER_SIZE }) {
+    File file = openText("haystack.txt", text, bufferSize);
+    EXPECT_EQ(truth, file.findAll("needle"));
+  }
+
+  File file = openText("haystack.txt", "aaaaa");
+  EXPECT_EQ(std::vector<uint64_t>({ 0, 2 }), file.findAll("aa"));
+  file.seek(FileOrigin::START, 0);
+  EXPECT_EQ(std::vector<uint64_t>(), file.findAll(""));
+
+  // Offsets count from the current position
+  file.seek(FileOrigin::START, 1);
+  EXPECT_EQ(std::vector<uint64_t>({ 0, 2 }), file.findAll("aa"));
+
+  // The pattern can be as long as the largest buffer
+  std::vector<uint64_t> starts;
+  for (uint64_t offset : truth) {
+    starts.push_back(offset - 2);
+  }
+  file = openText("haystack.txt", text, 8, 8);
+  EXPECT_EQ(starts, file.findAll("a needle"));
+  file.seek(FileOrigin::START, 0);
+  EXPECT_THROW(file.findAll("a needle in"), IOError);
+  pt::removeFile("haystack.txt");
+}
+
+TEST(FileTests, EachMatch) {
+  File file = openText("haystack.txt", "xyxyxyz xyz", 4, 1024);
+  std::vector<uint64_t> offsets;
+
+  file.eachMatch("xyz", [&offsets](uint64_t offset) {
+    offsets.push_back(offset);
+  });
+  EXPECT_EQ(std::vector<uint64_t>({ 4, 8 }), offsets);
+  pt::removeFile("haystack.txt");
+}
+
+TEST(FileTests, EachMatchingLine) {
+  const std::string text("one needle\n"
+			 "no match\n"
+			 "needle, needle\n"
+			 "split nee\n"
+			 "dle\n"
+			 "last needle");
+  File file = openText("haystack.txt", text);
+  std::vector<uint64_t> offsets;
+  std::vector<std::string> lines;
+
+  file.eachMatchingLine("needle", [&](uint64_t offset,
+				      std::string_view line) {
+    offsets.push_back(offset);
+    lines.push_back(std::string(line));
+  });
+  EXPECT_EQ(std::vector<uint64_t>({ 0, 20, 49 }), offsets);
+  EXPECT_EQ(std::vector<std::string>({ "one needle\n", "needle, needle\n",
+				       "last needle" }),
+	    lines);
+
+  // Lines longer than the buffer
+  const std::string longLine = std::string(100, 'x') + "needle\n";
+  file = openText("haystack.txt", "short\n" + longLine + longLine, 16, 16);
+  offsets.clear();
+  lines.clear();
+  file.eachMatchingLine("needle", [&](uint64_t offset,
+				      std::string_view line) {
+    offsets.push_back(offset);
+    lines.push_back(std::string(line));
+  });
+  EXPECT_EQ(std::vector<uint64_t>({ 6, 6 + longLine.size() }), offsets);
+  EXPECT_EQ(std::vector<std::string>({ longLine, longLine }), lines);
+  pt::removeFile("haystack.txt");
+}
+
+TEST(FileTests, CountLines) {
+  std::string text;
+  for (int i = 0; i < 100000; ++i) {
+    text += "Line " + std::to_string(i) + "\n";
+  }
+
+  File file = openText("count_lines.txt", text);
+  EXPECT_EQ(100000, file.countLines());
+  EXPECT_EQ(0, file.countLines());
+
+  // Lines already in the buffer count too
+  file.seek(FileOrigin::START, 0);
+  EXPECT_EQ("Line 0\n", file.readLine());
+  EXPECT_EQ(99999, file.countLines());
+
+  file = openText("count_lines.txt", text + "no newline");
+  EXPECT_EQ(100001, file.countLines());
+
+  file = openText("count_lines.txt", "");
+  EXPECT_EQ(0, file.countLines());
+
+  file = openText("count_lines.txt", "\n\n");
+  EXPECT_EQ(2, file.countLines());
+  pt::removeFile("count_lines.txt");
+}
@@ -0,0 +1,34 @@
+#include <pistis/filesystem/HugePages.hpp>
+
+#include <gtest/gtest.h>
+
+#include <string.h>
+
+using namespace pistis::filesystem;
+
+TEST(HugePagesTests, AllocateAligned) {
+  static const size_t SIZE = hugepages::HUGE_PAGE_SIZE + 1000;
+  uint8_t* p = hugepages::allocate(SIZE);
+
+  ASSERT_NE(nullptr, p);
+  EXPECT_EQ(0, (uintptr_t)p % hugepages::HUGE_PAGE_SIZE);
+
+  // Rounded up to a whole number of huge pages, so the tail is usable too
+  ::memset(p, 0xA5, 2 * hugepages::HUGE_PAGE_SIZE);
+  EXPECT_EQ(0xA5, p[0]);
+  EXPECT_EQ(0xA5, p[2 * hugepages::HUGE_PAGE_SIZE - 1]);
+
+  // The kernel may not have huge pages to give, but never gives more
+  // than was asked for
+  EXPECT_LE(hugepages::backedBytes(p, SIZE), SIZE);
+  hugepages::release(p, SIZE);
+}
+
+TEST(HugePagesTests, BackedBytesOfOrdinaryMemory) {
+  static char text[] = "Not in a huge page";
+  EXPECT_EQ(0, hugepages::backedBytes(text, sizeof(text)));
+}
+
+TEST(HugePagesTests, ReleaseNull) {
+  hugepages::release(nullptr, hugepages::HUGE_PAGE_SIZE);
+}
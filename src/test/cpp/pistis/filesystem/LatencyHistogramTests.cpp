@@ -0,0 +1,62 @@
+#include <pistis/filesystem/LatencyHistogram.hpp>
+#include <gtest/gtest.h>
+
+using namespace pistis::filesystem;
+
+TEST(LatencyHistogramTests, Construct) {
+  LatencyHistogram histogram;
+  EXPECT_EQ(0, histogram.count());
+  EXPECT_EQ(0, histogram.total());
+  EXPECT_EQ(0, histogram.max());
+  EXPECT_EQ(0.0, histogram.mean());
+  EXPECT_EQ(0, histogram.percentile(0.5));
+}
+
+TEST(LatencyHistogramTests, BucketBounds) {
+  for (uint64_t v = 0; v < LatencyHistogram::SUB_BUCKETS; ++v) {
+    EXPECT_EQ(v, LatencyHistogram::bucketFor(v));
+  }
+
+  for (int b = 0; b < LatencyHistogram::NUM_BUCKETS; ++b) {
+    const uint64_t lower = LatencyHistogram::bucketLowerBound(b);
+    const uint64_t upper = LatencyHistogram::bucketUpperBound(b);
+    ASSERT_LE(lower, upper);
+    ASSERT_EQ(b, LatencyHistogram::bucketFor(lower));
+    ASSERT_EQ(b, LatencyHistogram::bucketFor(upper));
+    if (b) {
+      ASSERT_EQ(lower, LatencyHistogram::bucketUpperBound(b - 1) + 1);
+    }
+  }
+  EXPECT_EQ(LatencyHistogram::NUM_BUCKETS - 1,
+	    LatencyHistogram::bucketFor(UINT64_MAX));
+}
+
+TEST(LatencyHistogramTests, RecordAndPercentiles) {
+  LatencyHistogram histogram;
+  for (uint64_t v = 1; v <= 1000; ++v) {
+    histogram.record(v * 1000);
+  }
+
+  EXPECT_EQ(1000, histogram.count());
+  EXPECT_EQ(500500000, histogram.total());
+  EXPECT_EQ(1000000, histogram.max());
+  EXPECT_DOUBLE_EQ(500500.0, histogram.mean());
+
+  // Buckets are accurate to 1/SUB_BUCKETS of the value
+  const double tolerance = 1.0 / LatencyHistogram::SUB_BUCKETS;
+  EXPECT_NEAR(500000, histogram.percentile(0.5), 500000 * tolerance);
+  EXPECT_NEAR(990000, histogram.percentile(0.99), 990000 * tolerance);
+  EXPECT_EQ(1000000, histogram.percentile(1.0));
+}
+
+TEST(LatencyHistogramTests, Reset) {
+  LatencyHistogram histogram;
+  histogram.record(100);
+  histogram.record(100000);
+  histogram.reset();
+
+  EXPECT_EQ(0, histogram.count());
+  EXPECT_EQ(0, histogram.total());
+  EXPECT_EQ(0, histogram.max());
+  EXPECT_EQ(0, histogram.bucketCount(LatencyHistogram::bucketFor(100)));
+}
@@ -0,0 +1,97 @@
+#include <pistis/filesystem/LineBlock.hpp>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+using namespace pistis::filesystem;
+
+TEST(LineBlockTests, CreateEmpty) {
+  LineBlock block;
+  EXPECT_EQ(0, block.size());
+  EXPECT_TRUE(block.empty());
+  EXPECT_EQ(0, block.textSize());
+  EXPECT_TRUE(block.begin() == block.end());
+}
+
+TEST(LineBlockTests, AppendAndAccess) {
+  const std::vector<std::string> LINES{ "first\n", "", "third\n", "last" };
+  LineBlock block;
+
+  for (const std::string& line : LINES) {
+    block.append(line);
+  }
+  ASSERT_EQ(LINES.size(), block.size());
+  EXPECT_EQ(12 + 4, block.textSize());
+  for (size_t i = 0; i < LINES.size(); ++i) {
+    EXPECT_EQ(LINES[i], block[i]);
+  }
+
+  // Lines are stored back to back
+  EXPECT_EQ(block[0].data() + block[0].size(), block[1].data());
+  EXPECT_EQ(block[2].data() + block[2].size(), block[3].data());
+}
+
+TEST(LineBlockTests, Iterate) {
+  const std::vector<std::string> LINES{ "c\n", "a\n", "b\n" };
+  LineBlock block;
+  for (const std::string& line : LINES) {
+    block.append(line.data(), line.size());
+  }
+
+  std::vector<std::string> lines;
+  for (std::string_view line : block) {
+    lines.push_back(std::string(line));
+  }
+  EXPECT_EQ(LINES, lines);
+
+  EXPECT_EQ(3, block.end() - block.begin());
+  EXPECT_EQ("b\n", *(block.begin() + 2));
+  EXPECT_EQ("a\n", block.begin()[1]);
+  EXPECT_EQ("c\n", *std::min_element(block.begin(), block.end(),
+				     [](std::string_view x,
+					std::string_view y) { return y < x; }));
+  EXPECT_TRUE(std::binary_search(block.begin() + 1, block.end(),
+				 std::string_view("b\n")));
+}
+
+TEST(LineBlockTests, MemoryUsage) {
+  LineBlock block;
+  const std::string line("word\n");
+
+  block.reserveText(100000 * line.size());
+  for (int i = 0; i < 100000; ++i) {
+    block.append(line);
+  }
+  block.shrinkToFit();
+
+  // One byte per character plus four per line
+  EXPECT_EQ(100000 * line.size(), block.textSize());
+  EXPECT_EQ(100000 * (line.size() + 4) + 4, block.memoryUsage());
+}
+
+TEST(LineBlockTests, Clear) {
+  LineBlock block;
+  block.append("abc\n");
+  block.clear();
+  EXPECT_TRUE(block.empty());
+  block.append("def\n");
+  ASSERT_EQ(1, block.size());
+  EXPECT_EQ("def\n", block[0]);
+}
+
+TEST(LineBlockTests, MoveAndReuse) {
+  LineBlock block;
+  block.append("abc\n");
+
+  LineBlock other(std::move(block));
+  ASSERT_EQ(1, other.size());
+  EXPECT_EQ("abc\n", other[0]);
+
+  block.clear();
+  block.append("def\n");
+  ASSERT_EQ(1, block.size());
+  EXPECT_EQ("def\n", block[0]);
+}
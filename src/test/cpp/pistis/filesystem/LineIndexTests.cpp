@@ -0,0 +1,263 @@
+#include <pistis/filesystem/LineIndex.hpp>
+#include <pistis/filesystem/File.hpp>
+#include <pistis/filesystem/Path.hpp>
+#include <pistis/exceptions/IOError.hpp>
+
+#include "TestArtifacts.hpp"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+using namespace pistis::exceptions;
+using namespace pistis::filesystem;
+namespace pt = pistis::filesystem::testing;
+
+namespace {
+  static const std::string TEXT_FILE_NAME("line_index_test.txt");
+
+  std::string lineText(size_t n) {
+    return "This is line " + std::to_string(n) + "\n";
+  }
+
+  void appendText(const std::string& fileName, const std::string& text) {
+    File file = File::open(fileName, FileAccessMode::WRITE_ONLY,
+			   FileOpenOptions::APPEND);
+    file.write(text.data(), text.size());
+  }
+
+  class LineIndexTests : public ::testing::Test {
+  protected:
+    std::string fileName;
+
+    virtual void SetUp() {
+      fileName = pt::getScratchFile(TEXT_FILE_NAME);
+      removeFiles();
+    }
+
+    virtual void TearDown() {
+      removeFiles();
+    }
+
+    void removeFiles() {
+      pt::removeFile(fileName);
+      pt::removeFile(LineIndex::indexFileFor(fileName));
+    }
+
+    void writeLines(size_t first, size_t last) {
+      std::string text;
+      for (size_t i = first; i < last; ++i) {
+	text += lineText(i);
+      }
+      appendText(fileName, text);
+    }
+
+    File openTextFile() {
+      return File::open(fileName, FileCreationMode::OPEN_ONLY,
+			FileAccessMode::READ_ONLY);
+    }
+  };
+}
+
+TEST_F(LineIndexTests, BuildIndex) {
+  writeLines(0, 10);
+  File file = openTextFile();
+  LineIndex index = LineIndex::build(file, 3);
+  uint64_t line = 99;
+
+  EXPECT_EQ(3, index.interval());
+  EXPECT_EQ(10, index.lineCount());
+  EXPECT_EQ(path::fileSize(fileName), index.indexedSize());
+
+  EXPECT_EQ(0, index.nearestOffset(2, line));
+  EXPECT_EQ(0, line);
+  EXPECT_EQ(lineText(0).size() * 6, index.nearestOffset(7, line));
+  EXPECT_EQ(6, line);
+  EXPECT_EQ(lineText(0).size() * 9, index.nearestOffset(100, line));
+  EXPECT_EQ(9, line);
+}
+
+TEST_F(LineIndexTests, FinalLineWithoutNewline) {
+  appendText(fileName, "first\nsecond\nthird");
+  File file = openTextFile();
+  LineIndex index = LineIndex::build(file, 2);
+
+  EXPECT_EQ(3, index.lineCount());
+  EXPECT_EQ("third", file.lineAt(index, 2));
+  EXPECT_EQ("", file.lineAt(index, 3));
+}
+
+TEST_F(LineIndexTests, EmptyFile) {
+  appendText(fileName, "");
+  File file = openTextFile();
+  LineIndex index = LineIndex::build(file);
+
+  EXPECT_EQ(0, index.lineCount());
+  EXPECT_EQ("", file.lineAt(index, 0));
+}
+
+TEST_F(LineIndexTests, LineAt) {
+  writeLines(0, 25);
+  File file = openTextFile();
+  LineIndex index = LineIndex::build(file, 4);
+
+  for (size_t i = 0; i < 25; ++i) {
+    EXPECT_EQ(lineText(i), file.lineAt(index, i));
+  }
+  EXPECT_EQ(lineText(3), file.lineAt(index, 3));
+  EXPECT_EQ(lineText(4), file.readLine());
+  EXPECT_EQ("", file.lineAt(index, 25));
+}
+
+TEST_F(LineIndexTests, EachLineInRange) {
+  writeLines(0, 25);
+  File file = openTextFile();
+  LineIndex index = LineIndex::build(file, 4);
+  std::vector<std::string> lines;
+  const std::vector<std::string> TRUTH{
+    lineText(7), lineText(8), lineText(9), lineText(10)
+  };
+
+  file.eachLineInRange(index, 7, 11, [&lines](const std::string& line) {
+      lines.push_back(line);
+  });
+  EXPECT_EQ(TRUTH, lines);
+
+  lines.clear();
+  file.eachLineInRange(index, 23, 30, [&lines](const std::string& line) {
+      lines.push_back(line);
+  });
+  EXPECT_EQ((std::vector<std::string>{ lineText(23), lineText(24) }), lines);
+
+  lines.clear();
+  file.eachLineInRange(index, 5, 5, [&lines](const std::string& line) {
+      lines.push_back(line);
+  });
+  EXPECT_TRUE(lines.empty());
+}
+
+TEST_F(LineIndexTests, UpdateAfterAppend) {
+  writeLines(0, 10);
+  File file = openTextFile();
+  LineIndex index = LineIndex::build(file, 4);
+
+  EXPECT_FALSE(index.update(file));
+
+  writeLines(10, 20);
+  EXPECT_EQ(lineText(15), file.lineAt(index, 15));
+  EXPECT_TRUE(index.update(file));
+  EXPECT_EQ(20, index.lineCount());
+  EXPECT_EQ(path::fileSize(fileName), index.indexedSize());
+
+  uint64_t line;
+  index.nearestOffset(17, line);
+  EXPECT_EQ(16, line);
+  for (size_t i = 0; i < 20; ++i) {
+    EXPECT_EQ(lineText(i), file.lineAt(index, i));
+  }
+}
+
+TEST_F(LineIndexTests, UpdateCompletesPartialLine) {
+  appendText(fileName, "one\ntw");
+  File file = openTextFile();
+  LineIndex index = LineIndex::build(file, 1);
+
+  EXPECT_EQ(2, index.lineCount());
+  appendText(fileName, "o\nthree\n");
+  EXPECT_TRUE(index.update(file));
+  EXPECT_EQ(3, index.lineCount());
+  EXPECT_EQ("two\n", file.lineAt(index, 1));
+  EXPECT_EQ("three\n", file.lineAt(index, 2));
+}
+
+TEST_F(LineIndexTests, RebuildWhenFileShrinks) {
+  writeLines(0, 10);
+  File file = openTextFile();
+  LineIndex index = LineIndex::build(file, 4);
+
+  {
+    File writer = File::open(fileName, FileAccessMode::WRITE_ONLY,
+			     FileOpenOptions::TRUNCATE);
+    writer.write("a\nb\n", 4);
+  }
+  EXPECT_TRUE(index.update(file));
+  EXPECT_EQ(2, index.lineCount());
+  EXPECT_EQ("b\n", file.lineAt(index, 1));
+}
+
+TEST_F(LineIndexTests, SaveAndLoad) {
+  writeLines(0, 50);
+  File file = openTextFile();
+  LineIndex index = LineIndex::build(file, 8);
+  const std::string indexName = LineIndex::indexFileFor(fileName);
+
+  index.save(indexName);
+  LineIndex loaded = LineIndex::load(indexName);
+  EXPECT_EQ(index.interval(), loaded.interval());
+  EXPECT_EQ(index.lineCount(), loaded.lineCount());
+  EXPECT_EQ(index.indexedSize(), loaded.indexedSize());
+  for (size_t i = 0; i < 50; ++i) {
+    uint64_t expectedLine, line;
+    EXPECT_EQ(index.nearestOffset(i, expectedLine),
+	      loaded.nearestOffset(i, line));
+    EXPECT_EQ(expectedLine, line);
+  }
+}
+
+TEST_F(LineIndexTests, LoadRejectsOtherFiles) {
+  writeLines(0, 2);
+  EXPECT_THROW(LineIndex::load(fileName), IOError);
+}
+
+TEST_F(LineIndexTests, LoadRejectsOverflowingOffsetCount) {
+  writeLines(0, 10);
+  File file = openTextFile();
+  const std::string indexName = LineIndex::indexFileFor(fileName);
+  LineIndex::build(file, 1).save(indexName);
+
+  // Claim 2^61 more offsets than the file holds, so numOffsets * 8 wraps
+  // around to the real size, and a line count to match
+  std::string data = pt::readTextFile(indexName);
+  const uint64_t numOffsets = 11 + (uint64_t(1) << 61);
+  for (size_t i = 0; i < 8; ++i) {
+    data[16 + i] = (char)(((numOffsets - 1) >> (8 * i)) & 0xFF);
+    data[40 + i] = (char)((numOffsets >> (8 * i)) & 0xFF);
+  }
+  pt::writeTextFile(indexName, data);
+
+  EXPECT_THROW(LineIndex::load(indexName), IOError);
+}
+
+TEST_F(LineIndexTests, ForFile) {
+  const std::string indexName = LineIndex::indexFileFor(fileName);
+  writeLines(0, 10);
+
+  LineIndex index = LineIndex::forFile(fileName, 4);
+  EXPECT_TRUE(path::exists(indexName));
+  EXPECT_EQ(10, index.lineCount());
+
+  writeLines(10, 30);
+  index = LineIndex::forFile(fileName, 4);
+  EXPECT_EQ(30, index.lineCount());
+  EXPECT_EQ(30, LineIndex::load(indexName).lineCount());
+
+  // A different interval rebuilds the index
+  index = LineIndex::forFile(fileName, 16);
+  EXPECT_EQ(16, index.interval());
+  EXPECT_EQ(16, LineIndex::load(indexName).interval());
+  EXPECT_EQ(30, index.lineCount());
+
+  File file = openTextFile();
+  EXPECT_EQ(lineText(21), file.lineAt(index, 21));
+}
+
+TEST_F(LineIndexTests, ForFileRebuildsCorruptIndex) {
+  const std::string indexName = LineIndex::indexFileFor(fileName);
+  writeLines(0, 10);
+  appendText(indexName, "garbage");
+
+  LineIndex index = LineIndex::forFile(fileName, 4);
+  EXPECT_EQ(10, index.lineCount());
+  EXPECT_EQ(10, LineIndex::load(indexName).lineCount());
+}
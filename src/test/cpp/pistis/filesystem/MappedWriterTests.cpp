@@ -0,0 +1,156 @@
+#include <pistis/filesystem/MappedWriter.hpp>
+#include <pistis/filesystem/Path.hpp>
+#include <pistis/exceptions/IOError.hpp>
+
+#include "TestArtifacts.hpp"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include <string.h>
+
+using namespace pistis::exceptions;
+using namespace pistis::filesystem;
+namespace pt = pistis::filesystem::testing;
+
+namespace {
+  static const std::string TEST_FILE("mapped_writer_test.dat");
+
+  class MappedWriterTests : public ::testing::Test {
+  protected:
+    std::string fileName;
+
+    virtual void SetUp() {
+      fileName = pt::getScratchFile(TEST_FILE);
+      pt::removeFile(fileName);
+    }
+
+    virtual void TearDown() {
+      pt::removeFile(fileName);
+    }
+  };
+}
+
+TEST_F(MappedWriterTests, WriteAndClose) {
+  static const std::string TEXT("Written through a memory mapping.\n");
+  MappedWriter writer = MappedWriter::open(fileName);
+
+  EXPECT_EQ(0, writer.size());
+  writer.write(TEXT.data(), TEXT.size());
+  EXPECT_EQ(TEXT.size(), writer.size());
+  EXPECT_GE(writer.capacity(), MappedWriter::DEFAULT_INITIAL_CAPACITY);
+  EXPECT_EQ(TEXT, std::string((const char*)writer.data(), writer.size()));
+
+  writer.close();
+  EXPECT_EQ(TEXT.size(), path::fileSize(fileName));
+  EXPECT_EQ(TEXT, pt::readTextFile(fileName));
+}
+
+TEST_F(MappedWriterTests, GrowBeyondInitialCapacity) {
+  MappedWriter writer = MappedWriter::open(fileName, 4096);
+  std::string truth;
+
+  for (int i = 0; i < 10000; ++i) {
+    const std::string record = "Record " + std::to_string(i) + "\n";
+    writer.write(record.data(), record.size());
+    truth += record;
+  }
+  EXPECT_EQ(truth.size(), writer.size());
+  EXPECT_GE(writer.capacity(), truth.size());
+
+  writer.close();
+  EXPECT_EQ(truth, pt::readTextFile(fileName));
+}
+
+TEST_F(MappedWriterTests, ReserveAndCommit) {
+  MappedWriter writer = MappedWriter::open(fileName, 4096);
+
+  uint8_t* p = writer.reserve(10000);
+  EXPECT_GE(writer.capacity(), 10000);
+  ::memset(p, 'a', 6000);
+  writer.commit(6000);
+
+  p = writer.reserve(3);
+  ::memcpy(p, "xyz", 3);
+  writer.commit(2);
+  writer.close();
+
+  EXPECT_EQ(std::string(6000, 'a') + "xy", pt::readTextFile(fileName));
+}
+
+TEST_F(MappedWriterTests, CommitMoreThanReserved) {
+  MappedWriter writer = MappedWriter::open(fileName, 4096);
+  EXPECT_THROW(writer.commit(1), IOError);
+
+  uint8_t* p = writer.reserve(3);
+  ::memcpy(p, "abc", 3);
+  EXPECT_THROW(writer.commit(writer.capacity() + 1), IOError);
+  EXPECT_EQ(0, writer.size());
+
+  writer.commit(3);
+  writer.close();
+  EXPECT_EQ("abc", pt::readTextFile(fileName));
+}
+
+TEST_F(MappedWriterTests, ReplaceExistingFile) {
+  pt::writeTextFile(fileName, std::string(100000, 'q'));
+
+  MappedWriter writer = MappedWriter::open(fileName);
+  writer.write("short", 5);
+  writer.close();
+  EXPECT_EQ("short", pt::readTextFile(fileName));
+}
+
+TEST_F(MappedWriterTests, EmptyFile) {
+  MappedWriter writer = MappedWriter::open(fileName);
+  EXPECT_EQ(nullptr, writer.data());
+  writer.close();
+  EXPECT_EQ(0, path::fileSize(fileName));
+}
+
+TEST_F(MappedWriterTests, DestructorCloses) {
+  {
+    MappedWriter writer = MappedWriter::open(fileName);
+    writer.write("abc", 3);
+    writer.sync();
+  }
+  EXPECT_EQ("abc", pt::readTextFile(fileName));
+}
+
+TEST_F(MappedWriterTests, MoveWriter) {
+  MappedWriter writer = MappedWriter::open(fileName, 4096);
+  writer.write("abc", 3);
+
+  MappedWriter other(std::move(writer));
+  EXPECT_EQ(0, writer.size());
+  EXPECT_EQ(nullptr, writer.data());
+  EXPECT_EQ(3, other.size());
+  other.write("def", 3);
+  writer.close();
+  other.close();
+  EXPECT_EQ("abcdef", pt::readTextFile(fileName));
+}
+
+TEST_F(MappedWriterTests, RequiresReadWriteAccess) {
+  MappedWriter writer(File::open(fileName, FileAccessMode::WRITE_ONLY));
+  EXPECT_THROW(writer.write("abc", 3), IOError);
+}
+
+TEST_F(MappedWriterTests, HugePages) {
+  const std::string text(3 * hugepages::HUGE_PAGE_SIZE, 'h');
+  MappedWriter writer = MappedWriter::open(fileName);
+
+  EXPECT_FALSE(writer.hugePages());
+  EXPECT_EQ(0, writer.hugePageBytes());
+  writer.setHugePages(true);
+  EXPECT_TRUE(writer.hugePages());
+
+  // Shared file mappings get huge pages only on some filesystems
+  writer.write(text.data(), text.size());
+  EXPECT_LE(writer.hugePageBytes(), writer.capacity());
+
+  writer.close();
+  EXPECT_EQ(text, pt::readTextFile(fileName));
+}
@@ -0,0 +1,176 @@
+#include <pistis/filesystem/MergeReader.hpp>
+#include <pistis/filesystem/File.hpp>
+#include <pistis/exceptions/IOError.hpp>
+
+#include "TestArtifacts.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace pistis::exceptions;
+using namespace pistis::filesystem;
+namespace pt = pistis::filesystem::testing;
+
+namespace {
+  std::string shardName(size_t i) {
+    return pt::getScratchFile("merge_reader_shard_" + std::to_string(i) +
+			      ".txt");
+  }
+
+  class MergeReaderTests : public ::testing::Test {
+  protected:
+    std::vector<std::string> shards;
+
+    virtual void TearDown() {
+      for (const std::string& name : shards) {
+	pt::removeFile(name);
+      }
+    }
+
+    // Write n shards of sorted random lines and return all the lines,
+    // sorted
+    std::vector<std::string> createShards(size_t n, size_t maxLines,
+					  unsigned seed) {
+      std::mt19937 random(seed);
+      std::uniform_int_distribution<size_t> lineCount(0, maxLines);
+      std::uniform_int_distribution<int> value(0, 999);
+      std::vector<std::string> all;
+
+      for (size_t i = 0; i < n; ++i) {
+	std::vector<std::string> lines(lineCount(random));
+	for (std::string& line : lines) {
+	  line = std::to_string(value(random)) + "\n";
+	}
+	std::sort(lines.begin(), lines.end());
+	shards.push_back(shardName(i));
+	pt::writeTextFile(shards.back(), lines);
+	all.insert(all.end(), lines.begin(), lines.end());
+      }
+      std::sort(all.begin(), all.end());
+      return all;
+    }
+  };
+}
+
+TEST_F(MergeReaderTests, MergeShards) {
+  for (size_t n = 1; n <= 9; ++n) {
+    shards.clear();
+    const std::vector<std::string> truth = createShards(n, 200, n);
+    MergeReader reader(shards);
+    std::vector<std::string> merged;
+
+    EXPECT_EQ(n, reader.fileCount());
+    while (reader.next()) {
+      merged.push_back(reader.line());
+    }
+    EXPECT_EQ(truth, merged) << "with " << n << " shards";
+    EXPECT_FALSE(reader.next());
+  }
+}
+
+TEST_F(MergeReaderTests, NoFiles) {
+  MergeReader reader(std::vector<std::string>{});
+  EXPECT_EQ(0, reader.fileCount());
+  EXPECT_FALSE(reader.next());
+}
+
+TEST_F(MergeReaderTests, EmptyFiles) {
+  shards = { shardName(0), shardName(1), shardName(2) };
+  pt::writeTextFile(shards[0], "");
+  pt::writeTextFile(shards[1], "b\n");
+  pt::writeTextFile(shards[2], "");
+
+  MergeReader reader(shards);
+  ASSERT_TRUE(reader.next());
+  EXPECT_EQ("b\n", reader.line());
+  EXPECT_EQ(1, reader.source());
+  EXPECT_FALSE(reader.next());
+}
+
+TEST_F(MergeReaderTests, EqualLinesComeOutInFileOrder) {
+  shards = { shardName(0), shardName(1), shardName(2) };
+  pt::writeTextFile(shards[0], "a\nc\n");
+  pt::writeTextFile(shards[1], "a\nb\nc\n");
+  pt::writeTextFile(shards[2], "a\nc\n");
+
+  const std::vector<std::pair<std::string, size_t>> TRUTH{
+    { "a\n", 0 }, { "a\n", 1 }, { "a\n", 2 }, { "b\n", 1 },
+    { "c\n", 0 }, { "c\n", 1 }, { "c\n", 2 }
+  };
+  std::vector<std::pair<std::string, size_t>> merged;
+  MergeReader reader(shards);
+
+  while (reader.next()) {
+    merged.push_back(std::make_pair(reader.line(), reader.source()));
+  }
+  EXPECT_EQ(TRUTH, merged);
+}
+
+TEST_F(MergeReaderTests, CustomComparator) {
+  auto byLength = [](const std::string& x, const std::string& y) {
+    return x.size() < y.size();
+  };
+  shards = { shardName(0), shardName(1) };
+  pt::writeTextFile(shards[0], "z\nyyy\nxxxxx\n");
+  pt::writeTextFile(shards[1], "aa\nbbbb\n");
+
+  const std::vector<std::string> TRUTH{
+    "z\n", "aa\n", "yyy\n", "bbbb\n", "xxxxx\n"
+  };
+  std::vector<std::string> merged;
+  MergeReader reader(shards, byLength);
+
+  reader.eachLine([&merged](const std::string& line) {
+      merged.push_back(line);
+  });
+  EXPECT_EQ(TRUTH, merged);
+}
+
+TEST_F(MergeReaderTests, MergeOpenFiles) {
+  const std::vector<std::string> truth = createShards(4, 50, 99);
+  std::vector<File> files;
+  std::vector<std::string> merged;
+
+  for (const std::string& name : shards) {
+    files.push_back(File::open(name, FileCreationMode::OPEN_ONLY,
+			       FileAccessMode::READ_ONLY));
+  }
+
+  MergeReader reader(std::move(files));
+  reader.eachLine([&merged](const std::string& line) {
+      merged.push_back(line);
+  });
+  EXPECT_EQ(truth, merged);
+}
+
+TEST_F(MergeReaderTests, LastLineWithoutNewline) {
+  shards = { shardName(0), shardName(1) };
+  pt::writeTextFile(shards[0], "a\nc");
+  pt::writeTextFile(shards[1], "b\n");
+
+  const std::vector<std::string> TRUTH{ "a\n", "b\n", "c" };
+  std::vector<std::string> merged;
+  MergeReader(shards).eachLine([&merged](const std::string& line) {
+      merged.push_back(line);
+  });
+  EXPECT_EQ(TRUTH, merged);
+}
+
+TEST_F(MergeReaderTests, MissingFile) {
+  EXPECT_THROW(MergeReader(std::vector<std::string>{ shardName(42) }),
+	       IOError);
+}
+
+TEST(MergeReaderBufferTests, BufferSizeFor) {
+  EXPECT_EQ(MergeReader::MAX_BUFFER_SIZE,
+	    MergeReader::bufferSizeFor(2, 64 * 1024 * 1024));
+  EXPECT_EQ(1024 * 1024, MergeReader::bufferSizeFor(64, 64 * 1024 * 1024));
+  EXPECT_EQ(MergeReader::MIN_BUFFER_SIZE,
+	    MergeReader::bufferSizeFor(100000, 64 * 1024 * 1024));
+  EXPECT_EQ(MergeReader::MAX_BUFFER_SIZE,
+	    MergeReader::bufferSizeFor(0, 64 * 1024 * 1024));
+}
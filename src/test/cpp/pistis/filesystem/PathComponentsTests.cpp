@@ -0,0 +1,60 @@
+#include <pistis/filesystem/PathComponents.hpp>
+#include <pistis/filesystem/Path.hpp>
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace pistis::filesystem;
+
+namespace {
+  std::vector<std::string> componentsOf(std::string_view p) {
+    std::vector<std::string> result;
+    for (std::string_view component : path::components(p)) {
+      result.push_back(std::string(component));
+    }
+    return result;
+  }
+}
+
+TEST(PathComponentsTests, SameAsSplit) {
+  for (const std::string p : { "", "/", "//", "foo", "foo/", "foo//bar",
+			       "/foo/bar/baz", "//foo/bar/baz",
+			       "/foo/bar/baz///", "./a/../b/" }) {
+    EXPECT_EQ(path::split(p), componentsOf(p)) << "for \"" << p << "\"";
+  }
+}
+
+TEST(PathComponentsTests, ComponentsAreViewsIntoPath) {
+  const std::string p("/usr//lib/");
+  std::vector<std::string_view> views;
+  path::splitViewsAndCall(p, [&views](std::string_view component) {
+    views.push_back(component);
+  });
+
+  ASSERT_EQ(4, views.size());
+  EXPECT_EQ("/", views[0]);
+  EXPECT_EQ(p.data(), views[0].data());
+  EXPECT_EQ("usr", views[1]);
+  EXPECT_EQ(p.data() + 1, views[1].data());
+  EXPECT_EQ("lib", views[2]);
+  EXPECT_EQ(p.data() + 6, views[2].data());
+  EXPECT_EQ("", views[3]);
+  EXPECT_EQ(p.data() + p.size(), views[3].data());
+}
+
+TEST(PathComponentsTests, Iterator) {
+  const path::Components components = path::components("a/bb/c");
+  path::ComponentIterator i = components.begin();
+
+  EXPECT_EQ("a", *i);
+  EXPECT_EQ(2, (++i)->size());
+  EXPECT_EQ("bb", *i++);
+  EXPECT_EQ("c", *i);
+  EXPECT_NE(components.end(), i);
+  EXPECT_EQ(components.end(), ++i);
+  EXPECT_EQ(components.begin(), components.begin());
+  EXPECT_EQ(components.end(), path::components("").begin());
+}
@@ -136,6 +136,12 @@ TEST(PathTests, CommonPrefix) {
 	    commonPrefix("alpha/beta/gamma/delta",
 			 "alpha/beta/gamma/epsilon"));
 
+  // Whole components match, whichever path is longer
+  EXPECT_EQ("/foo", commonPrefix("/foo/bar", "/foo/barbaz"));
+  EXPECT_EQ("/alpha/beta", commonPrefix("/alpha/beta/gamma", "/alpha/beta"));
+  EXPECT_EQ("/alpha/beta", commonPrefix("/alpha/beta", "/alpha/beta/gamma"));
+  EXPECT_EQ("/alpha/beta", commonPrefix("/alpha/beta/", "/alpha/beta"));
+
   std::vector<std::string> paths{
       "/foo/bar/alpha/beta", "/foo/bar/alpha", "/foo/bar/delta/gamma/epsilon"
   };
@@ -215,6 +221,16 @@ TEST(PathTests, FileSize) {
   EXPECT_EQ(sizeof(TEXT) - 1, fileSize(tempFile.name()));
 }
 
+TEST(PathTests, LineCount) {
+  static const char TEXT[] = "one\ntwo\nthree";
+  TemporaryFile tempFile(createTempName("testing", ".txt"));
+
+  EXPECT_EQ(0, lineCount(tempFile.name()));
+  tempFile.write(TEXT, sizeof(TEXT) - 1);
+  EXPECT_EQ(3, lineCount(tempFile.name()));
+  EXPECT_THROW(lineCount(createTempName("does_not_exist", ".txt")), IOError);
+}
+
 TEST(PathTests, IsFile) {
   TemporaryFile tempFile(createTempName("testing", ".txt"));
   TemporaryDirectory tempDirectory(createTempName("dir", ""));
@@ -244,6 +260,40 @@ TEST(PathTests, SameFile) {
   EXPECT_FALSE(isSameFile(tempFile.name(), doesntExist));
 }
 
+TEST(PathTests, SameContent) {
+  // Longer than the chunks File::firstDifference() compares at a time
+  std::string text(600 * 1024, 'x');
+  TemporaryFile tempFile(createTempName("testing", ".txt"));
+  TemporaryFile copy(createTempName("copy", ".txt"));
+  TemporaryFile changed(createTempName("changed", ".txt"));
+  TemporaryFile shorter(createTempName("shorter", ".txt"));
+  TemporaryFile empty(createTempName("empty", ".txt"));
+  std::string doesntExist = createTempName("does_not_exist", ".txt");
+
+  tempFile.write(text.data(), text.size());
+  copy.write(text.data(), text.size());
+  shorter.write(text.data(), text.size() - 1);
+  text[text.size() - 2] = 'y';
+  changed.write(text.data(), text.size());
+
+  EXPECT_TRUE(sameContent(tempFile.name(), "./" + tempFile.name()));
+  EXPECT_TRUE(sameContent(tempFile.name(), copy.name()));
+  EXPECT_FALSE(sameContent(tempFile.name(), changed.name()));
+  EXPECT_FALSE(sameContent(tempFile.name(), shorter.name()));
+  EXPECT_FALSE(sameContent(empty.name(), tempFile.name()));
+  EXPECT_TRUE(sameContent(empty.name(), empty.name()));
+  EXPECT_FALSE(sameContent(doesntExist, doesntExist));
+  EXPECT_FALSE(sameContent(tempFile.name(), doesntExist));
+  EXPECT_FALSE(exists(doesntExist));
+
+  // Only regular files are read
+  TemporaryDirectory dir1(createTempName("dir1_", ""));
+  TemporaryDirectory dir2(createTempName("dir2_", ""));
+  EXPECT_TRUE(sameContent(dir1.name(), dir1.name()));
+  EXPECT_FALSE(sameContent(dir1.name(), dir2.name()));
+  EXPECT_FALSE(sameContent(dir1.name(), empty.name()));
+}
+
 TEST(PathTests, Join) {
   EXPECT_EQ("foo/bar", join("foo", "bar"));
   EXPECT_EQ("/foo", join("/", "foo"));
@@ -281,6 +331,7 @@ TEST(PathTests, RelativePath) {
   EXPECT_EQ(".", relativePath("alpha/beta/delta", "alpha/beta/delta"));
   EXPECT_EQ("alpha/beta", relativePath("alpha/beta", ""));
   EXPECT_EQ("../../..", relativePath("", "alpha/beta/delta"));
+  EXPECT_EQ("delta", relativePath("/alpha//beta/delta/", "/alpha/beta"));
 }
 
 TEST(PathTests, Split) {
@@ -378,3 +429,43 @@ TEST(PathTests, SplitExtension) {
   EXPECT_EQ(".", extension);
 }
 
+
+TEST(PathTests, StringViewOverloads) {
+  const std::string path("/foo//bar/baz.txt");
+  const std::string_view view(path);
+
+  // The results are views into path
+  std::string_view result = baseName(view);
+  EXPECT_EQ("baz.txt", result);
+  EXPECT_EQ(path.data() + 10, result.data());
+
+  result = directoryName(view);
+  EXPECT_EQ("/foo//bar", result);
+  EXPECT_EQ(path.data(), result.data());
+  EXPECT_EQ("/", directoryName(std::string_view("//foo")));
+
+  result = extension(view);
+  EXPECT_EQ(".txt", result);
+  EXPECT_EQ(path.data() + 13, result.data());
+
+  std::string_view first, second;
+  std::tie(first, second) = splitFile(view);
+  EXPECT_EQ("/foo//bar", first);
+  EXPECT_EQ("baz.txt", second);
+  EXPECT_EQ(path.data() + 10, second.data());
+
+  std::tie(first, second) = splitFile(std::string_view("/baz"));
+  EXPECT_EQ("/", first);
+  EXPECT_EQ("baz", second);
+
+  std::tie(first, second) = splitExtension(view);
+  EXPECT_EQ("/foo//bar/baz", first);
+  EXPECT_EQ(".txt", second);
+  EXPECT_EQ(path.data(), first.data());
+  EXPECT_EQ(path.data() + 13, second.data());
+
+  // The std::string overloads give the same answers
+  EXPECT_EQ(std::string(baseName(view)), baseName(path));
+  EXPECT_EQ(std::string(directoryName(view)), directoryName(path));
+  EXPECT_EQ(std::string(extension(view)), extension(path));
+}
@@ -0,0 +1,168 @@
+#include <pistis/filesystem/Reactor.hpp>
+#include <pistis/filesystem/File.hpp>
+#include <pistis/exceptions/IOError.hpp>
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+using namespace pistis::exceptions;
+using namespace pistis::filesystem;
+
+namespace {
+  // A pipe whose ends are non-blocking Files
+  struct Pipe {
+    File reader;
+    File writer;
+
+    Pipe(): reader(-1), writer(-1) {
+      int fds[2];
+      if (::pipe(fds) < 0) {
+	throw IOError::fromSystemError("Call to pipe() failed: #ERR#",
+				       PISTIS_EX_HERE);
+      }
+      reader = File(fds[0], "pipe reader");
+      writer = File(fds[1], "pipe writer");
+      reader.setNonBlocking(true);
+      writer.setNonBlocking(true);
+    }
+  };
+
+  // Read everything waiting in file into text.  Returns false at the end
+  // of the file.
+  bool drain(File& file, std::string& text) {
+    char buffer[256];
+    while (true) {
+      size_t n = file.tryRead(buffer, sizeof(buffer));
+      if (n == File::WOULD_BLOCK) {
+	return true;
+      } else if (!n) {
+	return false;
+      }
+      text.append(buffer, n);
+    }
+  }
+}
+
+TEST(ReactorTests, ServeManyPipes) {
+  static const size_t NUM_PIPES = 8;
+  std::vector<Pipe> pipes(NUM_PIPES);
+  std::vector<std::string> received(NUM_PIPES);
+  Reactor reactor;
+
+  for (size_t i = 0; i < NUM_PIPES; ++i) {
+    File& reader = pipes[i].reader;
+    std::string& text = received[i];
+    reactor.add(reader, Reactor::READABLE,
+		[&reactor, &reader, &text](uint32_t) {
+      if (!drain(reader, text)) {
+	reactor.remove(reader);
+      }
+    });
+  }
+  EXPECT_EQ(NUM_PIPES, reactor.size());
+
+  std::thread producer([&pipes]() {
+    for (int round = 0; round < 10; ++round) {
+      for (Pipe& p : pipes) {
+	const std::string msg = std::to_string(round) + ",";
+	p.writer.write(msg.data(), msg.size());
+      }
+    }
+    for (Pipe& p : pipes) {
+      p.writer.close();
+    }
+  });
+
+  reactor.run();
+  producer.join();
+
+  EXPECT_EQ(0, reactor.size());
+  for (const std::string& text : received) {
+    EXPECT_EQ("0,1,2,3,4,5,6,7,8,9,", text);
+  }
+}
+
+TEST(ReactorTests, RunOnceTimesOut) {
+  Pipe pipe;
+  Reactor reactor;
+  int nCalls = 0;
+
+  reactor.add(pipe.reader, Reactor::READABLE,
+	      [&nCalls](uint32_t) { ++nCalls; });
+  EXPECT_EQ(0, reactor.runOnce(0));
+  EXPECT_EQ(0, nCalls);
+
+  pipe.writer.write("x", 1);
+  EXPECT_EQ(1, reactor.runOnce(1000));
+  EXPECT_EQ(1, nCalls);
+
+  // Level-triggered, so the unread byte is reported again
+  EXPECT_EQ(1, reactor.runOnce(0));
+  EXPECT_EQ(2, nCalls);
+}
+
+TEST(ReactorTests, ReportsWritableAndHangUp) {
+  Pipe pipe;
+  Reactor reactor;
+  uint32_t reported = 0;
+
+  reactor.add(pipe.writer, Reactor::WRITABLE,
+	      [&reported](uint32_t events) { reported = events; });
+  EXPECT_EQ(1, reactor.runOnce(1000));
+  EXPECT_EQ(Reactor::WRITABLE, reported);
+
+  reactor.modify(pipe.writer, 0);
+  EXPECT_EQ(0, reactor.runOnce(0));
+
+  reactor.remove(pipe.writer);
+  reactor.add(pipe.reader, Reactor::READABLE,
+	      [&reported](uint32_t events) { reported = events; });
+  pipe.writer.close();
+  EXPECT_EQ(1, reactor.runOnce(1000));
+  EXPECT_TRUE(reported & Reactor::HANG_UP);
+}
+
+TEST(ReactorTests, HandlerRemovesAnotherDescriptor) {
+  Pipe first;
+  Pipe second;
+  Reactor reactor;
+  int nCalls = 0;
+
+  // Whichever handler runs first removes the other, so only one runs
+  reactor.add(first.reader, Reactor::READABLE,
+	      [&](uint32_t) { ++nCalls; reactor.remove(second.reader); });
+  reactor.add(second.reader, Reactor::READABLE,
+	      [&](uint32_t) { ++nCalls; reactor.remove(first.reader); });
+  first.writer.write("x", 1);
+  second.writer.write("y", 1);
+
+  EXPECT_EQ(1, reactor.runOnce(1000));
+  EXPECT_EQ(1, nCalls);
+  EXPECT_EQ(1, reactor.size());
+}
+
+TEST(ReactorTests, StopFromAnotherThread) {
+  Pipe pipe;
+  Reactor reactor;
+
+  reactor.add(pipe.reader, Reactor::READABLE, [](uint32_t) { });
+  std::thread stopper([&reactor]() { reactor.stop(); });
+  reactor.run();
+  stopper.join();
+  EXPECT_EQ(1, reactor.size());
+}
+
+TEST(ReactorTests, AddTwice) {
+  Pipe pipe;
+  Reactor reactor;
+
+  reactor.add(pipe.reader, Reactor::READABLE, [](uint32_t) { });
+  EXPECT_THROW(reactor.add(pipe.reader, Reactor::READABLE, [](uint32_t) { }),
+	       IOError);
+  EXPECT_THROW(reactor.modify(pipe.writer, Reactor::WRITABLE), IOError);
+}
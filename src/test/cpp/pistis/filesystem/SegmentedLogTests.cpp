@@ -0,0 +1,261 @@
+#include <pistis/filesystem/SegmentedLog.hpp>
+#include <pistis/filesystem/Path.hpp>
+#include <pistis/exceptions/IOError.hpp>
+
+#include "TestArtifacts.hpp"
+
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <dirent.h>
+#include <time.h>
+#include <unistd.h>
+#include <utime.h>
+
+using namespace pistis::exceptions;
+using namespace pistis::filesystem;
+namespace pt = pistis::filesystem::testing;
+
+namespace {
+  void removeDirectory(const std::string& name) {
+    DIR* dir = opendir(name.c_str());
+    if (dir) {
+      struct dirent* entry;
+      while ((entry = readdir(dir)) != nullptr) {
+	std::string entryName(entry->d_name);
+	if ((entryName != ".") && (entryName != "..")) {
+	  unlink(path::join(name, entryName).c_str());
+	}
+      }
+      closedir(dir);
+      rmdir(name.c_str());
+    }
+  }
+
+  std::vector<std::string> createRecords(size_t n) {
+    std::vector<std::string> records;
+    for (size_t i = 0; i < n; ++i) {
+      std::ostringstream record;
+      record << "Record " << i << " " << std::string(i % 37, 'x');
+      records.push_back(record.str());
+    }
+    return records;
+  }
+
+  std::vector<std::string> readAll(const SegmentedLog& log, uint64_t start) {
+    std::vector<std::string> records;
+    log.eachRecord(start, [&records](uint64_t, const uint8_t* data,
+				     size_t n) {
+	records.push_back(std::string(data, data + n));
+    });
+    return records;
+  }
+
+  class SegmentedLogTests : public ::testing::Test {
+  protected:
+    std::string logDir;
+
+    virtual void SetUp() {
+      logDir = pt::getScratchFile("segmented_log");
+      removeDirectory(logDir);
+    }
+
+    virtual void TearDown() {
+      removeDirectory(logDir);
+    }
+  };
+}
+
+TEST_F(SegmentedLogTests, AppendAndRead) {
+  const std::vector<std::string> records = createRecords(100);
+  SegmentedLog log(logDir);
+
+  EXPECT_EQ(0, log.firstRecord());
+  EXPECT_EQ(0, log.nextRecord());
+  for (size_t i = 0; i < records.size(); ++i) {
+    EXPECT_EQ(i, log.append(records[i]));
+  }
+  EXPECT_EQ(records.size(), log.nextRecord());
+  EXPECT_EQ(1, log.numSegments());
+
+  EXPECT_EQ(records, readAll(log, 0));
+  EXPECT_EQ(records[42], log.read(42));
+  EXPECT_THROW(log.read(records.size()), IOError);
+}
+
+TEST_F(SegmentedLogTests, AppendBatch) {
+  const std::vector<std::string> records = createRecords(100);
+  SegmentedLog log(logDir);
+
+  EXPECT_EQ(0, log.appendBatch(records.begin(), records.begin() + 50));
+  EXPECT_EQ(50, log.appendBatch(records.begin() + 50, records.end()));
+  EXPECT_EQ(records, readAll(log, 0));
+}
+
+TEST_F(SegmentedLogTests, RollSegmentsAndReadFromRecord) {
+  const std::vector<std::string> records = createRecords(1000);
+  SegmentedLogOptions options;
+  options.maxSegmentSize = 4096;
+  options.indexInterval = 256;
+
+  SegmentedLog log(logDir, options);
+  log.appendBatch(records.begin(), records.end());
+
+  EXPECT_LT(1, log.numSegments());
+  for (uint64_t start : { 0, 1, 137, 500, 998, 999 }) {
+    std::vector<std::string> truth(records.begin() + start, records.end());
+    EXPECT_EQ(truth, readAll(log, start));
+  }
+  EXPECT_TRUE(readAll(log, records.size()).empty());
+}
+
+TEST_F(SegmentedLogTests, Reopen) {
+  const std::vector<std::string> records = createRecords(500);
+  SegmentedLogOptions options;
+  options.maxSegmentSize = 2048;
+  options.indexInterval = 128;
+
+  {
+    SegmentedLog log(logDir, options);
+    log.appendBatch(records.begin(), records.begin() + 250);
+  }
+
+  SegmentedLog log(logDir, options);
+  EXPECT_EQ(250, log.nextRecord());
+  log.appendBatch(records.begin() + 250, records.end());
+  EXPECT_EQ(records, readAll(log, 0));
+  EXPECT_EQ(records[400], log.read(400));
+}
+
+TEST_F(SegmentedLogTests, TruncateTornRecordOnOpen) {
+  const std::vector<std::string> records = createRecords(20);
+  std::string activeSegment;
+
+  {
+    SegmentedLog log(logDir);
+    log.appendBatch(records.begin(), records.end());
+    activeSegment = path::join(logDir, "00000000000000000000.log");
+  }
+
+  // Simulate a crash in the middle of appending a record
+  const uint64_t validSize = path::fileSize(activeSegment);
+  {
+    File file = File::open(activeSegment, FileAccessMode::WRITE_ONLY,
+			   FileOpenOptions::APPEND);
+    const uint8_t partial[] = { 100, 0, 0, 0, 1, 2, 3, 4, 'a', 'b' };
+    file.write(partial, sizeof(partial));
+  }
+
+  SegmentedLog log(logDir);
+  EXPECT_EQ(records.size(), log.nextRecord());
+  EXPECT_EQ(validSize, path::fileSize(activeSegment));
+  EXPECT_EQ(records, readAll(log, 0));
+
+  EXPECT_EQ(records.size(), log.append(std::string("After recovery")));
+  EXPECT_EQ("After recovery", log.read(records.size()));
+}
+
+TEST_F(SegmentedLogTests, DetectCorruptRecord) {
+  const std::vector<std::string> records = createRecords(20);
+  SegmentedLogOptions options;
+  options.maxSegmentSize = 256;
+
+  SegmentedLog log(logDir, options);
+  log.appendBatch(records.begin(), records.end());
+  ASSERT_LT(1, log.numSegments());
+
+  // Flip a payload byte in the first record of the first segment
+  File file = File::open(path::join(logDir, "00000000000000000000.log"),
+			 FileCreationMode::OPEN_ONLY,
+			 FileAccessMode::READ_WRITE);
+  file.seek(FileOrigin::START, 8);
+  file.write("X", 1);
+  file.close();
+
+  EXPECT_THROW(log.read(0), IOError);
+  EXPECT_EQ(records[1], log.read(1));
+}
+
+TEST_F(SegmentedLogTests, RetainBySize) {
+  const std::vector<std::string> records = createRecords(1000);
+  SegmentedLogOptions options;
+  options.maxSegmentSize = 1024;
+  options.maxTotalSize = 4096;
+
+  SegmentedLog log(logDir, options);
+  for (const std::string& record : records) {
+    log.append(record);
+  }
+
+  EXPECT_GE(options.maxTotalSize + options.maxSegmentSize, log.size());
+  EXPECT_LT(0, log.firstRecord());
+  EXPECT_THROW(log.read(0), IOError);
+
+  std::vector<std::string> truth(records.begin() + log.firstRecord(),
+				 records.end());
+  EXPECT_EQ(truth, readAll(log, log.firstRecord()));
+  EXPECT_FALSE(path::exists(path::join(logDir, "00000000000000000000.log")));
+}
+
+TEST_F(SegmentedLogTests, RetainByAge) {
+  const std::vector<std::string> records = createRecords(100);
+  SegmentedLogOptions options;
+  options.maxSegmentSize = 256;
+  options.maxSegmentAge = 60;
+
+  SegmentedLog log(logDir, options);
+  log.appendBatch(records.begin(), records.begin() + 50);
+  ASSERT_LT(1, log.numSegments());
+
+  // A modification time in the future must not make the segment look old
+  const std::string oldest = path::join(logDir, "00000000000000000000.log");
+  struct utimbuf times;
+  times.actime = times.modtime = ::time(nullptr) + 3600;
+  ASSERT_EQ(0, ::utime(oldest.c_str(), &times));
+
+  log.appendBatch(records.begin() + 50, records.begin() + 75);
+  EXPECT_TRUE(path::exists(oldest));
+  EXPECT_EQ(0, log.firstRecord());
+
+  times.actime = times.modtime = ::time(nullptr) - 3600;
+  ASSERT_EQ(0, ::utime(oldest.c_str(), &times));
+
+  log.appendBatch(records.begin() + 75, records.end());
+  EXPECT_FALSE(path::exists(oldest));
+  EXPECT_LT(0, log.firstRecord());
+}
+
+namespace {
+  // A record whose size need not match the memory behind it
+  struct RecordView {
+    const char* text;
+    size_t n;
+
+    const char* data() const { return text; }
+    size_t size() const { return n; }
+  };
+}
+
+TEST_F(SegmentedLogTests, RejectOversizedRecord) {
+  const std::vector<std::string> records = createRecords(10);
+  SegmentedLog log(logDir);
+  log.appendBatch(records.begin(), records.end());
+  const uint64_t size = log.size();
+
+  // Only the size is examined, so the data is never read
+  const size_t tooLarge = (size_t)SegmentedLog::MAX_RECORD_SIZE + 1;
+  EXPECT_THROW(log.append("", tooLarge), IOError);
+
+  // Nothing from a batch is written if any of its records is too large
+  const std::vector<RecordView> batch{
+      RecordView{ "Small", 5 }, RecordView{ "", tooLarge }
+  };
+  EXPECT_THROW(log.appendBatch(batch.begin(), batch.end()), IOError);
+
+  EXPECT_EQ(records.size(), log.nextRecord());
+  EXPECT_EQ(size, log.size());
+  EXPECT_EQ(records, readAll(log, 0));
+}
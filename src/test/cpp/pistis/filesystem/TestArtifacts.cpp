@@ -1,4 +1,5 @@
 #include "TestArtifacts.hpp"
+#include <pistis/filesystem/File.hpp>
 #include <pistis/exceptions/IOError.hpp>
 #include <iostream>
 
@@ -6,6 +7,7 @@
 #include <unistd.h>
 
 using namespace pistis::exceptions;
+using namespace pistis::filesystem;
 using namespace pistis::filesystem::testing;
 
 namespace {
@@ -103,3 +105,41 @@ std::string pistis::filesystem::testing::getScratchFile(
 void pistis::filesystem::testing::removeFile(const std::string& filename) {
   ::unlink(getScratchFile(filename).c_str());
 }
+
+void pistis::filesystem::testing::writeTextFile(const std::string& filename,
+						const std::string& text) {
+  File file = File::open(getScratchFile(filename), FileAccessMode::WRITE_ONLY,
+			 FileOpenOptions::TRUNCATE);
+  const char* p = text.data();
+  size_t n = text.size();
+  while (n) {
+    size_t nWritten = file.write(p, n);
+    p += nWritten;
+    n -= nWritten;
+  }
+}
+
+void pistis::filesystem::testing::writeTextFile(
+    const std::string& filename, const std::vector<std::string>& lines
+) {
+  std::string text;
+  for (const std::string& line : lines) {
+    text += line;
+  }
+  writeTextFile(filename, text);
+}
+
+std::string pistis::filesystem::testing::readTextFile(
+    const std::string& filename
+) {
+  File file = File::open(getScratchFile(filename),
+			 FileCreationMode::OPEN_ONLY,
+			 FileAccessMode::READ_ONLY);
+  std::string text;
+  char buffer[4096];
+  size_t n;
+  while ((n = file.read(buffer, sizeof(buffer))) != 0) {
+    text.append(buffer, n);
+  }
+  return text;
+}
@@ -7,6 +7,7 @@
  */
 
 #include <string>
+#include <vector>
 
 namespace pistis {
   namespace filesystem {
@@ -67,6 +68,35 @@ namespace pistis {
        *  @param filename  The file to remove
        */
       void removeFile(const std::string& filename);
+
+      /** @brief Replace the contents of a file with the given text.
+       *
+       *  Relative names are in the scratch directory, as with
+       *  removeFile().  The file is created if it does not exist.
+       *
+       *  @param filename  The file to write
+       *  @param text      Its new contents
+       */
+      void writeTextFile(const std::string& filename,
+			 const std::string& text);
+
+      /** @brief Replace the contents of a file with the given lines.
+       *
+       *  The lines are written one after another, so each should end
+       *  with a newline.
+       */
+      void writeTextFile(const std::string& filename,
+			 const std::vector<std::string>& lines);
+
+      /** @brief Read the entire contents of a file.
+       *
+       *  Relative names are in the scratch directory, as with
+       *  removeFile().
+       *
+       *  @param filename  The file to read
+       *  @returns         Its contents
+       */
+      std::string readTextFile(const std::string& filename);
     }
   }
 }